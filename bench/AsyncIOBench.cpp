@@ -0,0 +1,101 @@
+// bench/AsyncIOBench.cpp - many small appends: blocking writes on M4qXE's IO lane vs AsyncIO
+// (thread-pool backend and, on Linux, io_uring)
+#include "MBBench.hpp"
+#include "MBAsyncIO.hpp"
+#include "M4qXE.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    using namespace MB::Bench;
+    using Lane = MB::M4qXE::Lane;
+
+#if !defined(_WIN32)
+    constexpr int         kAppends = 100'000;
+    constexpr std::size_t kLine = 64;
+    char g_line[kLine];
+
+    struct TempLog {
+        std::string path;
+        int         fd{ -1 };
+
+        explicit TempLog(const char* tag)
+            : path(std::string("/tmp/mb_bench_asyncio_") + tag + ".log") {
+            fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        }
+        ~TempLog() {
+            if (fd >= 0) ::close(fd);
+            std::remove(path.c_str());
+        }
+        long Size() const { return static_cast<long>(::lseek(fd, 0, SEEK_END)); }
+    };
+
+    void Report(Reporter& r, const std::string& tag, clock::time_point t0, clock::time_point t1, const TempLog& log) {
+        r.Report(tag + " appends", kAppends / (ElapsedNs(t0, t1) / 1e9) / 1e6, "Mop/s");
+        r.Report(tag + " per append", ElapsedNs(t0, t1) / kAppends, "ns");
+        if (log.Size() != static_cast<long>(kAppends * kLine))
+            r.Report(tag + " SHORT FILE bytes", static_cast<double>(log.Size()), "B");
+    }
+
+    void AppendCase(Reporter& r) {
+        for (std::size_t i = 0; i < kLine; ++i) g_line[i] = i + 1 == kLine ? '\n' : 'x';
+
+        MB::M4qXE::Config cfg;
+        cfg.workers = 2;
+        MB::M4qXE pool(cfg);
+        pool.Start();
+
+        {   // The lane as it is used today: one blocking write per task.
+            TempLog log("lane");
+            const int fd = log.fd;
+            const auto t0 = clock::now();
+            for (int i = 0; i < kAppends; ++i)
+                pool.Enqueue(Lane::IO, [fd] { (void)!::write(fd, g_line, kLine); });
+            pool.Flush();
+            Report(r, "blocking IO lane  ", t0, clock::now(), log);
+        }
+
+        for (auto backend : { MB::AsyncIO::Backend::ThreadPool, MB::AsyncIO::Backend::IoUring }) {
+            MB::AsyncIO::Config ac;
+            ac.backend = backend;
+            ac.pool = &pool;
+            MB::AsyncIO io(ac);
+            if (io.ActiveBackend() != backend) {
+                std::printf("  io_uring unavailable; skipped\n");
+                continue;
+            }
+
+            TempLog log(backend == MB::AsyncIO::Backend::IoUring ? "uring" : "pool");
+            std::atomic<std::uint64_t> bytes{ 0 };
+            const auto t0 = clock::now();
+            for (int i = 0; i < kAppends; ++i)
+                io.Write(log.fd, g_line, kLine, -1, [&bytes](std::int64_t n) {
+                    if (n > 0) bytes.fetch_add(static_cast<std::uint64_t>(n), std::memory_order_relaxed);
+                });
+            io.Flush();
+            const auto t1 = clock::now();
+
+            const std::string tag = backend == MB::AsyncIO::Backend::IoUring ? "AsyncIO io_uring  " : "AsyncIO threadpool";
+            Report(r, tag, t0, t1, log);
+            const auto s = io.GetStats();
+            if (s.enterCalls)
+                r.Report(tag + " appends/enter", static_cast<double>(s.submitted) / s.enterCalls, "");
+            r.Report(tag + " slot waits", static_cast<double>(s.slotWaits), "");
+        }
+        pool.Stop();
+    }
+#else
+    void AppendCase(Reporter&) {}
+#endif
+
+} // namespace
+
+MB_BENCH_CASE("asyncio/append", AppendCase);
@@ -0,0 +1,136 @@
+// bench/BenchMain.cpp - runs every registered case (optionally filtered by substring)
+//
+//   mb_bench [filter] [--json <path>|-]
+//
+// The table always goes to stdout. --json also writes every metric as one
+// document (stable case/metric names, one entry per metric) so two runs can
+// be diffed; "-" sends the JSON to stdout instead of the table.
+#include "MBBench.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::atomic<std::uint64_t> g_allocs{ 0 };
+
+    struct CaseResult {
+        const char* name;
+        std::vector<MB::Bench::Reporter::Metric> metrics;
+    };
+
+    void WriteEscaped(std::FILE* f, const std::string& s) {
+        std::fputc('"', f);
+        for (char c : s) {
+            if (c == '"' || c == '\\') std::fputc('\\', f);
+            if (static_cast<unsigned char>(c) < 0x20) { std::fprintf(f, "\\u%04x", c); continue; }
+            std::fputc(c, f);
+        }
+        std::fputc('"', f);
+    }
+
+    const char* CompilerId() {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc";
+#else
+        return "unknown";
+#endif
+    }
+
+    void WriteJSON(std::FILE* f, const std::vector<CaseResult>& results) {
+        std::fprintf(f, "{\"schema\":1,\"timestamp\":%lld,\"hardwareThreads\":%u,\"compiler\":",
+            static_cast<long long>(std::time(nullptr)), std::thread::hardware_concurrency());
+        WriteEscaped(f, CompilerId());
+#if defined(NDEBUG)
+        std::fputs(",\"optimized\":true", f);
+#else
+        std::fputs(",\"optimized\":false", f);
+#endif
+        std::fputs(",\"cases\":[", f);
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            std::fputs(i ? ",{\"name\":" : "{\"name\":", f);
+            WriteEscaped(f, results[i].name);
+            std::fputs(",\"metrics\":[", f);
+            const auto& ms = results[i].metrics;
+            for (std::size_t k = 0; k < ms.size(); ++k) {
+                std::fputs(k ? ",{\"name\":" : "{\"name\":", f);
+                WriteEscaped(f, ms[k].name);
+                std::fprintf(f, ",\"value\":%.4f,\"unit\":", ms[k].value);
+                WriteEscaped(f, ms[k].unit);
+                std::fputc('}', f);
+            }
+            std::fputs("]}", f);
+        }
+        std::fputs("]}\n", f);
+    }
+}
+
+std::uint64_t MB::Bench::AllocCount() noexcept {
+    return g_allocs.load(std::memory_order_relaxed);
+}
+
+// Counting allocator; the other global forms forward to these.
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--json")) {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "usage: %s [filter] [--json <path>|-]\n", argv[0]);
+                return 2;
+            }
+            jsonPath = argv[++i];
+        }
+        else {
+            filter = argv[i];
+        }
+    }
+    const bool jsonToStdout = jsonPath && !std::strcmp(jsonPath, "-");
+
+    std::vector<CaseResult> results;
+    for (const auto& c : MB::Bench::Registry()) {
+        if (filter && !std::strstr(c.name, filter)) continue;
+
+        MB::Bench::Reporter rep;
+        c.fn(rep);
+        if (!jsonToStdout) {
+            for (const auto& m : rep.Metrics())
+                std::printf("%-40s %-28s %14.2f %s\n", c.name, m.name.c_str(), m.value, m.unit.c_str());
+            std::fflush(stdout);
+        }
+        if (jsonPath) results.push_back({ c.name, rep.Metrics() });
+    }
+
+    if (jsonToStdout) {
+        WriteJSON(stdout, results);
+    }
+    else if (jsonPath) {
+        std::FILE* f = std::fopen(jsonPath, "wb");
+        if (!f) {
+            std::fprintf(stderr, "mb_bench: cannot write %s\n", jsonPath);
+            return 1;
+        }
+        WriteJSON(f, results);
+        std::fclose(f);
+    }
+    return 0;
+}
@@ -0,0 +1,218 @@
+// bench/ConfigBench.cpp - contended config readers: the current config as a published immutable
+// snapshot (Load(), and the version-cached Reader) against locking a shared
+// Config (to copy it or to read a few fields) and reading its atomics directly, with a writer
+// swapping two configs underneath; then, with a writer flipping back to back, counts views
+// that mixed fields from both
+#include "MBBench.hpp"
+#include "MBConfig.hpp"
+#include "MBSnapshot.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using namespace MB::Bench;
+
+    constexpr int kReads = 200'000;   // per reader thread
+
+    // The writer alternates between two configs; a view is consistent when
+    // upscaler and traffic come from the same one.
+    MB::Config Variant(bool b) {
+        MB::Config c;
+        c.upscaler.store(b);
+        c.traffic.store(b ? 2.0f : 1.0f);
+        c.logLevel.store(b ? MB::Config::LogLevel::Debug : MB::Config::LogLevel::Info);
+        return c;
+    }
+
+    bool Consistent(bool upscaler, float traffic, MB::Config::LogLevel lvl) {
+        return upscaler == (traffic == 2.0f) && upscaler == (lvl == MB::Config::LogLevel::Debug);
+    }
+
+    struct Result {
+        double        ns{ 0 };     // per read
+        std::uint64_t torn{ 0 };
+    };
+
+    // `threads` readers doing kReads reads each while write() runs every 200 us.
+    // Each reader thread calls makeRead() once for its read function, which
+    // returns whether the view was consistent.
+    template <class MakeRead, class Write>
+    Result Contended(unsigned threads, MakeRead&& makeRead, Write&& write) {
+        std::atomic<bool> stop{ false };
+        std::thread writer([&] {
+            for (bool b = true; !stop.load(std::memory_order_relaxed); b = !b) {
+                write(b);
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+
+        std::atomic<std::uint64_t> torn{ 0 };
+        std::atomic<std::int64_t> readNs{ 0 };
+        std::vector<std::thread> ts;
+        for (unsigned t = 0; t < threads; ++t) {
+            ts.emplace_back([&] {
+                auto read = makeRead();
+                std::uint64_t bad = 0;
+                const auto t0 = clock::now();
+                for (int i = 0; i < kReads; ++i)
+                    if (!read()) ++bad;
+                readNs.fetch_add(static_cast<std::int64_t>(ElapsedNs(t0, clock::now())));
+                torn.fetch_add(bad);
+            });
+        }
+        for (auto& t : ts) t.join();
+        stop.store(true);
+        writer.join();
+
+        Result r;
+        r.ns = static_cast<double>(readNs.load()) / (static_cast<double>(kReads) * threads);
+        r.torn = torn.load();
+        return r;
+    }
+
+    void SnapshotCase(Reporter& r) {
+        for (unsigned t : { 1u, 2u, 4u, 8u }) {
+            const std::string tag = " t=" + std::to_string(t);
+
+            // Before: one shared Config behind a mutex (copy it, or read under the lock)...
+            MB::Config shared = Variant(false);
+            std::mutex mx;
+            auto writeShared = [&](bool b) { std::scoped_lock lk{ mx }; shared = Variant(b); };
+
+            const Result copy = Contended(t, [&] {
+                return [&] {
+                    MB::Config c;
+                    { std::scoped_lock lk{ mx }; c = shared; }
+                    return Consistent(c.upscaler.load(), c.traffic.load(), c.logLevel.load());
+                };
+            }, writeShared);
+            const Result locked = Contended(t, [&] {
+                return [&] {
+                    std::scoped_lock lk{ mx };
+                    return Consistent(shared.upscaler.load(), shared.traffic.load(), shared.logLevel.load());
+                };
+            }, writeShared);
+            // ...or its atomics read directly, as hot paths did to avoid the lock.
+            const Result fields = Contended(t, [&] {
+                return [&] {
+                    const bool up = shared.upscaler.load(std::memory_order_relaxed);
+                    const float tr = shared.traffic.load(std::memory_order_relaxed);
+                    return Consistent(up, tr, shared.logLevel.load(std::memory_order_relaxed));
+                };
+            }, writeShared);
+
+            // After: the config published as an immutable snapshot.
+            MB::Snapshot<MB::Config> snap{ Variant(false) };
+            auto publish = [&](bool b) { snap.Publish(Variant(b)); };
+
+            const Result load = Contended(t, [&] {
+                return [&] {
+                    const auto c = snap.Load();
+                    return Consistent(c->upscaler.load(), c->traffic.load(), c->logLevel.load());
+                };
+            }, publish);
+            const Result cached = Contended(t, [&] {
+                return [reader = MB::Snapshot<MB::Config>::Reader(snap)]() mutable {
+                    const MB::Config& c = reader.Get();
+                    return Consistent(c.upscaler.load(), c.traffic.load(), c.logLevel.load());
+                };
+            }, publish);
+
+            r.Report("mutex + copy" + tag, copy.ns, "ns/read");
+            r.Report("mutex, fields" + tag, locked.ns, "ns/read");
+            r.Report("atomic fields" + tag, fields.ns, "ns/read");
+            r.Report("snapshot Load()" + tag, load.ns, "ns/read");
+            r.Report("snapshot Reader" + tag, cached.ns, "ns/read");
+        }
+    }
+
+    // Views that mixed two writes, out of kReads per reader. The writer
+    // flips back to back and yields after every field it stores, as a reload
+    // storing into the live Config would when preempted (so on one core about
+    // two thirds of the pauses fall mid-write); readers yield every 256 reads
+    // so they interleave with it even on one core.
+    template <class MakeRead, class Write>
+    std::uint64_t CountTorn(unsigned threads, MakeRead&& makeRead, Write&& write) {
+        std::atomic<bool> stop{ false };
+        std::thread writer([&] {
+            for (bool b = true; !stop.load(std::memory_order_relaxed); b = !b)
+                write(b);
+        });
+
+        std::atomic<std::uint64_t> torn{ 0 };
+        std::vector<std::thread> ts;
+        for (unsigned t = 0; t < threads; ++t) {
+            ts.emplace_back([&] {
+                auto read = makeRead();
+                std::uint64_t bad = 0;
+                for (int i = 0; i < kReads; ++i) {
+                    if (!read()) ++bad;
+                    if ((i & 255) == 255) std::this_thread::yield();
+                }
+                torn.fetch_add(bad);
+            });
+        }
+        for (auto& t : ts) t.join();
+        stop.store(true);
+        writer.join();
+        return torn.load();
+    }
+
+    void TornCase(Reporter& r) {
+        for (unsigned t : { 1u, 4u }) {
+            const std::string tag = " t=" + std::to_string(t);
+
+            // Before: field by field into the one shared Config.
+            MB::Config shared = Variant(false);
+            const std::uint64_t fields = CountTorn(t, [&] {
+                return [&] {
+                    const bool up = shared.upscaler.load(std::memory_order_relaxed);
+                    const float tr = shared.traffic.load(std::memory_order_relaxed);
+                    return Consistent(up, tr, shared.logLevel.load(std::memory_order_relaxed));
+                };
+            }, [&](bool b) {
+                const MB::Config next = Variant(b);
+                shared.upscaler.store(next.upscaler.load());
+                std::this_thread::yield();
+                shared.traffic.store(next.traffic.load());
+                std::this_thread::yield();
+                shared.logLevel.store(next.logLevel.load());
+                std::this_thread::yield();
+            });
+
+            // After: a whole new object per publish.
+            MB::Snapshot<MB::Config> snap{ Variant(false) };
+            auto publish = [&](bool b) {
+                snap.Publish(Variant(b));
+                std::this_thread::yield();
+            };
+            const std::uint64_t load = CountTorn(t, [&] {
+                return [&] {
+                    const auto c = snap.Load();
+                    return Consistent(c->upscaler.load(), c->traffic.load(), c->logLevel.load());
+                };
+            }, publish);
+            const std::uint64_t cached = CountTorn(t, [&] {
+                return [reader = MB::Snapshot<MB::Config>::Reader(snap)]() mutable {
+                    const MB::Config& c = reader.Get();
+                    return Consistent(c.upscaler.load(), c.traffic.load(), c.logLevel.load());
+                };
+            }, publish);
+
+            r.Report("atomic fields" + tag + " torn", static_cast<double>(fields), "views");
+            r.Report("snapshot Load()" + tag + " torn", static_cast<double>(load), "views");
+            r.Report("snapshot Reader" + tag + " torn", static_cast<double>(cached), "views");
+        }
+    }
+
+} // namespace
+
+MB_BENCH_CASE("config/snapshot", SnapshotCase);
+MB_BENCH_CASE("config/torn", TornCase);
@@ -0,0 +1,166 @@
+// bench/CoroBench.cpp - Task<T> create/await cost and frame-pool allocations, lane hops
+// through M4qXE::Schedule(), NextTick() resumes through the game-thread queue, coroutines
+// parked in Schedule() when Stop() drops their task
+#include "MBBench.hpp"
+#include "MBCoro.hpp"
+#include "M4qXE.hpp"
+#include "MBTaskQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+    using namespace MB::Bench;
+    using Lane = MB::M4qXE::Lane;
+
+    MB::Task<int> Leaf(int v) {
+        co_return v + 1;
+    }
+
+    MB::Task<int> Chain(int depth) {
+        int sum = 0;
+        for (int i = 0; i < depth; ++i)
+            sum += co_await Leaf(i);
+        co_return sum;
+    }
+
+    // Creating and awaiting a child task inline: frame alloc + start + resume.
+    void FrameCase(Reporter& r) {
+        constexpr int kOuter = 2000;
+        constexpr int kDepth = 500;
+
+        // Warm up the thread cache and the first slab.
+        { auto warm = Chain(kDepth); MB::Spawn(std::move(warm)); }
+
+        const std::uint64_t a0 = AllocCount();
+        const auto s0 = MB::GetCoroStats();
+        const auto t0 = clock::now();
+        for (int i = 0; i < kOuter; ++i)
+            MB::Spawn(Chain(kDepth));
+        const auto t1 = clock::now();
+        const std::uint64_t a1 = AllocCount();
+        const auto s1 = MB::GetCoroStats();
+
+        const double awaits = static_cast<double>(kOuter) * kDepth;
+        r.Report("create+await child", ElapsedNs(t0, t1) / awaits, "ns");
+        r.Report("heap allocs/coroutine", static_cast<double>(a1 - a0) / (awaits + kOuter), "");
+        r.Report("slab bytes grown", static_cast<double>(s1.slabBytes - s0.slabBytes), "B");
+    }
+
+    MB::Task<> Hopper(MB::M4qXE& pool, int hops, std::atomic<int>& done) {
+        for (int i = 0; i < hops; ++i)
+            co_await pool.Schedule(i & 1 ? Lane::Normal : Lane::Low);
+        done.fetch_add(1, std::memory_order_release);
+    }
+
+    // Coroutines bouncing between two lanes; one hop = one Enqueue + resume.
+    void HopCase(Reporter& r) {
+        constexpr int kCoros = 64;
+        constexpr int kHops = 2000;
+
+        MB::M4qXE::Config cfg;
+        cfg.workers = 2;
+        MB::M4qXE pool(cfg);
+        pool.Start();
+
+        std::atomic<int> done{ 0 };
+        const auto t0 = clock::now();
+        for (int i = 0; i < kCoros; ++i)
+            MB::Spawn(Hopper(pool, kHops, done));
+        while (done.load(std::memory_order_acquire) < kCoros) {}
+        const auto t1 = clock::now();
+
+        r.Report("lane hop", ElapsedNs(t0, t1) / (static_cast<double>(kCoros) * kHops), "ns");
+        pool.Stop();
+    }
+
+    MB::Task<> Parked(MB::M4qXE& pool, std::atomic<int>& ran, std::atomic<int>& dropped) {
+        try {
+            co_await pool.Schedule(Lane::Normal);
+            ran.fetch_add(1, std::memory_order_relaxed);
+        }
+        catch (const std::runtime_error&) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Coroutines queued behind a busy worker when Stop() runs without drain:
+    // each must be resumed with an error, so its detached frame runs to the
+    // end and frees itself instead of leaking.
+    void StopDropCase(Reporter& r) {
+        constexpr int kCoros = 1000;
+        MB::M4qXE::Config cfg;
+        cfg.workers = 1;
+        cfg.drainOnStop = false;
+        MB::M4qXE pool(cfg);
+        pool.Start();
+
+        std::atomic<bool> release{ false };
+        std::atomic<bool> busy{ false };
+        pool.Enqueue(Lane::High, [&] {
+            busy.store(true, std::memory_order_release);
+            while (!release.load(std::memory_order_acquire)) std::this_thread::yield();
+        });
+        while (!busy.load(std::memory_order_acquire)) std::this_thread::yield();
+
+        std::atomic<int> ran{ 0 };
+        std::atomic<int> dropped{ 0 };
+        for (int i = 0; i < kCoros; ++i)
+            MB::Spawn(Parked(pool, ran, dropped));
+
+        std::thread stopper([&] { pool.Stop(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        release.store(true, std::memory_order_release);
+        stopper.join();
+
+        r.Report("resumed with error (of 1000)", static_cast<double>(dropped.load()), "");
+        r.Report("ran on the pool", static_cast<double>(ran.load()), "");
+    }
+
+    MB::GameTaskQueue* g_tickQ = nullptr;
+
+    MB::Task<> Ticker(int ticks, int& done) {
+        for (int i = 0; i < ticks; ++i)
+            co_await MB::NextTick();
+        ++done;
+    }
+
+    // NextTick() through GameTaskQueue: each pump resumes every parked coroutine once.
+    void NextTickCase(Reporter& r) {
+        constexpr int kCoros = 1000;
+        constexpr int kTicks = 200;
+
+        MB::GameTaskQueue q;
+        g_tickQ = &q;
+        MB::SetGameThreadHooks({
+            [](std::coroutine_handle<> h) { g_tickQ->Push([h] { h.resume(); }, MB::GameTaskQueue::Priority::High); },
+            nullptr });
+
+        int done = 0;
+        for (int i = 0; i < kCoros; ++i)
+            MB::Spawn(Ticker(kTicks, done));
+
+        int pumps = 0;
+        const auto t0 = clock::now();
+        while (done < kCoros) {
+            q.Drain();
+            ++pumps;
+        }
+        const auto t1 = clock::now();
+
+        r.Report("resume via pump", ElapsedNs(t0, t1) / (static_cast<double>(kCoros) * kTicks), "ns");
+        r.Report("pumps", static_cast<double>(pumps), "");
+        MB::SetGameThreadHooks({});
+        g_tickQ = nullptr;
+    }
+
+} // namespace
+
+MB_BENCH_CASE("coro/frame", FrameCase);
+MB_BENCH_CASE("coro/hop", HopCase);
+MB_BENCH_CASE("coro/nexttick", NextTickCase);
+MB_BENCH_CASE("coro/stopdrop", StopDropCase);
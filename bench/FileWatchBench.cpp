@@ -0,0 +1,80 @@
+// bench/FileWatchBench.cpp - config hot reload: time from saving the file (temp + rename, as
+// SaveConfig and most editors do) to the FileWatcher callback, native notifications vs polling,
+// and the previous watcher's timing (250 ms poll, ~1 s debounce) for reference
+#include "MBBench.hpp"
+#include "MBFileWatch.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using namespace MB::Bench;
+    namespace fs = std::filesystem;
+    using ms = std::chrono::milliseconds;
+
+    void Save(const fs::path& file, int n) {
+        fs::path tmp = file;
+        tmp += ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            f << "{ \"version\": 1, \"trafficBoost\": " << (1.0 + n * 0.01) << " }\n";
+        }
+        std::error_code ec;
+        fs::rename(tmp, file, ec);
+    }
+
+    // Median ms from save to callback over `edits` saves.
+    double EditToApplyMs(MB::FileWatcher::Backend backend, ms coalesce, ms poll, int edits) {
+        const fs::path dir = fs::temp_directory_path() / "mb_bench_watch";
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+        fs::create_directories(dir, ec);
+        const fs::path file = dir / "MirrorBlade.json";
+        Save(file, 0);
+
+        std::mutex mx;
+        std::condition_variable cv;
+        int fired = 0;
+        MB::FileWatcher w;
+        MB::FileWatcher::Options opt;
+        opt.backend = backend;
+        opt.coalesce = coalesce;
+        opt.pollInterval = poll;
+        if (!w.Start(file, [&] { { std::scoped_lock lk{ mx }; ++fired; } cv.notify_one(); }, opt)) return -1.0;
+        if (backend == MB::FileWatcher::Backend::Native && w.ActiveBackend() != backend) return -1.0;
+
+        std::vector<double> lat;
+        for (int i = 1; i <= edits; ++i) {
+            std::this_thread::sleep_for(poll + ms(20));   // let a poller see the previous state
+            std::unique_lock lk{ mx };
+            const int before = fired;
+            lk.unlock();
+            const auto t0 = clock::now();
+            Save(file, i);
+            lk.lock();
+            if (!cv.wait_for(lk, std::chrono::seconds(5), [&] { return fired > before; })) return -1.0;
+            lat.push_back(ElapsedNs(t0, clock::now()) / 1e6);
+        }
+        w.Stop();
+        std::sort(lat.begin(), lat.end());
+        return lat[lat.size() / 2];
+    }
+
+    void WatchCase(Reporter& r) {
+        using B = MB::FileWatcher::Backend;
+        r.Report("native, no window", EditToApplyMs(B::Native, ms(0), ms(250), 9), "ms");
+        r.Report("native, 100 ms window", EditToApplyMs(B::Native, ms(100), ms(250), 9), "ms");
+        r.Report("poll 250 ms, 100 ms window", EditToApplyMs(B::Poll, ms(100), ms(250), 5), "ms");
+        r.Report("previous (poll 250 ms, 1 s debounce)", EditToApplyMs(B::Poll, ms(1000), ms(250), 3), "ms");
+    }
+
+} // namespace
+
+MB_BENCH_CASE("config/watch", WatchCase);
@@ -0,0 +1,305 @@
+// bench/GameTaskQueueBench.cpp - game-thread queue: producer throughput, push cost and tick drain time
+#include "MBBench.hpp"
+#include "MBTaskQueue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using namespace MB::Bench;
+
+    // The previous EnqueueOnGameThread/PumpTasksOnTick pair, kept here as the baseline.
+    struct MutexQueue {
+        std::mutex mtx;
+        std::queue<std::function<void()>> q;
+
+        template <class F>
+        void Push(F&& f) {
+            std::lock_guard<std::mutex> lk(mtx);
+            q.push(std::forward<F>(f));
+        }
+
+        std::size_t Drain() {
+            std::queue<std::function<void()>> local;
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                std::swap(local, q);
+            }
+            std::size_t n = 0;
+            while (!local.empty()) { local.front()(); local.pop(); ++n; }
+            return n;
+        }
+    };
+
+    constexpr int kPerProducer = 200'000;
+
+    template <class Q>
+    double ProducerThroughput(unsigned producers) {
+        Q q;
+        std::atomic<std::uint64_t> sink{ 0 };
+        std::atomic<bool> go{ false };
+        const std::uint64_t total = static_cast<std::uint64_t>(producers) * kPerProducer;
+
+        std::vector<std::thread> ts;
+        for (unsigned p = 0; p < producers; ++p) {
+            ts.emplace_back([&] {
+                while (!go.load(std::memory_order_acquire)) {}
+                for (int i = 0; i < kPerProducer; ++i)
+                    q.Push([&sink, i] { sink.fetch_add(static_cast<std::uint64_t>(i) & 1, std::memory_order_relaxed); });
+            });
+        }
+
+        const auto t0 = clock::now();
+        go.store(true, std::memory_order_release);
+        std::uint64_t done = 0;
+        while (done < total) done += q.Drain();
+        const auto t1 = clock::now();
+
+        for (auto& t : ts) t.join();
+        DoNotOptimize(sink);
+        return static_cast<double>(total) / (ElapsedNs(t0, t1) / 1e9) / 1e6;
+    }
+
+    void ProducerCase(Reporter& r) {
+        for (unsigned p : { 1u, 2u, 4u, 8u }) {
+            r.Report("lockfree p=" + std::to_string(p), ProducerThroughput<MB::GameTaskQueue>(p), "Mtask/s");
+            r.Report("mutex    p=" + std::to_string(p), ProducerThroughput<MutexQueue>(p), "Mtask/s");
+        }
+    }
+
+    // A task capturing 32 bytes (an entity handle plus a few floats): fits the
+    // node's inline buffer but not std::function's small-object buffer.
+    struct Payload {
+        std::atomic<std::uint64_t>* executed;
+        std::uint64_t handle;
+        float         x, y, z, w;
+    };
+
+    struct PushCost {
+        double p50Ns{ 0.0 };
+        double p99Ns{ 0.0 };
+        double p999Ns{ 0.0 };
+    };
+
+    constexpr int kBurst = 1024;     // tasks a producer queues per "frame"
+    constexpr int kBacklog = 8192;   // producers wait while more than this is queued
+
+    // Per-push cost seen by producers while the consumer drains concurrently.
+    // Unlike gamequeue/producers the backlog is bounded, as it is in game
+    // (a tick drains what the frame queued), so after a warm-up pass the node
+    // pool covers it and the measured pass is the steady state rather than
+    // pool growth. Every 16th push is timed.
+    template <class Q>
+    PushCost MeasurePushCost(unsigned producers) {
+        Q q;
+        std::atomic<std::uint64_t> executed{ 0 };
+        std::atomic<std::uint64_t> queued{ 0 };
+        const std::uint64_t total = static_cast<std::uint64_t>(producers) * kPerProducer;
+        std::vector<std::vector<std::uint32_t>> samples(producers);
+        PushCost c;
+
+        for (int pass = 0; pass < 2; ++pass) {
+            std::atomic<bool> go{ false };
+            executed.store(0);
+            queued.store(0);
+            for (auto& s : samples) { s.clear(); s.reserve(kPerProducer / 16 + 1); }
+
+            std::vector<std::thread> ts;
+            for (unsigned p = 0; p < producers; ++p) {
+                ts.emplace_back([&, p] {
+                    while (!go.load(std::memory_order_acquire)) {}
+                    for (int i = 0; i < kPerProducer; ++i) {
+                        if (i % kBurst == 0) {
+                            while (queued.load() - executed.load() > kBacklog) std::this_thread::yield();
+                            queued.fetch_add(kBurst);
+                        }
+                        Payload pl{ &executed, static_cast<std::uint64_t>(i), 1.f, 2.f, 3.f, 4.f };
+                        auto task = [pl] { pl.executed->fetch_add(1, std::memory_order_relaxed); };
+                        if ((i & 15) == 0) {
+                            const auto t0 = clock::now();
+                            q.Push(task);
+                            samples[p].push_back(static_cast<std::uint32_t>(std::min(ElapsedNs(t0, clock::now()), 4e9)));
+                        } else {
+                            q.Push(task);
+                        }
+                    }
+                });
+            }
+
+            go.store(true, std::memory_order_release);
+            std::uint64_t done = 0;
+            while (done < total) done += q.Drain();
+            for (auto& t : ts) t.join();
+        }
+
+        std::vector<std::uint32_t> all;
+        for (auto& s : samples) all.insert(all.end(), s.begin(), s.end());
+        std::sort(all.begin(), all.end());
+        auto at = [&](double f) { return static_cast<double>(all[static_cast<std::size_t>(f * (all.size() - 1))]); };
+
+        c.p50Ns = at(0.50);
+        c.p99Ns = at(0.99);
+        c.p999Ns = at(0.999);
+        return c;
+    }
+
+    // Allocations per task for one frame's burst, split into the producer's
+    // Push() and the consumer's Drain(). One warm-up frame first.
+    template <class Q>
+    std::pair<double, double> AllocsPerTask() {
+        Q q;
+        std::atomic<std::uint64_t> executed{ 0 };
+        std::uint64_t pushAllocs = 0, drainAllocs = 0;
+        for (int frame = 0; frame < 2; ++frame) {
+            const std::uint64_t a0 = AllocCount();
+            for (int i = 0; i < kBurst; ++i) {
+                Payload pl{ &executed, static_cast<std::uint64_t>(i), 1.f, 2.f, 3.f, 4.f };
+                q.Push([pl] { pl.executed->fetch_add(1, std::memory_order_relaxed); });
+            }
+            const std::uint64_t a1 = AllocCount();
+            q.Drain();
+            const std::uint64_t a2 = AllocCount();
+            pushAllocs = a1 - a0;
+            drainAllocs = a2 - a1;
+        }
+        return { static_cast<double>(pushAllocs) / kBurst, static_cast<double>(drainAllocs) / kBurst };
+    }
+
+    // What the lock-free queue buys over the mutex baseline. On a single core
+    // the mutex queue wins raw throughput (gamequeue/producers): an uncontended
+    // lock is cheap when only one thread runs at a time, and its Drain() takes
+    // the whole backlog in one swap, and its median push is cheaper too. The
+    // lock-free queue's case is the rest of the distribution: no allocation
+    // per task (std::function spills any capture over 16 bytes to the heap),
+    // and with several producers no push stalls behind a lock holder that was
+    // preempted mid-push, which is where the baseline's p99.9 comes from.
+    void PushCostCase(Reporter& r) {
+        const auto lfAllocs = AllocsPerTask<MB::GameTaskQueue>();
+        const auto mxAllocs = AllocsPerTask<MutexQueue>();
+        r.Report("lockfree allocs/push ", lfAllocs.first, "allocs");
+        r.Report("mutex    allocs/push ", mxAllocs.first, "allocs");
+        r.Report("lockfree allocs/drain", lfAllocs.second, "allocs");
+        r.Report("mutex    allocs/drain", mxAllocs.second, "allocs");
+
+        for (unsigned p : { 1u, 4u }) {
+            const std::string tag = " p=" + std::to_string(p);
+            const PushCost lf = MeasurePushCost<MB::GameTaskQueue>(p);
+            const PushCost mx = MeasurePushCost<MutexQueue>(p);
+            r.Report("lockfree push p50   " + tag, lf.p50Ns, "ns");
+            r.Report("mutex    push p50   " + tag, mx.p50Ns, "ns");
+            r.Report("lockfree push p99   " + tag, lf.p99Ns, "ns");
+            r.Report("mutex    push p99   " + tag, mx.p99Ns, "ns");
+            r.Report("lockfree push p99.9 " + tag, lf.p999Ns, "ns");
+            r.Report("mutex    push p99.9 " + tag, mx.p999Ns, "ns");
+        }
+    }
+
+    template <class Q, class Make>
+    double DrainNsPerTask(int burst, Make make) {
+        Q q;
+        double best = 1e30;
+        for (int rep = 0; rep < 20; ++rep) {
+            for (int i = 0; i < burst; ++i) q.Push(make(i));
+            const auto t0 = clock::now();
+            q.Drain();
+            const auto t1 = clock::now();
+            best = std::min(best, ElapsedNs(t0, t1) / burst);
+        }
+        return best;
+    }
+
+    std::uint64_t g_drainSink = 0;
+
+    void DrainCase(Reporter& r) {
+        auto small = [](int i) { return [i] { g_drainSink += static_cast<std::uint64_t>(i); }; };
+        auto large = [](int i) {
+            std::array<std::uint64_t, 12> pad{}; // 96 bytes: exceeds the inline buffer
+            pad[0] = static_cast<std::uint64_t>(i);
+            return [pad] { g_drainSink += pad[0]; };
+        };
+
+        for (int burst : { 500, 5000 }) {
+            const std::string b = " burst=" + std::to_string(burst);
+            r.Report("lockfree inline" + b, DrainNsPerTask<MB::GameTaskQueue>(burst, small), "ns/task");
+            r.Report("lockfree heap  " + b, DrainNsPerTask<MB::GameTaskQueue>(burst, large), "ns/task");
+            r.Report("mutex          " + b, DrainNsPerTask<MutexQueue>(burst, small), "ns/task");
+        }
+        DoNotOptimize(g_drainSink);
+    }
+
+    // 500-op burst of ~20 us tasks: unbudgeted vs 1.5 ms/tick budget.
+    void BudgetCase(Reporter& r) {
+        auto spin = [] {
+            const auto until = clock::now() + std::chrono::microseconds(20);
+            while (clock::now() < until) {}
+        };
+
+        for (bool budgeted : { false, true }) {
+            MB::GameTaskQueue q;
+            for (int i = 0; i < 500; ++i) q.Push(spin);
+
+            MB::GameTaskQueue::Budget b;
+            if (budgeted) b.time = std::chrono::microseconds(1500);
+
+            int ticks = 0;
+            std::uint64_t worstUsec = 0;
+            while (!q.Empty()) {
+                const auto rep = q.Pump(b);
+                worstUsec = std::max(worstUsec, rep.elapsedUsec);
+                ++ticks;
+            }
+            const std::string tag = budgeted ? "budget=1.5ms " : "unbudgeted   ";
+            r.Report(tag + "ticks", ticks, "ticks");
+            r.Report(tag + "worst tick", static_cast<double>(worstUsec), "us");
+        }
+    }
+
+    // Push-to-run latency with a consumer parked in WaitUntil() vs an 8 ms poll loop.
+    void WakeupCase(Reporter& r) {
+        for (bool polling : { false, true }) {
+            MB::GameTaskQueue q;
+            std::atomic<bool> run{ true };
+            std::atomic<std::int64_t> ranAt{ 0 };
+
+            std::thread consumer([&] {
+                while (run.load()) {
+                    if (polling) std::this_thread::sleep_for(std::chrono::milliseconds(8));
+                    else q.WaitUntil(clock::time_point::max());
+                    q.Drain();
+                }
+            });
+
+            constexpr int kSamples = 50;
+            double totalNs = 0.0;
+            for (int i = 0; i < kSamples; ++i) {
+                ranAt.store(0);
+                const auto t0 = clock::now();
+                q.Push([&] { ranAt.store((clock::now() - t0).count()); });
+                while (ranAt.load() == 0) std::this_thread::yield();
+                totalNs += static_cast<double>(ranAt.load());
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+
+            run.store(false);
+            q.Wake();
+            consumer.join();
+            r.Report(polling ? "poll 8ms  avg latency" : "event     avg latency", totalNs / kSamples / 1000.0, "us");
+        }
+    }
+
+} // namespace
+
+MB_BENCH_CASE("gamequeue/wakeup", WakeupCase);
+MB_BENCH_CASE("gamequeue/producers", ProducerCase);
+MB_BENCH_CASE("gamequeue/pushcost", PushCostCase);
+MB_BENCH_CASE("gamequeue/drain", DrainCase);
+MB_BENCH_CASE("gamequeue/budget", BudgetCase);
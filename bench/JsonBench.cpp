@@ -0,0 +1,94 @@
+// bench/JsonBench.cpp - nlohmann::json parse/dump of the envelopes MirrorBlade moves around:
+// an IPC request, its reply, and a full tick.stats-sized stats document; plus the whole
+// IPC round (parse -> Ops::Dispatch -> dump)
+#include "MBBench.hpp"
+#include "MBOps.hpp"
+#include "M4qXE.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+
+namespace {
+
+    using namespace MB::Bench;
+    using json = nlohmann::json;
+
+    const char* const kRequest =
+        R"({"op":"vehicle.spawn","id":1842,"args":{"record":"Vehicle.v_sport1_quadra_turbo",)"
+        R"("pos":[-1032.25,1841.5,27.75],"yaw":92.5,"speed":12.5,"persistent":true,"tags":["mb","bench"]}})";
+
+    const char* const kReply =
+        R"({"ok":true,"op":"vehicle.spawn","id":1842,"result":{"entityId":"0x3a91f02c11aa7b00",)"
+        R"("spawnedAt":[-1032.25,1841.5,27.75],"frame":918273,"note":"vehicle spawn"}})";
+
+    // A real stats document: the pool's own StatsJSON() (per-lane histograms,
+    // workers, counters) wrapped the way tick.stats returns it.
+    std::string StatsDocument() {
+        MB::M4qXE::Config cfg;
+        cfg.workers = 4;
+        MB::M4qXE pool(cfg);
+        pool.Start();
+        for (int i = 0; i < 20'000; ++i)
+            pool.Enqueue(static_cast<MB::M4qXE::Lane>(i & 3), [] {});
+        pool.Flush();
+        std::string s = R"({"ok":true,"result":{"m4qxe":)" + pool.StatsJSON() + R"(,"frame":918273}})";
+        pool.Stop();
+        return s;
+    }
+
+    void RunDoc(Reporter& r, const std::string& tag, const std::string& text, int iters) {
+        json doc;
+        const std::uint64_t a0 = AllocCount();
+        const auto t0 = clock::now();
+        for (int i = 0; i < iters; ++i) {
+            doc = json::parse(text);
+            DoNotOptimize(doc);
+        }
+        const auto t1 = clock::now();
+        const std::uint64_t a1 = AllocCount();
+
+        std::string out;
+        const auto t2 = clock::now();
+        for (int i = 0; i < iters; ++i) {
+            out = doc.dump();
+            DoNotOptimize(out);
+        }
+        const auto t3 = clock::now();
+
+        r.Report(tag + " bytes", static_cast<double>(text.size()), "B");
+        r.Report(tag + " parse", ElapsedNs(t0, t1) / iters, "ns/doc");
+        r.Report(tag + " parse allocs", static_cast<double>(a1 - a0) / iters, "/doc");
+        r.Report(tag + " dump", ElapsedNs(t2, t3) / iters, "ns/doc");
+        r.Report(tag + " parse rate", text.size() * static_cast<double>(iters) / (ElapsedNs(t0, t1) / 1e9) / 1e6, "MB/s");
+    }
+
+    void EnvelopeCase(Reporter& r) {
+        RunDoc(r, "request", kRequest, 100'000);
+        RunDoc(r, "reply  ", kReply, 100'000);
+        RunDoc(r, "stats  ", StatsDocument(), 5'000);
+    }
+
+    // What the IPC server does per message, minus the pipe.
+    void RoundTripCase(Reporter& r) {
+        constexpr int kIters = 100'000;
+        MB::Ops::I().Register("vehicle.spawn", [](const json& a) -> json { return { {"note", "vehicle spawn"}, {"args", a} }; });
+
+        const std::string request = kRequest;
+        std::size_t bytes = 0;
+        const auto t0 = clock::now();
+        for (int i = 0; i < kIters; ++i) {
+            const json in = json::parse(request);
+            const json reply = MB::Ops::I().Dispatch(in.value("op", ""), in.value("args", json::object()));
+            const std::string out = reply.dump();
+            bytes += out.size();
+        }
+        const auto t1 = clock::now();
+        DoNotOptimize(bytes);
+        r.Report("parse+dispatch+dump", ElapsedNs(t0, t1) / kIters, "ns/msg");
+    }
+
+} // namespace
+
+MB_BENCH_CASE("json/envelope", EnvelopeCase);
+MB_BENCH_CASE("json/roundtrip", RoundTripCase);
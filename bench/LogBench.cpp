@@ -0,0 +1,313 @@
+// bench/LogBench.cpp - MB::Logger caller-side cost per line (the tick's view), with 1..8
+// logging threads, against the old open/stat/append-per-line logger; writer batching;
+// MB_LOGF deferred formatting in text and binary mode; disabled-level cost per module;
+// a flood through a rate-limited call site; the flight recorder's share of a line
+#include "MBBench.hpp"
+#include "MBFlightRecorder.hpp"
+#include "MBLog.hpp"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using namespace MB::Bench;
+    namespace fs = std::filesystem;
+
+    // The previous Logger write path, kept here as the baseline: format, then
+    // under one mutex stat the file, open an ofstream, append, close.
+    class OldLogger {
+    public:
+        explicit OldLogger(fs::path file) : _cur(std::move(file)) {}
+
+        void Log(const char* fmt, ...) {
+            char msg[2048]{};
+            va_list ap; va_start(ap, fmt);
+            std::vsnprintf(msg, sizeof(msg), fmt, ap);
+            va_end(ap);
+
+            const auto now = std::chrono::system_clock::now();
+            const auto t = std::chrono::system_clock::to_time_t(now);
+            const auto us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()) % 1'000'000;
+            std::tm tm{};
+            localtime_r(&t, &tm);
+            std::ostringstream line;
+            line << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << "." << std::setw(6) << std::setfill('0') << us.count()
+                << " [INFO] " << msg;
+
+            std::scoped_lock lk{ _mtx };
+            std::error_code ec;
+            DoNotOptimize(fs::file_size(_cur, ec));
+            std::ofstream f(_cur, std::ios::app | std::ios::binary);
+            const std::string s = line.str();
+            f.write(s.data(), static_cast<std::streamsize>(s.size()));
+            f.put('\n');
+        }
+
+    private:
+        std::mutex _mtx;
+        fs::path _cur;
+    };
+
+    fs::path BenchDir() {
+        const fs::path dir = fs::temp_directory_path() / "mb_bench_log";
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+        fs::create_directories(dir, ec);
+        return dir;
+    }
+
+    // Bursts small enough to fit the ring, as a tick would log: only the time
+    // spent inside Log() counts; the writer catches up between bursts.
+    template <class F>
+    double CallerNs(unsigned threads, int bursts, int perBurst, F&& logOnce, void (*settle)()) {
+        std::atomic<std::int64_t> inLogNs{ 0 };
+        for (int b = 0; b < bursts; ++b) {
+            std::vector<std::thread> ts;
+            for (unsigned t = 0; t < threads; ++t) {
+                ts.emplace_back([&, t] {
+                    const auto t0 = clock::now();
+                    for (int i = 0; i < perBurst; ++i) logOnce(t, i);
+                    inLogNs.fetch_add(static_cast<std::int64_t>(ElapsedNs(t0, clock::now())), std::memory_order_relaxed);
+                });
+            }
+            for (auto& th : ts) th.join();
+            if (settle) settle();
+        }
+        return static_cast<double>(inLogNs.load()) / (static_cast<double>(bursts) * perBurst * threads);
+    }
+
+    void CallerCase(Reporter& r) {
+        const fs::path dir = BenchDir();
+        MB::Logger& log = MB::Log();
+        log.Init(dir, L"bench", 64 * 1024 * 1024, 2);
+        log.SetLevel(MB::LogLevel::Info);
+
+        for (unsigned t : { 1u, 2u, 4u, 8u }) {
+            const int perBurst = 4000 / static_cast<int>(t);
+            const auto s0 = log.GetStats();
+            const double ns = CallerNs(t, 25, perBurst, [&](unsigned th, int i) {
+                log.Log(MB::LogLevel::Info, "tick %d: thread %u pumped %d tasks in %.3f ms", i, th, i & 63, 0.125 * (i & 7));
+            }, [] { MB::Log().Flush(); });
+            const auto s1 = log.GetStats();
+            r.Report("ring   t=" + std::to_string(t), ns, "ns/line");
+            r.Report("ring   t=" + std::to_string(t) + " lines/write",
+                static_cast<double>(s1.lines - s0.lines) / static_cast<double>(s1.batches - s0.batches ? s1.batches - s0.batches : 1), "");
+            r.Report("ring   t=" + std::to_string(t) + " dropped", static_cast<double>(s1.dropped - s0.dropped), "");
+        }
+
+        // Below the level threshold: one relaxed load.
+        const double filtered = CallerNs(1, 1, 200'000, [&](unsigned, int i) {
+            log.Log(MB::LogLevel::Debug, "filtered %d", i);
+        }, nullptr);
+        r.Report("filtered (Debug < Info)", filtered, "ns/line");
+
+        // Long line spanning many slots.
+        const std::string big(1500, 'x');
+        const double longNs = CallerNs(1, 10, 400, [&](unsigned, int i) {
+            log.Log(MB::LogLevel::Info, "%d %s", i, big.c_str());
+        }, [] { MB::Log().Flush(); });
+        r.Report("ring   1.5KB line", longNs, "ns/line");
+
+        OldLogger old(dir / "old.log");
+        for (unsigned t : { 1u, 4u }) {
+            const double ns = CallerNs(t, 2, 2000 / static_cast<int>(t), [&](unsigned th, int i) {
+                old.Log("tick %d: thread %u pumped %d tasks in %.3f ms", i, th, i & 63, 0.125 * (i & 7));
+            }, nullptr);
+            r.Report("old    t=" + std::to_string(t), ns, "ns/line");
+        }
+
+        log.Flush();
+        const auto s = log.GetStats();
+        r.Report("rotations", static_cast<double>(s.rotations), "");
+    }
+
+    // Sustained rate until the file has every line, small rotation limit.
+    void ThroughputCase(Reporter& r) {
+        constexpr int kLines = 200'000;
+        const fs::path dir = BenchDir();
+        MB::Logger& log = MB::Log();
+        log.Init(dir, L"rot", 4 * 1024 * 1024, 3);
+
+        const auto s0 = log.GetStats();
+        const auto t0 = clock::now();
+        for (int i = 0; i < kLines; ++i) {
+            log.Log(MB::LogLevel::Info, "streaming sector %d loaded in %d us", i, i % 977);
+            if ((i & 2047) == 2047) log.Flush();
+        }
+        log.Flush();
+        const auto t1 = clock::now();
+        const auto s1 = log.GetStats();
+
+        r.Report("end to end", kLines / (ElapsedNs(t0, t1) / 1e9) / 1e6, "Mline/s");
+        r.Report("written", static_cast<double>(s1.lines - s0.lines), "lines");
+        r.Report("dropped", static_cast<double>(s1.dropped - s0.dropped), "");
+        r.Report("rotations", static_cast<double>(s1.rotations - s0.rotations), "");
+    }
+
+    // The same per-frame line formatted on the caller (Log) and deferred
+    // (MB_LOGF), with the writer producing text or binary records.
+    void DeferredCase(Reporter& r) {
+        const fs::path dir = BenchDir();
+        MB::Logger& log = MB::Log();
+        const char* mode = "FSR2";
+
+        for (MB::LogFormat f : { MB::LogFormat::Text, MB::LogFormat::Binary }) {
+            log.Init(dir, L"deferred", 64 * 1024 * 1024, 2, f);
+            const std::string tag = f == MB::LogFormat::Text ? "text   " : "binary ";
+
+            const double fmtNs = CallerNs(1, 25, 4000, [&](unsigned, int i) {
+                log.Log(MB::LogLevel::Info, "upscaler: frame %d %s %ux%u -> %ux%u jitter %.4f,%.4f in %.3f ms",
+                    i, mode, 1707u, 960u, 2560u, 1440u, 0.25 * (i & 3), -0.125, 0.731);
+            }, [] { MB::Log().Flush(); });
+            const double deferNs = CallerNs(1, 25, 4000, [&](unsigned, int i) {
+                MB_LOGF(MB::LogLevel::Info, "upscaler: frame %d %s %ux%u -> %ux%u jitter %.4f,%.4f in %.3f ms",
+                    i, mode, 1707u, 960u, 2560u, 1440u, 0.25 * (i & 3), -0.125, 0.731);
+            }, [] { MB::Log().Flush(); });
+
+            const auto s0 = log.GetStats();
+            const auto t0 = clock::now();
+            for (int i = 0; i < 100'000; ++i) {
+                MB_LOGF(MB::LogLevel::Info, "light sweep: %d adverts, %d portals, %llu us", i & 255, i & 15, 1234ull);
+                if ((i & 4095) == 4095) log.Flush();
+            }
+            log.Flush();
+            const double writerNs = ElapsedNs(t0, clock::now()) / 100'000;
+            const auto s1 = log.GetStats();
+
+            r.Report(tag + "Log() caller", fmtNs, "ns/line");
+            r.Report(tag + "MB_LOGF caller", deferNs, "ns/line");
+            r.Report(tag + "MB_LOGF end to end", writerNs, "ns/line");
+            r.Report(tag + "bytes/line", static_cast<double>(s1.bytes - s0.bytes) / static_cast<double>(s1.lines - s0.lines), "B");
+        }
+        log.Init(dir, L"deferred", 64 * 1024 * 1024, 2, MB::LogFormat::Text);
+    }
+
+    // A Debug line whose argument is costly to compute, with the upscaler
+    // module at Info: Log() still evaluates the argument before its level
+    // check, MB_LOGD skips it. Then the same line with the module at Debug
+    // while everything else stays at Info.
+    std::atomic<unsigned> g_argEvals{ 0 };
+
+    double Costly(int i) {
+        g_argEvals.fetch_add(1, std::memory_order_relaxed);
+        double acc = 0.0;
+        for (int k = 1; k <= 32; ++k) acc += static_cast<double>(i % k) / k;
+        return acc;
+    }
+
+    void LevelsCase(Reporter& r) {
+        MB::Logger& log = MB::Log();
+        log.Init(BenchDir(), L"levels", 64 * 1024 * 1024, 2, MB::LogFormat::Text);
+        log.SetLevel(MB::LogLevel::Info);
+        log.ClearModuleLevel(MB::LogModule::Upscaler);
+
+        g_argEvals = 0;
+        const double logNs = CallerNs(1, 25, 20000, [](unsigned, int i) {
+            MB::Log().Log(MB::LogLevel::Debug, "upscaler: history weight %.4f", Costly(i));
+        }, [] {});
+        const unsigned logEvals = g_argEvals.exchange(0);
+        const double offNs = CallerNs(1, 25, 20000, [](unsigned, int i) {
+            MB_LOGD(Upscaler, "history weight %.4f", Costly(i));
+        }, [] {});
+        const unsigned offEvals = g_argEvals.exchange(0);
+
+        log.SetModuleLevel(MB::LogModule::Upscaler, MB::LogLevel::Debug);
+        const double onNs = CallerNs(1, 25, 4000, [](unsigned, int i) {
+            MB_LOGD(Upscaler, "history weight %.4f", Costly(i));
+        }, [] { MB::Log().Flush(); });
+        const double otherNs = CallerNs(1, 25, 20000, [](unsigned, int i) {
+            MB_LOGD(IPC, "history weight %.4f", Costly(i));
+        }, [] {});
+        log.ClearModuleLevel(MB::LogModule::Upscaler);
+        log.Flush();
+
+        r.Report("disabled Log()", logNs, "ns/line");
+        r.Report("disabled Log() arg evals", static_cast<double>(logEvals), "");
+        r.Report("disabled MB_LOGD", offNs, "ns/line");
+        r.Report("disabled MB_LOGD arg evals", static_cast<double>(offEvals), "");
+        r.Report("module at debug, MB_LOGD", onNs, "ns/line");
+        r.Report("other module, MB_LOGD", otherNs, "ns/line");
+    }
+
+    // A failure loop on 4 threads logging the same Warn line, plain and
+    // through MB_LOGW_RL (default rate).
+    void RateLimitCase(Reporter& r) {
+        MB::Logger& log = MB::Log();
+        log.Init(BenchDir(), L"ratelimit", 64 * 1024 * 1024, 2, MB::LogFormat::Text);
+        log.SetLevel(MB::LogLevel::Info);
+
+        auto s0 = log.GetStats();
+        const double plainNs = CallerNs(4, 10, 5000, [](unsigned t, int i) {
+            MB_LOGW(IPC, "pipe read failed on client %u (attempt %d)", t, i);
+        }, [] { MB::Log().Flush(); });
+        auto s1 = log.GetStats();
+        r.Report("MB_LOGW caller", plainNs, "ns/line");
+        r.Report("MB_LOGW written", static_cast<double>(s1.lines - s0.lines), "lines");
+        r.Report("MB_LOGW dropped", static_cast<double>(s1.dropped - s0.dropped), "lines");
+
+        s0 = log.GetStats();
+        const double limitedNs = CallerNs(4, 10, 5000, [](unsigned t, int i) {
+            MB_LOGW_RL(IPC, "pipe read failed on client %u (attempt %d)", t, i);
+        }, [] { MB::Log().Flush(); });
+        s1 = log.GetStats();
+        r.Report("MB_LOGW_RL caller", limitedNs, "ns/line");
+        r.Report("MB_LOGW_RL written", static_cast<double>(s1.lines - s0.lines), "lines");
+        r.Report("MB_LOGW_RL suppressed", static_cast<double>(s1.suppressed - s0.suppressed), "lines");
+    }
+
+    // The file at Info, the flight recorder at Debug: a Debug line that only
+    // the recorder keeps, an Info line with and without the recorder, and a
+    // telemetry-style event written straight to the ring.
+    void FlightCase(Reporter& r) {
+        const fs::path dir = BenchDir();
+        MB::Logger& log = MB::Log();
+        log.Init(dir, L"flight", 64 * 1024 * 1024, 2, MB::LogFormat::Text);
+        log.SetLevel(MB::LogLevel::Info);
+        if (!MB::Flight().Open(dir / "bench.flight")) {
+            r.Report("flight recorder unavailable", 0.0, "");
+            return;
+        }
+
+        auto line = [](unsigned, int i) { MB_LOGI(Upscaler, "frame %d dispatch %.3f ms", i, 0.731); };
+        log.SetFlight(false);
+        const double fileNs = CallerNs(1, 25, 4000, line, [] { MB::Log().Flush(); });
+        log.SetFlight(true, MB::LogLevel::Debug);
+        const double bothNs = CallerNs(1, 25, 4000, line, [] { MB::Log().Flush(); });
+        const double debugNs = CallerNs(1, 25, 20000, [](unsigned, int i) {
+            MB_LOGD(Upscaler, "history weight %.4f", 0.25 * (i & 3));
+        }, [] {});
+        const double eventNs = CallerNs(4, 25, 20000, [](unsigned t, int i) {
+            MB::Flight().Event("tick.pump", i & 7, t, 0.0);
+        }, [] {});
+        const auto s = MB::Flight().GetStats();
+
+        log.SetFlight(false);
+        MB::Flight().Close();
+        log.Flush();
+
+        r.Report("MB_LOGI file only", fileNs, "ns/line");
+        r.Report("MB_LOGI file + flight", bothNs, "ns/line");
+        r.Report("MB_LOGD flight only", debugNs, "ns/line");
+        r.Report("Flight().Event, 4 threads", eventNs, "ns/event");
+        r.Report("flight records", static_cast<double>(s.records), "");
+    }
+
+} // namespace
+
+MB_BENCH_CASE("log/caller", CallerCase);
+MB_BENCH_CASE("log/throughput", ThroughputCase);
+MB_BENCH_CASE("log/deferred", DeferredCase);
+MB_BENCH_CASE("log/levels", LevelsCase);
+MB_BENCH_CASE("log/ratelimit", RateLimitCase);
+MB_BENCH_CASE("log/flight", FlightCase);
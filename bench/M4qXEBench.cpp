@@ -0,0 +1,577 @@
+// bench/M4qXEBench.cpp - M4qXE submit/execute scaling, 1..16 threads, vs the old single-lock pool;
+// futures and ParallelFor overhead; deadline lane vs bulk Low work; allocations per task;
+// group cancellation; per-lane submit vs drain cost at 1..16 producers; futures dropped by Stop()
+#include "MBBench.hpp"
+#include "M4qXE.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using namespace MB::Bench;
+    using Lane = MB::M4qXE::Lane;
+
+    // The previous M4qXE core (one mutex + cv over four weighted lanes, every
+    // task timed for the EWMA), kept here as the baseline.
+    class LockedPool {
+    public:
+        explicit LockedPool(unsigned workers) {
+            for (Lane l : { Lane::High, Lane::High, Lane::High, Lane::Normal, Lane::Normal, Lane::Low, Lane::IO })
+                _schedule.push_back(static_cast<int>(l));
+            for (unsigned i = 0; i < workers; ++i)
+                _threads.emplace_back([this] { loop(); });
+        }
+        ~LockedPool() {
+            {
+                std::lock_guard<std::mutex> lk(_mx);
+                _stopping = true;
+            }
+            _cv.notify_all();
+            for (auto& t : _threads) t.join();
+        }
+
+        bool Enqueue(Lane lane, std::function<void()> fn) {
+            {
+                std::lock_guard<std::mutex> lk(_mx);
+                _q[static_cast<int>(lane)].push_back(std::move(fn));
+                ++_pending;
+            }
+            _cv.notify_one();
+            return true;
+        }
+
+        void Flush() {
+            std::unique_lock<std::mutex> lk(_mx);
+            _idle.wait(lk, [this] { return _pending == 0; });
+        }
+
+    private:
+        void loop() {
+            for (;;) {
+                std::function<void()> fn;
+                {
+                    std::unique_lock<std::mutex> lk(_mx);
+                    _cv.wait(lk, [this] { return _stopping || _queued() > 0; });
+                    if (_stopping && _queued() == 0) return;
+                    for (std::size_t k = 0; k < _schedule.size() && !fn; ++k) {
+                        auto& q = _q[_schedule[_cursor]];
+                        _cursor = (_cursor + 1) % _schedule.size();
+                        if (!q.empty()) { fn = std::move(q.front()); q.pop_front(); }
+                    }
+                }
+                const auto t0 = clock::now();
+                fn();
+                const double usec = ElapsedNs(t0, clock::now()) / 1000.0;
+                std::lock_guard<std::mutex> lk(_mx);
+                _ewmaUsec = (_ewmaUsec <= 0.0) ? usec : (0.1 * usec + 0.9 * _ewmaUsec);
+                if (--_pending == 0) _idle.notify_all();
+            }
+        }
+        std::size_t _queued() const { return _q[0].size() + _q[1].size() + _q[2].size() + _q[3].size(); }
+
+        std::mutex _mx;
+        std::condition_variable _cv, _idle;
+        std::deque<std::function<void()>> _q[4];
+        std::vector<int> _schedule;
+        std::size_t _cursor{ 0 };
+        std::size_t _pending{ 0 };
+        double _ewmaUsec{ 0.0 };
+        bool _stopping{ false };
+        std::vector<std::thread> _threads;
+    };
+
+    struct StealPool {
+        MB::M4qXE q;
+        explicit StealPool(unsigned workers) : q(makeCfg(workers)) { q.Start(); }
+        ~StealPool() { q.Stop(); }
+        template <class F>
+        bool Enqueue(Lane lane, F&& fn) { return q.Enqueue(lane, std::forward<F>(fn)); }
+        void Flush() { q.Flush(); }
+        static MB::M4qXE::Config makeCfg(unsigned workers) {
+            MB::M4qXE::Config c;
+            c.workers = workers;
+            return c;
+        }
+    };
+
+    constexpr int kTotalTasks = 400'000;
+    constexpr Lane kLanes[] = { Lane::High, Lane::Normal, Lane::Low, Lane::IO };
+
+    // T producers feed T workers; tasks spread over all four lanes. Measures
+    // submit + execute throughput end to end (first submit to Flush()).
+    template <class Pool>
+    double SubmitThroughput(unsigned threads) {
+        Pool pool(threads);
+        std::atomic<std::uint64_t> sink{ 0 };
+        std::atomic<bool> go{ false };
+        const int perProducer = kTotalTasks / static_cast<int>(threads);
+
+        std::vector<std::thread> ts;
+        for (unsigned p = 0; p < threads; ++p) {
+            ts.emplace_back([&, p] {
+                while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                for (int i = 0; i < perProducer; ++i)
+                    pool.Enqueue(kLanes[(i + p) & 3], [&sink] { sink.fetch_add(1, std::memory_order_relaxed); });
+            });
+        }
+
+        const auto t0 = clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& t : ts) t.join();
+        pool.Flush();
+        const auto t1 = clock::now();
+
+        DoNotOptimize(sink);
+        return static_cast<double>(perProducer) * threads / (ElapsedNs(t0, t1) / 1e9) / 1e6;
+    }
+
+    void SubmitCase(Reporter& r) {
+        for (unsigned t : { 1u, 2u, 4u, 8u, 16u }) {
+            r.Report("stealing t=" + std::to_string(t), SubmitThroughput<StealPool>(t), "Mtask/s");
+            r.Report("locked   t=" + std::to_string(t), SubmitThroughput<LockedPool>(t), "Mtask/s");
+        }
+    }
+
+    // One lane at a time (the deadline lane via EnqueueDeadline), P producers
+    // against a fixed 4-worker pool. "submit" is producer wall time per task
+    // (the cost a caller pays to hand work off); "drain" is the time from the
+    // last submit returning until Flush() sees the lane empty, per task.
+    struct LaneRun {
+        double submitNs{ 0 };
+        double drainNs{ 0 };
+        double mtasks{ 0 };
+    };
+
+    LaneRun RunLane(int laneIdx, unsigned producers) {
+        constexpr int kLaneTasks = 160'000;
+        MB::M4qXE pool(StealPool::makeCfg(4));
+        pool.Start();
+        std::atomic<std::uint64_t> sink{ 0 };
+        std::atomic<bool> go{ false };
+        const int perProducer = kLaneTasks / static_cast<int>(producers);
+
+        std::vector<std::thread> ts;
+        for (unsigned p = 0; p < producers; ++p) {
+            ts.emplace_back([&] {
+                while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                const auto due = clock::now() + std::chrono::milliseconds(50);
+                for (int i = 0; i < perProducer; ++i) {
+                    auto fn = [&sink] { sink.fetch_add(1, std::memory_order_relaxed); };
+                    if (laneIdx < 4) pool.Enqueue(kLanes[laneIdx], fn);
+                    else pool.EnqueueDeadline(due, fn);
+                }
+            });
+        }
+
+        const auto t0 = clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& t : ts) t.join();
+        const auto t1 = clock::now();
+        pool.Flush();
+        const auto t2 = clock::now();
+        pool.Stop();
+
+        DoNotOptimize(sink);
+        const double n = static_cast<double>(perProducer) * producers;
+        return { ElapsedNs(t0, t1) / n, ElapsedNs(t1, t2) / n, n / (ElapsedNs(t0, t2) / 1e9) / 1e6 };
+    }
+
+    void LanesCase(Reporter& r) {
+        static const char* const kNames[] = { "high", "normal", "low", "io", "deadline" };
+        for (int l = 0; l < 5; ++l) {
+            for (unsigned p : { 1u, 2u, 4u, 8u, 16u }) {
+                const LaneRun run = RunLane(l, p);
+                const std::string tag = std::string(kNames[l]) + " p=" + std::to_string(p);
+                r.Report(tag + " submit", run.submitNs, "ns/task");
+                r.Report(tag + " drain", run.drainNs, "ns/task");
+                r.Report(tag + " total", run.mtasks, "Mtask/s");
+            }
+        }
+    }
+
+    // Fan-out from inside the pool: each task spawns two children down to a
+    // fixed depth, so work is created on worker threads and has to be stolen.
+    template <class Pool>
+    void Spawn(Pool& pool, std::atomic<std::uint64_t>& leaves, int depth) {
+        if (depth == 0) { leaves.fetch_add(1, std::memory_order_relaxed); return; }
+        for (int c = 0; c < 2; ++c)
+            pool.Enqueue(Lane::Normal, [&pool, &leaves, depth] { Spawn(pool, leaves, depth - 1); });
+    }
+
+    template <class Pool>
+    double SpawnThroughput(unsigned threads) {
+        constexpr int kDepth = 17; // 2^18 - 1 tasks
+        Pool pool(threads);
+        std::atomic<std::uint64_t> leaves{ 0 };
+
+        const auto t0 = clock::now();
+        pool.Enqueue(Lane::Normal, [&] { Spawn(pool, leaves, kDepth); });
+        pool.Flush();
+        const auto t1 = clock::now();
+
+        DoNotOptimize(leaves);
+        return static_cast<double>((1u << (kDepth + 1)) - 1) / (ElapsedNs(t0, t1) / 1e9) / 1e6;
+    }
+
+    void SpawnCase(Reporter& r) {
+        for (unsigned t : { 1u, 2u, 4u, 8u, 16u }) {
+            r.Report("stealing t=" + std::to_string(t), SpawnThroughput<StealPool>(t), "Mtask/s");
+            r.Report("locked   t=" + std::to_string(t), SpawnThroughput<LockedPool>(t), "Mtask/s");
+        }
+    }
+
+    // Bursty, blocking load (streaming-style IO): 40 x 500 us tasks every
+    // 40 ms, then a long quiet spell. Reports enqueue->start wait percentiles
+    // for a fixed single worker (the old `workers = 0` default) and an elastic
+    // pool, plus how far the elastic pool shrinks once the load goes away.
+    struct BurstResult {
+        double p50Us{ 0 }, p95Us{ 0 }, maxUs{ 0 };
+        std::size_t peakWorkers{ 0 }, endWorkers{ 0 };
+    };
+
+    BurstResult RunBursts(const MB::M4qXE::Config& cfg) {
+        constexpr int kBursts = 15;
+        constexpr int kPerBurst = 40;
+
+        MB::M4qXE pool(cfg);
+        pool.Start();
+
+        std::vector<double> waits(static_cast<std::size_t>(kBursts) * kPerBurst);
+        BurstResult res;
+        for (int b = 0; b < kBursts; ++b) {
+            for (int i = 0; i < kPerBurst; ++i) {
+                const auto enq = clock::now();
+                double* slot = &waits[static_cast<std::size_t>(b) * kPerBurst + i];
+                pool.Enqueue(kLanes[i & 3], [enq, slot] {
+                    *slot = ElapsedNs(enq, clock::now()) / 1000.0;
+                    std::this_thread::sleep_for(std::chrono::microseconds(500));
+                });
+            }
+            pool.Flush();
+            res.peakWorkers = std::max(res.peakWorkers, pool.WorkerCount());
+            std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(600)); // "menu" idle
+        res.endWorkers = pool.WorkerCount();
+        pool.Stop();
+
+        std::sort(waits.begin(), waits.end());
+        res.p50Us = waits[waits.size() / 2];
+        res.p95Us = waits[waits.size() * 95 / 100];
+        res.maxUs = waits.back();
+        return res;
+    }
+
+    void BurstCase(Reporter& r) {
+        MB::M4qXE::Config fixed;
+        fixed.workers = 1;
+
+        MB::M4qXE::Config elastic;
+        elastic.minWorkers = 1;
+        elastic.maxWorkers = 16;
+        elastic.lingerMs = 100;
+        elastic.growWaitP95Usec = 1000;
+
+        for (bool isElastic : { false, true }) {
+            const BurstResult b = RunBursts(isElastic ? elastic : fixed);
+            const std::string tag = isElastic ? "elastic 1..16 " : "fixed 1       ";
+            r.Report(tag + "wait p50", b.p50Us, "us");
+            r.Report(tag + "wait p95", b.p95Us, "us");
+            r.Report(tag + "wait max", b.maxUs, "us");
+            r.Report(tag + "peak workers", static_cast<double>(b.peakWorkers), "threads");
+            r.Report(tag + "idle workers", static_cast<double>(b.endWorkers), "threads");
+        }
+    }
+
+    // A batch kernel over 1M doubles (a few flops each, like the offset
+    // evaluators), serial vs ParallelFor at several grains and pool sizes,
+    // plus the fixed cost of a ParallelFor whose whole range is one chunk.
+    void ParallelForCase(Reporter& r) {
+        constexpr std::size_t kN = 1 << 20;
+        std::vector<double> xs(kN), out(kN);
+        for (std::size_t i = 0; i < kN; ++i) xs[i] = static_cast<double>(i) * 1e-6;
+        auto kernel = [&](std::size_t b, std::size_t e) {
+            for (std::size_t i = b; i < e; ++i) out[i] = std::tanh(xs[i] * 1.7) - 0.25 * xs[i];
+        };
+
+        auto t0 = clock::now();
+        kernel(0, kN);
+        auto t1 = clock::now();
+        DoNotOptimize(out[kN - 1]);
+        r.Report("serial", ElapsedNs(t0, t1) / 1e6, "ms");
+
+        for (unsigned t : { 1u, 2u, 4u, 8u, 16u }) {
+            MB::M4qXE::Config cfg;
+            cfg.workers = t;
+            MB::M4qXE pool(cfg);
+            pool.Start();
+            for (std::size_t grain : { std::size_t{ 1024 }, std::size_t{ 16384 } }) {
+                t0 = clock::now();
+                pool.ParallelFor(0, kN, grain, kernel);
+                t1 = clock::now();
+                DoNotOptimize(out[kN - 1]);
+                r.Report("t=" + std::to_string(t) + " grain=" + std::to_string(grain), ElapsedNs(t0, t1) / 1e6, "ms");
+            }
+            pool.Stop();
+        }
+
+        MB::M4qXE::Config cfg;
+        cfg.workers = 4;
+        MB::M4qXE pool(cfg);
+        pool.Start();
+        constexpr int kCalls = 20'000;
+        std::uint64_t sink = 0;
+        t0 = clock::now();
+        for (int i = 0; i < kCalls; ++i)
+            pool.ParallelFor(0, 64, 64, [&](std::size_t j) { sink += j; });
+        t1 = clock::now();
+        DoNotOptimize(sink);
+        r.Report("single-chunk call", ElapsedNs(t0, t1) / kCalls, "ns");
+        t0 = clock::now();
+        for (int i = 0; i < kCalls / 10; ++i)
+            pool.ParallelFor(0, 8, 1, [&](std::size_t j) { DoNotOptimize(j); });
+        t1 = clock::now();
+        r.Report("8-chunk call", ElapsedNs(t0, t1) / (kCalls / 10), "ns");
+        pool.Stop();
+    }
+
+    // Future round trips: submit + Get, a three-step Then chain, and a
+    // WhenAll over 1000 futures.
+    void FutureCase(Reporter& r) {
+        MB::M4qXE::Config cfg;
+        cfg.workers = 4;
+        MB::M4qXE pool(cfg);
+        pool.Start();
+
+        constexpr int kRounds = 20'000;
+        auto t0 = clock::now();
+        int acc = 0;
+        for (int i = 0; i < kRounds; ++i)
+            acc += pool.SubmitFuture(Lane::Normal, [i] { return i & 7; }).Get();
+        auto t1 = clock::now();
+        DoNotOptimize(acc);
+        r.Report("submit+get", ElapsedNs(t0, t1) / kRounds, "ns");
+
+        t0 = clock::now();
+        for (int i = 0; i < kRounds; ++i) {
+            acc += pool.SubmitFuture(Lane::High, [i] { return i; })
+                .Then(Lane::Normal, [](const int& v) { return v + 1; })
+                .Then(Lane::Low, [](const int& v) { return v & 3; })
+                .Get();
+        }
+        t1 = clock::now();
+        DoNotOptimize(acc);
+        r.Report("3-step chain", ElapsedNs(t0, t1) / kRounds, "ns");
+
+        constexpr int kFan = 1000;
+        constexpr int kFanRounds = 50;
+        std::atomic<int> ran{ 0 };
+        t0 = clock::now();
+        for (int k = 0; k < kFanRounds; ++k) {
+            std::vector<MB::M4qXE::Future<void>> fs;
+            fs.reserve(kFan);
+            for (int i = 0; i < kFan; ++i)
+                fs.push_back(pool.SubmitFuture(kLanes[i & 3], [&ran] { ran.fetch_add(1, std::memory_order_relaxed); }));
+            pool.WhenAll(fs).Get();
+        }
+        t1 = clock::now();
+        DoNotOptimize(ran);
+        r.Report("whenall x1000 per task", ElapsedNs(t0, t1) / (kFan * kFanRounds), "ns");
+        pool.Stop();
+    }
+
+    // Stop() without drain while futures are queued behind a busy worker:
+    // every dropped task must complete its future (and its Then() and
+    // WhenAll() dependants) with an error rather than leave Get() blocked.
+    // Waits are bounded so a regression reports instead of hanging.
+    void StopDropCase(Reporter& r) {
+        constexpr int kFutures = 1000;
+        MB::M4qXE::Config cfg;
+        cfg.workers = 1;
+        cfg.drainOnStop = false;
+        MB::M4qXE pool(cfg);
+        pool.Start();
+
+        std::atomic<bool> release{ false };
+        std::atomic<bool> busy{ false };
+        pool.Enqueue(Lane::High, [&] {
+            busy.store(true, std::memory_order_release);
+            while (!release.load(std::memory_order_acquire)) std::this_thread::yield();
+        });
+        while (!busy.load(std::memory_order_acquire)) std::this_thread::yield();
+
+        std::vector<MB::M4qXE::Future<int>> fs;
+        std::vector<MB::M4qXE::Future<int>> chained;
+        fs.reserve(kFutures);
+        chained.reserve(kFutures);
+        for (int i = 0; i < kFutures; ++i) {
+            fs.push_back(pool.SubmitFuture(kLanes[i & 3], [i] { return i; }));
+            chained.push_back(fs.back().Then(Lane::Normal, [](const int& v) { return v + 1; }));
+        }
+        auto all = pool.WhenAll(fs);
+
+        std::thread stopper([&] { pool.Stop(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const auto t0 = clock::now();
+        release.store(true, std::memory_order_release);
+        stopper.join();
+
+        int failed = 0;
+        int waiting = 0;
+        auto settle = [&](const MB::M4qXE::Future<int>& f) {
+            if (!f.WaitFor(std::chrono::seconds(1))) { ++waiting; return; }
+            try { DoNotOptimize(f.Get()); }
+            catch (const std::runtime_error&) { ++failed; }
+        };
+        for (const auto& f : fs) settle(f);
+        for (const auto& f : chained) settle(f);
+        const bool allDone = all.WaitFor(std::chrono::seconds(1));
+        const auto t1 = clock::now();
+
+        r.Report("futures failed (of 2000)", static_cast<double>(failed), "");
+        r.Report("futures left waiting", static_cast<double>(waiting), "");
+        r.Report("whenall completed", allDone ? 1.0 : 0.0, "");
+        r.Report("release to all settled", ElapsedNs(t0, t1) / 1e6, "ms");
+    }
+
+    // Two workers chew through 2000 x 100 us bulk Low tasks while 50
+    // frame-bound tasks (due 2 ms out) arrive every 500 us, once on Low and
+    // once on the Deadline lane. Reports the frame tasks' wait percentiles
+    // from the per-lane histograms and how many missed their deadline.
+    void DeadlineCase(Reporter& r) {
+        for (bool edf : { false, true }) {
+            MB::M4qXE::Config cfg;
+            cfg.workers = 2;
+            MB::M4qXE pool(cfg);
+            pool.Start();
+
+            for (int i = 0; i < 2000; ++i) {
+                pool.Enqueue(Lane::Low, [] {
+                    const auto until = clock::now() + std::chrono::microseconds(100);
+                    while (clock::now() < until) {}
+                });
+            }
+
+            std::atomic<int> late{ 0 };
+            for (int i = 0; i < 50; ++i) {
+                const auto due = clock::now() + std::chrono::milliseconds(2);
+                auto frame = [due, &late] { if (clock::now() > due) late.fetch_add(1, std::memory_order_relaxed); };
+                if (edf) pool.EnqueueDeadline(due, frame);
+                else     pool.Enqueue(Lane::Low, frame);
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            }
+            pool.Flush();
+
+            const auto s = pool.GetStats();
+            const auto& h = s.lanes[static_cast<std::size_t>(edf ? Lane::Deadline : Lane::Low)].wait;
+            const std::string tag = edf ? "deadline lane " : "low lane      ";
+            r.Report(tag + "wait p50", static_cast<double>(h.PercentileUsec(0.50)), "us<=");
+            r.Report(tag + "wait p95", static_cast<double>(h.PercentileUsec(0.95)), "us<=");
+            r.Report(tag + "frame tasks late", static_cast<double>(late.load()), "of 50");
+            pool.Stop();
+        }
+    }
+
+    // A scene's worth of Low work (5000 x 50 us) abandoned 5 ms in: the
+    // group is cancelled with one call, queued tasks are dropped at pickup
+    // and the running ones notice by polling. Reports how long the pool
+    // stays busy afterwards, against letting everything run.
+    void CancelCase(Reporter& r) {
+        constexpr int kTasks = 5000;
+        for (bool cancel : { false, true }) {
+            MB::M4qXE::Config cfg;
+            cfg.workers = 2;
+            MB::M4qXE pool(cfg);
+            pool.Start();
+
+            MB::CancellationSource scene;
+            for (int i = 0; i < kTasks; ++i) {
+                pool.Enqueue(Lane::Low, [] {
+                    const auto until = clock::now() + std::chrono::microseconds(50);
+                    while (clock::now() < until)
+                        if (MB::M4qXE::CancellationRequested()) return;
+                }, scene.Token());
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+            const auto t0 = clock::now();
+            if (cancel) scene.Cancel();
+            pool.Flush();
+            const auto t1 = clock::now();
+
+            const auto s = pool.GetStats();
+            const std::string tag = cancel ? "cancelled " : "run all   ";
+            r.Report(tag + "busy after scene change", ElapsedNs(t0, t1) / 1e6, "ms");
+            r.Report(tag + "dropped before run", static_cast<double>(s.cancelledBeforeRun), "");
+            r.Report(tag + "stopped during run", static_cast<double>(s.cancelledDuringRun), "");
+            pool.Stop();
+        }
+    }
+
+    // Allocations per task and throughput for a 40-byte capture (fits the
+    // 48-byte inline buffer) and a 96-byte one (heap fallback), pooled
+    // InplaceFunction nodes vs std::function on std::deque (the old path).
+    template <class Pool, std::size_t Pad>
+    void AllocRun(Reporter& r, const char* tag) {
+        constexpr int kTasks = 200'000;
+        struct Payload { unsigned char pad[Pad]; };
+
+        Pool pool(2);
+        std::atomic<std::uint64_t> sink{ 0 };
+        Payload p{};
+        // Warm up: first-use allocations (node chunks, deque blocks) are not per task.
+        for (int i = 0; i < 1000; ++i)
+            pool.Enqueue(kLanes[i & 3], [&sink, p] { sink.fetch_add(p.pad[0] + 1, std::memory_order_relaxed); });
+        pool.Flush();
+
+        const std::uint64_t a0 = AllocCount();
+        const auto t0 = clock::now();
+        for (int i = 0; i < kTasks; ++i)
+            pool.Enqueue(kLanes[i & 3], [&sink, p] { sink.fetch_add(p.pad[0] + 1, std::memory_order_relaxed); });
+        pool.Flush();
+        const auto t1 = clock::now();
+        const std::uint64_t a1 = AllocCount();
+
+        DoNotOptimize(sink);
+        const std::string name = std::string(tag) + " capture=" + std::to_string(Pad + sizeof(void*)) + "B";
+        r.Report(name + " allocs/task", static_cast<double>(a1 - a0) / kTasks, "");
+        r.Report(name + " throughput", kTasks / (ElapsedNs(t0, t1) / 1e9) / 1e6, "Mtask/s");
+    }
+
+    void AllocCase(Reporter& r) {
+        AllocRun<StealPool, 32>(r, "pooled  ");
+        AllocRun<LockedPool, 32>(r, "std::fn ");
+        AllocRun<StealPool, 88>(r, "pooled  ");
+        AllocRun<LockedPool, 88>(r, "std::fn ");
+
+        MB::M4qXE pool(StealPool::makeCfg(1));
+        pool.Start();
+        struct Big { unsigned char pad[96]; } big{};
+        for (int i = 0; i < 100; ++i) pool.Enqueue(Lane::Normal, [big] { DoNotOptimize(big); });
+        pool.Flush();
+        r.Report("heapFallbacks after 100 oversized", static_cast<double>(pool.GetStats().heapFallbacks), "");
+        pool.Stop();
+    }
+
+} // namespace
+
+MB_BENCH_CASE("m4qxe/submit", SubmitCase);
+MB_BENCH_CASE("m4qxe/lanes", LanesCase);
+MB_BENCH_CASE("m4qxe/spawn", SpawnCase);
+MB_BENCH_CASE("m4qxe/burst", BurstCase);
+MB_BENCH_CASE("m4qxe/parallelfor", ParallelForCase);
+MB_BENCH_CASE("m4qxe/future", FutureCase);
+MB_BENCH_CASE("m4qxe/stopdrop", StopDropCase);
+MB_BENCH_CASE("m4qxe/deadline", DeadlineCase);
+MB_BENCH_CASE("m4qxe/alloc", AllocCase);
+MB_BENCH_CASE("m4qxe/cancel", CancelCase);
@@ -0,0 +1,75 @@
+// bench/MBBench.hpp - tiny self-contained microbenchmark harness for mb_bench
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MB::Bench {
+
+    using clock = std::chrono::steady_clock;
+
+    inline double ElapsedNs(clock::time_point t0, clock::time_point t1) {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    }
+
+    // Collects metrics for one case; BenchMain prints them.
+    class Reporter {
+    public:
+        struct Metric {
+            std::string name;
+            double      value{ 0.0 };
+            std::string unit;
+        };
+
+        void Report(std::string_view metric, double value, std::string_view unit) {
+            _metrics.push_back({ std::string(metric), value, std::string(unit) });
+        }
+
+        const std::vector<Metric>& Metrics() const noexcept { return _metrics; }
+
+    private:
+        std::vector<Metric> _metrics;
+    };
+
+    // Global operator new calls so far in this process (BenchMain replaces
+    // the allocator with a counting one).
+    std::uint64_t AllocCount() noexcept;
+
+    using CaseFn = void(*)(Reporter&);
+
+    struct Case {
+        const char* name;
+        CaseFn      fn;
+    };
+
+    inline std::vector<Case>& Registry() {
+        static std::vector<Case> r;
+        return r;
+    }
+
+    struct Registrar {
+        Registrar(const char* name, CaseFn fn) { Registry().push_back({ name, fn }); }
+    };
+
+    // Keep the optimizer from discarding a computed value.
+    template <class T>
+    inline void DoNotOptimize(const T& v) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&v) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &v;
+#endif
+    }
+
+} // namespace MB::Bench
+
+#define MB_BENCH_CAT_(a, b) a##b
+#define MB_BENCH_CAT(a, b) MB_BENCH_CAT_(a, b)
+
+// MB_BENCH_CASE("group/name", fn) registers fn(Reporter&) at static-init time.
+#define MB_BENCH_CASE(name, fn) \
+    static ::MB::Bench::Registrar MB_BENCH_CAT(s_benchReg_, __LINE__){ name, fn }
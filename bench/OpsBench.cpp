@@ -0,0 +1,102 @@
+// bench/OpsBench.cpp - Ops::Dispatch lookup + call over a registry the size of the live one,
+// unknown-op misses, and concurrent dispatch from several threads
+#include "MBBench.hpp"
+#include "MBOps.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using namespace MB::Bench;
+    using json = nlohmann::json;
+
+    // Names in the shape of the real registry (MBOps / TGDKOps / lights), so the
+    // hash map sees realistic key lengths and bucket counts.
+    const char* const kOpNames[] = {
+        "ping", "upscaler.enable", "graphics.internal.scale", "traffic.mul", "ui.toast",
+        "timescale.set", "lod.pin", "npc.freeze", "npc.unfreeze", "npc.spawn", "npc.despawn",
+        "npc.teleport", "vehicle.spawn", "vehicle.despawn", "vehicle.boost", "vehicle.paint",
+        "vehicle.repair", "traffic.clear", "traffic.freeze", "traffic.unfreeze", "traffic.route",
+        "traffic.persist", "av.spawn", "av.route.set", "av.despawn", "av.land", "av.takeoff",
+        "train.persist", "train.spawn", "train.despawn", "train.freeze", "train.unfreeze",
+        "ui.alert", "ui.marker.add", "ui.marker.remove", "ui.hud.toggle", "time.set",
+        "time.pause", "time.resume", "weather.set", "player.teleport", "player.heal",
+        "player.damage", "player.inventory.add", "player.inventory.remove",
+        "world.spawn.explosion", "world.light.spawn", "world.light.remove",
+        "world.streamgrid.recenter", "world.lod.lock", "world.lod.unlock", "debug.log",
+        "debug.capture.screenshot", "config.set", "config.get", "figure8.evalBernoulli",
+        "figure8.evalLissajous12", "detox.set", "detox.eval", "detox.snapshot", "scooty.bump",
+        "scooty.snapshot", "scooty.samples", "telem.push", "telem.snapshot", "telem.table",
+        "lights.fake.adverts", "lights.fake.portals", "lights.fake.forceportals",
+        "lights.fake.sweep", "tick.stats",
+    };
+
+    void RegisterAll() {
+        static bool done = false;
+        if (done) return;
+        done = true;
+        for (const char* name : kOpNames)
+            MB::Ops::I().Register(name, [](const json& a) -> json { return { {"note", "ok"}, {"args", a} }; });
+        MB::Ops::I().Register("ping", [](const json&) -> json { return { {"ok", true}, {"result", "Pong"} }; });
+    }
+
+    template <class F>
+    double NsPerCall(int iters, F&& f) {
+        const auto t0 = clock::now();
+        for (int i = 0; i < iters; ++i) f();
+        return ElapsedNs(t0, clock::now()) / iters;
+    }
+
+    void DispatchCase(Reporter& r) {
+        constexpr int kIters = 200'000;
+        RegisterAll();
+
+        const json empty = json::object();
+        const json args = { {"record", "Vehicle.v_sport1_quadra_turbo"}, {"speed", 12.5}, {"pos", { 1.0, 2.0, 3.0 }} };
+        const std::string ping = "ping";
+        const std::string spawn = "vehicle.spawn";
+        const std::string missing = "vehicle.fly";
+
+        r.Report("hit ping", NsPerCall(kIters, [&] { DoNotOptimize(MB::Ops::I().Dispatch(ping, empty)); }), "ns/call");
+        r.Report("hit echo args", NsPerCall(kIters, [&] { DoNotOptimize(MB::Ops::I().Dispatch(spawn, args)); }), "ns/call");
+        r.Report("miss", NsPerCall(kIters, [&] { DoNotOptimize(MB::Ops::I().Dispatch(missing, empty)); }), "ns/call");
+
+        const std::uint64_t a0 = AllocCount();
+        for (int i = 0; i < 1000; ++i) DoNotOptimize(MB::Ops::I().Dispatch(ping, empty));
+        r.Report("allocs/ping", static_cast<double>(AllocCount() - a0) / 1000, "");
+    }
+
+    // Every IPC/REDscript entry point funnels through the same registry lock.
+    void ContendedCase(Reporter& r) {
+        constexpr int kPerThread = 100'000;
+        RegisterAll();
+
+        for (unsigned threads : { 1u, 2u, 4u, 8u }) {
+            std::atomic<bool> go{ false };
+            std::vector<std::thread> ts;
+            for (unsigned t = 0; t < threads; ++t) {
+                ts.emplace_back([&] {
+                    const json empty = json::object();
+                    const std::string ping = "ping";
+                    while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                    for (int i = 0; i < kPerThread; ++i) DoNotOptimize(MB::Ops::I().Dispatch(ping, empty));
+                });
+            }
+            const auto t0 = clock::now();
+            go.store(true, std::memory_order_release);
+            for (auto& t : ts) t.join();
+            const auto t1 = clock::now();
+            r.Report("ping t=" + std::to_string(threads),
+                static_cast<double>(kPerThread) * threads / (ElapsedNs(t0, t1) / 1e9) / 1e6, "Mcall/s");
+        }
+    }
+
+} // namespace
+
+MB_BENCH_CASE("ops/dispatch", DispatchCase);
+MB_BENCH_CASE("ops/contended", ContendedCase);
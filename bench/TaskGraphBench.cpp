@@ -0,0 +1,102 @@
+// bench/TaskGraphBench.cpp - TaskGraph replay: a frame of spinning subsystems (wall vs serial
+// vs critical path) and per-node scheduling overhead on empty nodes
+#include "MBBench.hpp"
+#include "MBTaskGraph.hpp"
+#include "M4qXE.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+    using namespace MB::Bench;
+    using Lane = MB::M4qXE::Lane;
+
+    auto Spin(int usec) {
+        return [usec] {
+            const auto until = clock::now() + std::chrono::microseconds(usec);
+            while (clock::now() < until) {}
+        };
+    }
+
+    // Shaped like the tick's per-frame work: 1300 us run back to back, 650 us
+    // along the longest chain (input > lights.sweep > upscaler.params > commit).
+    void FrameCase(Reporter& r) {
+        constexpr int kFrames = 100;
+
+        MB::M4qXE::Config cfg;
+        cfg.workers = 4;
+        MB::M4qXE pool(cfg);
+        pool.Start();
+
+        MB::TaskGraph g;
+        const auto input    = g.AddOnCaller("input", Spin(50));
+        const auto lights   = g.Add("lights.sweep", Spin(450), { input });
+        const auto loader   = g.Add("loader.recompute", Spin(300), { input });
+        const auto upscaler = g.Add("upscaler.params", Spin(100), { lights });
+        const auto traffic  = g.Add("traffic", Spin(200), { loader });
+        const auto tele     = g.Add("telemetry.flush", Spin(150), { input }, Lane::Low);
+        g.AddOnCaller("commit", Spin(50), { upscaler, traffic, tele });
+        g.Compile();
+
+        double wall = 0, work = 0, cp = 0;
+        for (int f = 0; f < kFrames; ++f) {
+            const auto& rep = g.Run(pool);
+            wall += static_cast<double>(rep.wallUsec);
+            work += static_cast<double>(rep.workUsec);
+            cp += static_cast<double>(rep.criticalPathUsec);
+        }
+        r.Report("frame wall", wall / kFrames, "us");
+        r.Report("frame work (serial)", work / kFrames, "us");
+        r.Report("critical path", cp / kFrames, "us");
+        r.Report("parallelism", work / wall, "x");
+
+        std::string path;
+        for (auto id : g.LastReport().criticalPath)
+            path += (path.empty() ? "" : " > ") + g.Name(id);
+        std::printf("  last critical path: %s\n", path.c_str());
+        pool.Stop();
+    }
+
+    // Empty nodes: a 64-wide fan-out/fan-in and a 64-long chain.
+    void OverheadCase(Reporter& r) {
+        constexpr int kFrames = 2000;
+        constexpr int kWidth = 64;
+
+        MB::M4qXE::Config cfg;
+        cfg.workers = 2;
+        MB::M4qXE pool(cfg);
+        pool.Start();
+
+        MB::TaskGraph fan;
+        const auto root = fan.Add("root", [] {});
+        std::vector<MB::TaskGraph::NodeId> mids;
+        for (int i = 0; i < kWidth; ++i)
+            mids.push_back(fan.Add("mid" + std::to_string(i), [] {}, { root }));
+        fan.Add("join", [] {}, mids);
+
+        MB::TaskGraph chain;
+        MB::TaskGraph::NodeId prev = chain.Add("n0", [] {});
+        for (int i = 1; i < kWidth; ++i)
+            prev = chain.Add("n" + std::to_string(i), [] {}, { prev });
+
+        for (auto* g : { &fan, &chain }) {
+            g->Run(pool);
+            const std::uint64_t a0 = AllocCount();
+            const auto t0 = clock::now();
+            for (int f = 0; f < kFrames; ++f) g->Run(pool);
+            const auto t1 = clock::now();
+            const std::uint64_t a1 = AllocCount();
+
+            const std::string tag = g == &fan ? "fan-out x64 " : "chain x64   ";
+            r.Report(tag + "per node", ElapsedNs(t0, t1) / (static_cast<double>(kFrames) * g->Size()), "ns");
+            r.Report(tag + "allocs/frame", static_cast<double>(a1 - a0) / kFrames, "");
+        }
+        pool.Stop();
+    }
+
+} // namespace
+
+MB_BENCH_CASE("graph/frame", FrameCase);
+MB_BENCH_CASE("graph/overhead", OverheadCase);
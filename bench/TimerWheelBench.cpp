@@ -0,0 +1,104 @@
+// bench/TimerWheelBench.cpp - timing wheel vs ordered-map timers at 100k pending
+#include "MBBench.hpp"
+#include "MBTimerWheel.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    using namespace MB::Bench;
+
+    // Typical "sorted deadlines" alternative, kept here as the baseline.
+    struct MapTimers {
+        using Map = std::multimap<std::uint64_t, std::function<void()>>;
+        Map           timers;
+        std::uint64_t now{ 0 };
+
+        template <class F>
+        Map::iterator Schedule(std::uint64_t delayMs, F&& f) {
+            return timers.emplace(now + (delayMs ? delayMs : 1), std::forward<F>(f));
+        }
+        void Cancel(Map::iterator it) { timers.erase(it); }
+
+        std::size_t Advance(std::uint64_t nowMs) {
+            now = nowMs;
+            std::size_t n = 0;
+            while (!timers.empty() && timers.begin()->first <= now) {
+                auto fn = std::move(timers.begin()->second);
+                timers.erase(timers.begin());
+                fn();
+                ++n;
+            }
+            return n;
+        }
+    };
+
+    constexpr int kTimers = 100'000;
+    std::uint64_t g_timerSink = 0;
+
+    struct Phases {
+        double scheduleNs{ 0 };
+        double cancelNs{ 0 };
+        double advanceNs{ 0 };
+    };
+
+    // Schedule kTimers with TTLs of 1 ms..60 s, cancel every third, then tick
+    // through 60 s in 1 ms steps (the per-frame cost that matters in the game).
+    template <class Timers, class Id>
+    Phases Run() {
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<std::uint32_t> ttl(1, 60'000);
+
+        Timers t;
+        std::vector<Id> ids;
+        ids.reserve(kTimers);
+
+        Phases p;
+        auto t0 = clock::now();
+        for (int i = 0; i < kTimers; ++i)
+            ids.push_back(t.Schedule(ttl(rng), [i] { g_timerSink += static_cast<std::uint64_t>(i); }));
+        auto t1 = clock::now();
+        p.scheduleNs = ElapsedNs(t0, t1) / kTimers;
+
+        t0 = clock::now();
+        int cancelled = 0;
+        for (int i = 0; i < kTimers; i += 3) { t.Cancel(ids[i]); ++cancelled; }
+        t1 = clock::now();
+        p.cancelNs = ElapsedNs(t0, t1) / cancelled;
+
+        t0 = clock::now();
+        for (std::uint64_t ms = 1; ms <= 60'000; ++ms) t.Advance(ms);
+        t1 = clock::now();
+        p.advanceNs = ElapsedNs(t0, t1) / 60'000;
+
+        DoNotOptimize(g_timerSink);
+        return p;
+    }
+
+    void TimersCase(Reporter& r) {
+        const Phases w = Run<MB::TimerWheel, MB::TimerWheel::TimerId>();
+        const Phases m = Run<MapTimers, MapTimers::Map::iterator>();
+
+        r.Report("wheel schedule", w.scheduleNs, "ns/timer");
+        r.Report("map   schedule", m.scheduleNs, "ns/timer");
+        r.Report("wheel cancel  ", w.cancelNs, "ns/timer");
+        r.Report("map   cancel  ", m.cancelNs, "ns/timer");
+        r.Report("wheel advance ", w.advanceNs, "ns/tick");
+        r.Report("map   advance ", m.advanceNs, "ns/tick");
+
+        // Whole scenario: 100k schedules, 33k cancels, 60k ticks.
+        auto total = [](const Phases& p) {
+            return (p.scheduleNs * kTimers + p.cancelNs * (kTimers / 3 + 1) + p.advanceNs * 60'000) / 1e6;
+        };
+        r.Report("wheel total   ", total(w), "ms");
+        r.Report("map   total   ", total(m), "ms");
+    }
+
+} // namespace
+
+MB_BENCH_CASE("timers/100k", TimersCase);
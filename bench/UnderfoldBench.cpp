@@ -0,0 +1,70 @@
+// bench/UnderfoldBench.cpp - AILLTUO::EvaluateNPCOffsetsMany over a LoomisUnderfold: per-element
+// Evaluate() (copy and sort the creases under the lock every time) against the batch overloads,
+// serial and split across M4qXE with ParallelFor at 1..8 workers
+#include "MBBench.hpp"
+#include "AILLTUO.hpp"
+#include "LoomisUnderfold.hpp"
+#include "M4qXE.hpp"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+    using namespace MB::Bench;
+
+    constexpr std::size_t kN = 1 << 18;
+
+    // Eight named creases spread over [0, 1), mixed priorities and gains.
+    void Populate(MB::LoomisUnderfold& uf) {
+        uf.SetCurve(MB::LoomisUnderfold::Curve::Hermite);
+        for (int i = 0; i < 8; ++i) {
+            MB::LoomisUnderfold::Crease c;
+            c.name = "crease_" + std::to_string(i);
+            c.pos = 0.0625 + 0.125 * i;
+            c.radius = 0.1;
+            c.gain = (i & 1) ? -0.3 : 0.6;
+            c.priority = (i * 5) % 3;
+            uf.Upsert(c);
+        }
+    }
+
+    void OffsetsCase(Reporter& r) {
+        MB::LoomisUnderfold uf;
+        Populate(uf);
+        MB::AILLTUO ai;
+        ai.SetUnderfold(&uf);
+
+        std::vector<double> xs(kN), out(kN);
+        for (std::size_t i = 0; i < kN; ++i) xs[i] = static_cast<double>(i) / kN;
+
+        // Before: what every element paid when the batch went through Evaluate(x).
+        auto t0 = clock::now();
+        for (std::size_t i = 0; i < kN; ++i) out[i] = uf.Evaluate(xs[i]);
+        auto t1 = clock::now();
+        DoNotOptimize(out[kN - 1]);
+        r.Report("per-element Evaluate", ElapsedNs(t0, t1) / kN, "ns/elem");
+
+        t0 = clock::now();
+        ai.EvaluateNPCOffsetsMany(xs.data(), out.data(), kN);
+        t1 = clock::now();
+        DoNotOptimize(out[kN - 1]);
+        r.Report("batch serial", ElapsedNs(t0, t1) / kN, "ns/elem");
+
+        for (unsigned t : { 1u, 2u, 4u, 8u }) {
+            MB::M4qXE::Config cfg;
+            cfg.workers = t;
+            MB::M4qXE pool(cfg);
+            pool.Start();
+            t0 = clock::now();
+            ai.EvaluateNPCOffsetsMany(xs.data(), out.data(), kN, pool, 4096);
+            t1 = clock::now();
+            DoNotOptimize(out[kN - 1]);
+            r.Report("batch pool t=" + std::to_string(t), ElapsedNs(t0, t1) / kN, "ns/elem");
+            pool.Stop();
+        }
+    }
+
+} // namespace
+
+MB_BENCH_CASE("underfold/offsets", OffsetsCase);
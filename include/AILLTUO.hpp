@@ -10,8 +10,10 @@
 
 namespace MB {
 
-    // Forward declaration to avoid a hard include here.
+    // Forward declarations to avoid hard includes here.
     class LoomisUnderfold;
+    class UnderfoldSnapshot;
+    class M4qXE;
 
     // -----------------------------------------------------------------------------
     // GentuoLM: tiny, deterministic word-picker / utterance generator
@@ -84,6 +86,8 @@ namespace MB {
         // Evaluation
         NPCOffset       EvaluateNPCOffset(double x) const;
         void            EvaluateNPCOffsetsMany(const double* xs, double* out, size_t n) const;
+        // Same, split into `grain`-sized chunks across the pool (blocks until done).
+        void            EvaluateNPCOffsetsMany(const double* xs, double* out, size_t n, M4qXE& pool, size_t grain = 1024) const;
         TrafficDecision EvaluateTraffic(double density01, double avgSpeed) const;
 
         // Dialogue
@@ -100,6 +104,8 @@ namespace MB {
         static double clamp(double v, double lo, double hi);
         static double sign(double v);
         static double crooked(double d, double k);
+        static void   evaluateOffsets(const UnderfoldSnapshot& uf, const Params& p,
+            const double* xs, double* out, size_t begin, size_t end);
 
         mutable std::mutex _mx;
         const LoomisUnderfold* _underfold = nullptr;
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace MB {
+
+    // -----------------------------------------------------------------------------
+    // InplaceFunction: move-only callable with a fixed inline buffer.
+    //
+    // Callables that fit in Cap bytes (and are nothrow-movable) live inside the
+    // object; anything larger falls back to a single heap allocation. IsInline()
+    // lets owners count how often the fallback is taken.
+    // -----------------------------------------------------------------------------
+    template <class Sig, std::size_t Cap = 48>
+    class InplaceFunction;
+
+    template <class R, class... Args, std::size_t Cap>
+    class InplaceFunction<R(Args...), Cap> {
+    public:
+        static constexpr std::size_t kCapacity = Cap;
+
+        InplaceFunction() noexcept = default;
+        InplaceFunction(std::nullptr_t) noexcept {}
+
+        template <class F,
+            class D = std::decay_t<F>,
+            class = std::enable_if_t<!std::is_same_v<D, InplaceFunction> &&
+                                     std::is_invocable_r_v<R, D&, Args...>>>
+        InplaceFunction(F&& f) {
+            Emplace(std::forward<F>(f));
+        }
+
+        InplaceFunction(InplaceFunction&& o) noexcept { moveFrom(o); }
+
+        InplaceFunction& operator=(InplaceFunction&& o) noexcept {
+            if (this != &o) {
+                Reset();
+                moveFrom(o);
+            }
+            return *this;
+        }
+
+        InplaceFunction(const InplaceFunction&) = delete;
+        InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+        ~InplaceFunction() { Reset(); }
+
+        // Construct a new target in place, destroying the old one first.
+        template <class F>
+        void Emplace(F&& f) {
+            using D = std::decay_t<F>;
+            Reset();
+            if constexpr (FitsInline<D>()) {
+                ::new (static_cast<void*>(_buf)) D(std::forward<F>(f));
+                _vt = &kInlineVT<D>;
+            }
+            else {
+                *reinterpret_cast<D**>(_buf) = new D(std::forward<F>(f));
+                _vt = &kHeapVT<D>;
+            }
+        }
+
+        void Reset() noexcept {
+            if (_vt) {
+                _vt->destroy(_buf);
+                _vt = nullptr;
+            }
+        }
+
+        R operator()(Args... args) {
+            return _vt->invoke(_buf, std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const noexcept { return _vt != nullptr; }
+        bool IsInline() const noexcept { return _vt && _vt->isInline; }
+
+        template <class F>
+        static constexpr bool FitsInline() noexcept {
+            return sizeof(F) <= Cap
+                && alignof(F) <= alignof(std::max_align_t)
+                && std::is_nothrow_move_constructible_v<F>;
+        }
+
+    private:
+        struct VTable {
+            R(*invoke)(void*, Args&&...);
+            void (*move)(void* dst, void* src) noexcept;
+            void (*destroy)(void*) noexcept;
+            bool isInline;
+        };
+
+        template <class D>
+        static inline constexpr VTable kInlineVT{
+            [](void* p, Args&&... a) -> R { return (*static_cast<D*>(p))(std::forward<Args>(a)...); },
+            [](void* dst, void* src) noexcept {
+                ::new (dst) D(std::move(*static_cast<D*>(src)));
+                static_cast<D*>(src)->~D();
+            },
+            [](void* p) noexcept { static_cast<D*>(p)->~D(); },
+            true
+        };
+
+        template <class D>
+        static inline constexpr VTable kHeapVT{
+            [](void* p, Args&&... a) -> R { return (**static_cast<D**>(p))(std::forward<Args>(a)...); },
+            [](void* dst, void* src) noexcept {
+                *static_cast<D**>(dst) = *static_cast<D**>(src);
+                *static_cast<D**>(src) = nullptr;
+            },
+            [](void* p) noexcept { delete *static_cast<D**>(p); },
+            false
+        };
+
+        void moveFrom(InplaceFunction& o) noexcept {
+            if (o._vt) {
+                o._vt->move(_buf, o._buf);
+                _vt = o._vt;
+                o._vt = nullptr;
+            }
+        }
+
+        static_assert(Cap >= sizeof(void*), "InplaceFunction needs room for the heap fallback pointer");
+
+        alignas(std::max_align_t) unsigned char _buf[Cap];
+        const VTable* _vt{ nullptr };
+    };
+
+} // namespace MB
@@ -7,6 +7,8 @@
 
 namespace MB {
 
+    class UnderfoldSnapshot;
+
     // LoomisUnderfold
     // ---------------
     // A lightweight, deterministic 1D "underfold" field.
@@ -60,7 +62,10 @@ namespace MB {
         double Evaluate(double x) const;             // folded position
         double EvaluateDelta(double x) const;        // Evaluate(x) - x
         double EvaluateDerivative(double x) const;   // d(Evaluate)/dx
-        void   EvaluateMany(const double* xs, double* out, size_t n) const;
+        void   EvaluateMany(const double* xs, double* out, size_t n) const;   // one snapshot for the batch
+
+        // Current creases and curve, ready to evaluate without the lock.
+        UnderfoldSnapshot Snapshot() const;
 
         // JSON IO (implemented in .cpp)
         // {
@@ -74,6 +79,8 @@ namespace MB {
         std::string SnapshotJSON() const;
 
     private:
+        friend class UnderfoldSnapshot;
+
         // Helpers (no locking)
         static double saturate(double v);
         static double smoothstep01(double t);
@@ -81,11 +88,8 @@ namespace MB {
         static bool   validName(std::string_view n);
 
         // Kernel and derivative wrt normalized distance t in [0,∞)
-        double kernel(double t) const;
-        double kernel_deriv_dt(double t) const; // dK/dt
-
-        // Unlocked snapshots for fast read
-        void snapshot(std::vector<Crease>& out, Curve& curve) const;
+        static double kernel(Curve c, double t);
+        static double kernel_deriv_dt(Curve c, double t); // dK/dt
 
     private:
         mutable std::mutex _mx;
@@ -93,4 +97,30 @@ namespace MB {
         std::vector<Crease> _creases; // keyed by name (uniqueness enforced in Upsert)
     };
 
+    // UnderfoldSnapshot
+    // -----------------
+    // A LoomisUnderfold frozen at one point: enabled creases only, already in
+    // application order, with the curve fixed. Evaluating through it takes no
+    // lock and allocates nothing, so a batch (or every chunk of a parallel
+    // one) shares a single snapshot instead of copying and sorting the creases
+    // per element. Later edits to the underfold are not seen.
+    class UnderfoldSnapshot {
+    public:
+        double Evaluate(double x) const;
+        double EvaluateDerivative(double x) const;
+        void   EvaluateMany(const double* xs, double* out, size_t n) const;   // out may alias xs
+
+    private:
+        friend class LoomisUnderfold;
+
+        struct Fold {
+            double pos = 0.0;
+            double radius = 1.0;
+            double gain = 0.0;
+        };
+
+        std::vector<Fold>      _folds;
+        LoomisUnderfold::Curve _curve = LoomisUnderfold::Curve::Smooth;
+    };
+
 } // namespace MB
@@ -1,30 +1,299 @@
 ﻿#pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <coroutine>
 #include <cstddef>
 #include <cstdint>
-#include <deque>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "InplaceFunction.hpp"
+#include "MBNodePool.hpp"
+
 namespace MB {
 
+    // -----------------------------------------------------------------------------
+    // M4qXE: four-lane weighted worker pool with work stealing.
+    //
+    //  - Each worker owns, per lane, a Chase-Lev deque (tasks enqueued from that
+    //    worker) and an MPSC inbox (tasks enqueued from outside the pool; external
+    //    producers spread round-robin over the inboxes). Idle workers steal from
+    //    other workers' deques and drain their inboxes, so there is no global
+    //    queue lock on either the submit or the pickup path.
+    //  - Lane weights are kept by a global arbiter: one atomic cursor over the
+    //    weighted schedule (e.g. H,H,H,N,N,L,IO) picks the lane each pickup tries
+    //    first; empty lanes fall through in schedule order as before.
+    //  - Deadline lane: tasks carrying an absolute deadline sit in one shared
+    //    min-heap and run earliest-deadline-first. Every pickup checks it
+    //    before the weighted lanes, so frame-bound work never waits behind
+    //    bulk Low/IO work; keep what goes there short.
+    //  - Tasks are InplaceFunction<void(), 48> held in NodePool nodes: producers
+    //    take free nodes in batches of up to 32 into a thread-local cache
+    //    (handed back when the thread exits, a worker retires, or the thread
+    //    moves to another pool), workers batch their freed nodes back (or
+    //    reuse them for tasks they spawn), so a steady submit/execute cycle
+    //    does not touch the allocator. Oversized captures fall back to the
+    //    heap and are counted in Stats::heapFallbacks.
+    //  - Placement: a lane may get dedicated workers (Config::lanes[l]) that run
+    //    only that lane, pinned to its core mask at its OS priority; shared
+    //    workers then never touch the lane, so e.g. Low/IO can be kept off the
+    //    engine's frame cores. Shared workers use sharedCpuMask/sharedPriority.
+    //    Every worker is named ("M4qXE/3", "M4qXE/IO.0") for profilers.
+    //  - Counters are sharded per worker / per inbox and summed by GetStats();
+    //    Flush() sums the same counters, so no task touches a pool-wide one.
+    //    Enqueue->start wait and run time are kept per lane as log2-bucketed
+    //    histograms (sampled, like the EWMA).
+    //  - Elastic sizing: a monitor samples enqueue->start wait every few ms and
+    //    adds workers (up to maxWorkers) while the p95 wait is over threshold or
+    //    the pool stops making progress with work queued; the highest-numbered
+    //    worker retires after lingerMs idle, down to minWorkers. Worker slots
+    //    are allocated for maxWorkers on the first Start() and kept until the
+    //    pool dies, so neither resizing nor a restart moves a queue (and stats
+    //    accumulate across restarts).
+    //  - Composition: SubmitFuture() returns a Future whose Then() chains a
+    //    continuation onto a lane, WhenAll() joins a set of futures, and
+    //    ParallelFor() splits an index range into grain-sized chunks that
+    //    workers and the calling thread claim from one atomic cursor.
+    //    Schedule(lane) is an awaitable that moves a coroutine (MBCoro.hpp)
+    //    onto a lane.
+    //  - Cancellation: Enqueue() takes an optional CancellationToken. A task
+    //    whose token is cancelled before it starts is dropped at pickup; a
+    //    running one can poll CancellationRequested(). Cancelling a source is
+    //    one atomic store however many tasks carry its token.
+    // -----------------------------------------------------------------------------
+    namespace M4qXEDetail {
+        // Shared state behind M4qXE::Future. Continuations registered before
+        // completion run on the completing thread; later ones run inline.
+        struct FutureStateBase {
+            std::mutex                         mx;
+            std::condition_variable            cv;
+            bool                               ready{ false };      // guarded by mx
+            std::exception_ptr                 error;               // written before ready
+            std::vector<std::function<void()>> continuations;       // guarded by mx
+
+            void Finish() {
+                std::vector<std::function<void()>> run;
+                {
+                    std::lock_guard<std::mutex> lk(mx);
+                    ready = true;
+                    run.swap(continuations);
+                }
+                cv.notify_all();
+                for (auto& fn : run) fn();
+            }
+
+            void OnReady(std::function<void()> fn) {
+                {
+                    std::lock_guard<std::mutex> lk(mx);
+                    if (!ready) {
+                        continuations.push_back(std::move(fn));
+                        return;
+                    }
+                }
+                fn();
+            }
+        };
+
+        template <class T>
+        struct FutureState : FutureStateBase {
+            std::optional<T> value;
+        };
+
+        template <>
+        struct FutureState<void> : FutureStateBase {};
+
+        // Run g and store its result (or exception) in st, then complete it.
+        template <class T, class G>
+        void Fulfil(FutureState<T>& st, G&& g) {
+            try {
+                if constexpr (std::is_void_v<T>) g();
+                else st.value.emplace(g());
+            }
+            catch (...) {
+                st.error = std::current_exception();
+            }
+            st.Finish();
+        }
+
+        // Owns the producing side of a future from submission until its task
+        // runs. A task the pool refuses, or drops unrun (Stop() without
+        // drain), destroys its guard instead, which completes the future with
+        // an error so Get()/WhenAll() do not wait forever.
+        template <class T>
+        class PromiseGuard {
+        public:
+            explicit PromiseGuard(std::shared_ptr<FutureState<T>> st) noexcept : _st(std::move(st)) {}
+            PromiseGuard(PromiseGuard&& o) noexcept : _st(std::move(o._st)) {}
+            PromiseGuard& operator=(PromiseGuard&&) = delete;
+
+            ~PromiseGuard() {
+                if (!_st) return;
+                _st->error = std::make_exception_ptr(std::runtime_error("M4qXE: task dropped before it ran"));
+                _st->Finish();
+            }
+
+            template <class G>
+            void Fulfil(G&& g) {
+                auto st = std::move(_st);
+                M4qXEDetail::Fulfil(*st, std::forward<G>(g));
+            }
+
+        private:
+            std::shared_ptr<FutureState<T>> _st;
+        };
+
+        // Chunk cursor shared by ParallelFor helpers; outlives the caller's
+        // frame only as far as claiming an out-of-range chunk.
+        struct ForState {
+            alignas(64) std::atomic<std::size_t> next{ 0 };
+            alignas(64) std::atomic<std::size_t> done{ 0 };
+            std::size_t             chunks{ 0 };
+            void*                   body{ nullptr };
+            void                  (*call)(void*, std::size_t){ nullptr };
+            std::mutex              mx;
+            std::condition_variable cv;
+            std::exception_ptr      error;       // first failure; guarded by mx
+
+            void Work() {
+                for (;;) {
+                    const std::size_t c = next.fetch_add(1, std::memory_order_relaxed);
+                    if (c >= chunks) return;
+                    try { call(body, c); }
+                    catch (...) {
+                        std::lock_guard<std::mutex> lk(mx);
+                        if (!error) error = std::current_exception();
+                    }
+                    if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks) {
+                        std::lock_guard<std::mutex> lk(mx);
+                        cv.notify_all();
+                    }
+                }
+            }
+        };
+
+        // One flag per CancellationSource; a linked source also sees its parent's.
+        struct CancelState {
+            std::atomic<bool>                  cancelled{ false };
+            std::shared_ptr<const CancelState> parent;
+
+            bool IsCancelled() const noexcept {
+                for (const CancelState* s = this; s; s = s->parent.get())
+                    if (s->cancelled.load(std::memory_order_acquire)) return true;
+                return false;
+            }
+        };
+    }
+
+    // Thrown by CancellationToken::ThrowIfCancelled(); M4qXE counts a task
+    // that exits this way as cancelled during run rather than as a failure.
+    class OperationCanceled : public std::runtime_error {
+    public:
+        OperationCanceled() : std::runtime_error("operation canceled") {}
+    };
+
+    // Read side of a CancellationSource. Cheap to copy; a default-constructed
+    // token is never cancelled.
+    class CancellationToken {
+    public:
+        CancellationToken() noexcept = default;
+
+        bool IsCancelled() const noexcept { return _state && _state->IsCancelled(); }
+        bool CanBeCancelled() const noexcept { return static_cast<bool>(_state); }
+        void ThrowIfCancelled() const {
+            if (IsCancelled()) throw OperationCanceled();
+        }
+
+    private:
+        friend class CancellationSource;
+        friend class M4qXE;
+        explicit CancellationToken(std::shared_ptr<const M4qXEDetail::CancelState> st) noexcept : _state(std::move(st)) {}
+
+        std::shared_ptr<const M4qXEDetail::CancelState> _state;
+    };
+
+    // Owner side: one source per group of work (e.g. per scene). Cancel() flips
+    // a single flag that every token handed out, and every source linked to
+    // it, observes. Sources are one-shot; start a new one for the next group.
+    class CancellationSource {
+    public:
+        CancellationSource() : _state(std::make_shared<M4qXEDetail::CancelState>()) {}
+
+        // Cancelled when `parent` is, or when this source is.
+        explicit CancellationSource(const CancellationToken& parent) : CancellationSource() {
+            _state->parent = parent._state;
+        }
+
+        CancellationToken Token() const noexcept { return CancellationToken(_state); }
+
+        // True if this call did the cancelling.
+        bool Cancel() noexcept { return !_state->cancelled.exchange(true, std::memory_order_acq_rel); }
+        bool IsCancelled() const noexcept { return _state->IsCancelled(); }
+
+    private:
+        std::shared_ptr<M4qXEDetail::CancelState> _state;
+    };
+
     class M4qXE {
     public:
-        enum class Lane { High, Normal, Low, IO };
-        using Task = std::function<void()>;
+        enum class Lane { High, Normal, Low, IO, Deadline };
+        static constexpr std::size_t kLaneCount = 5;
+        static constexpr std::size_t kFifoLanes = 4;      // weighted lanes; Deadline is separate
+        static constexpr std::size_t kInlineBytes = 48;
+        using Task = InplaceFunction<void(), kInlineBytes>;
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        // Log2 buckets of microseconds: [0] < 1 us, [b] < 2^b us.
+        static constexpr std::size_t kHistBuckets = 32;
+
+        struct Histogram {
+            std::uint64_t buckets[kHistBuckets]{};
+
+            std::uint64_t Count() const noexcept;
+            // Upper bound (us) of the bucket holding quantile q in [0, 1]; 0 if empty.
+            std::uint64_t PercentileUsec(double q) const noexcept;
+        };
+
+        struct LaneStats {
+            Histogram wait;   // enqueue -> start
+            Histogram run;    // start -> finish
+        };
+
+        // Per-lane placement. Masks are bit n = logical CPU n (first 64 CPUs);
+        // priority is -2 lowest .. +2 highest, 0 leaves the OS default.
+        struct LaneAffinity {
+            unsigned      dedicated{ 0 };   // workers that run only this lane
+            std::uint64_t cpuMask{ 0 };     // for the dedicated workers; 0 => any core
+            int           priority{ 0 };
+        };
 
         struct Config {
-            unsigned workers{ 0 };        // 0 => decide at runtime
+            unsigned workers{ 0 };        // initial workers; 0 => minWorkers
+            unsigned minWorkers{ 1 };
+            unsigned maxWorkers{ 0 };     // 0 => `workers` if set (fixed pool), else hardware threads
+            unsigned lingerMs{ 2000 };    // idle time before a worker above the minimum retires
+            unsigned growWaitP95Usec{ 2000 };   // grow when queue wait p95 exceeds this
             unsigned weightHigh{ 3 };
             unsigned weightNormal{ 2 };
             unsigned weightLow{ 1 };
             unsigned weightIO{ 1 };
             bool     drainOnStop{ true };
+
+            LaneAffinity  lanes[kLaneCount]{};   // indexed by Lane
+            std::uint64_t sharedCpuMask{ 0 };    // shared (elastic) workers; 0 => any core
+            int           sharedPriority{ 0 };
+            std::string   threadName{ "M4qXE" }; // prefix for worker thread names
         };
 
         struct Stats {
@@ -32,18 +301,40 @@ namespace MB {
             std::uint64_t executedNormal{ 0 };
             std::uint64_t executedLow{ 0 };
             std::uint64_t executedIO{ 0 };
+            std::uint64_t executedDeadline{ 0 };
 
             std::uint64_t enqHigh{ 0 };
             std::uint64_t enqNormal{ 0 };
             std::uint64_t enqLow{ 0 };
             std::uint64_t enqIO{ 0 };
+            std::uint64_t enqDeadline{ 0 };
 
             std::size_t pendingHigh{ 0 };
             std::size_t pendingNormal{ 0 };
             std::size_t pendingLow{ 0 };
             std::size_t pendingIO{ 0 };
+            std::size_t pendingDeadline{ 0 };
+
+            std::uint64_t deadlineMisses{ 0 };   // deadline tasks that started late
+
+            std::uint64_t cancelledBeforeRun{ 0 };   // dropped at pickup (still counted as executed)
+            std::uint64_t cancelledDuringRun{ 0 };   // token cancelled while the task ran
+
+            std::uint64_t heapFallbacks{ 0 };    // callable did not fit inline
+            std::uint64_t poolMisses{ 0 };       // node pool at its cap, node heap-allocated
+            std::size_t   poolNodes{ 0 };        // nodes owned by the pool
+            LaneStats     lanes[kLaneCount];     // indexed by Lane
 
             double ewmaUsec{ 0.0 };
+
+            std::uint64_t steals{ 0 };    // tasks taken from another worker
+            std::size_t   workers{ 0 };   // live worker threads right now (shared + dedicated)
+            std::size_t   dedicatedWorkers{ 0 };
+            std::size_t   minWorkers{ 0 };
+            std::size_t   maxWorkers{ 0 };
+            std::uint64_t grows{ 0 };
+            std::uint64_t shrinks{ 0 };
+            std::uint64_t waitP95Usec{ 0 };   // last monitor window (sampled)
         };
 
         static const char* LaneName(Lane l) noexcept;
@@ -52,12 +343,63 @@ namespace MB {
         explicit M4qXE(const Config& cfg);
         ~M4qXE();
 
+        M4qXE(const M4qXE&) = delete;
+        M4qXE& operator=(const M4qXE&) = delete;
+
         void Start();
         void Stop();
         void Flush();
 
-        bool Enqueue(Lane lane, Task task);
-        bool Enqueue(Lane lane, Task&& task);
+        // Lane::Deadline here means "due now": it runs ahead of the weighted
+        // lanes but after anything already queued with an earlier deadline.
+        // A task whose token is cancelled by pickup time is destroyed unrun.
+        bool Enqueue(Lane lane, Task task, CancellationToken token = {});
+
+        // Deadline lane, earliest deadline first (ties in submission order).
+        bool EnqueueDeadline(TimePoint deadline, Task task, CancellationToken token = {});
+
+        // Inside a task: the token it was enqueued with (empty elsewhere), and
+        // whether that token has been cancelled since. Long tasks poll this.
+        static CancellationToken CurrentToken();
+        static bool CancellationRequested() noexcept;
+
+        template <class T> class Future;
+
+        // Run fn on `lane`; the future holds its result or exception. If the
+        // pool refuses the task, or Stop() drops it unrun, the future
+        // completes with std::runtime_error.
+        template <class F, class R = std::invoke_result_t<std::decay_t<F>&>>
+        Future<R> SubmitFuture(Lane lane, F&& fn);
+
+        // Completes once every input has; carries the first error seen.
+        template <class T>
+        Future<void> WhenAll(const std::vector<Future<T>>& futures);
+
+        // Blocking loop over [begin, end) in chunks of `grain`. fn is either
+        // fn(i) per index or fn(chunkBegin, chunkEnd) per chunk. Up to
+        // WorkerCount() helper tasks go to `lane`; the caller claims chunks
+        // too, so this never deadlocks when called from a worker. The first
+        // exception thrown by fn is rethrown here after all chunks finish.
+        template <class F>
+        void ParallelFor(std::size_t begin, std::size_t end, std::size_t grain, F&& fn, Lane lane = Lane::Normal);
+
+        // `co_await pool.Schedule(lane)` resumes the coroutine on a worker
+        // serving `lane`. If the pool refuses the task (stopped) it simply
+        // continues on the current thread. If Stop() drops the task unrun,
+        // the coroutine is resumed on the stopping thread and the co_await
+        // throws std::runtime_error, so its frame unwinds instead of leaking.
+        struct ScheduleAwaiter {
+            M4qXE* pool;
+            Lane   lane;
+            bool   dropped{ false };
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> h);
+            void await_resume() const {
+                if (dropped) throw std::runtime_error("M4qXE: task dropped before it ran");
+            }
+        };
+        ScheduleAwaiter Schedule(Lane lane) noexcept { return { this, lane }; }
 
         bool   IsRunning() const noexcept;
         std::size_t WorkerCount() const;
@@ -65,31 +407,351 @@ namespace MB {
         std::string StatsJSON() const;
 
     private:
-        bool hasAnyPendingUnlocked() const;
-        void clearAllUnlocked();
-        bool tryPop(Task& out, Lane& outLane);
-        void workerLoop(unsigned workerIndex);
+        struct Node {
+            std::atomic<Node*> next{ nullptr };
+            Task               fn;
+            Lane               lane{ Lane::Normal };
+            std::int64_t       enqNs{ 0 };    // steady-clock stamp; 0 => not sampled
+            std::int64_t       deadlineNs{ 0 };   // Deadline lane only
+            std::uint64_t      seq{ 0 };          // Deadline lane tie-break
+            bool               trackMiss{ false };    // explicit deadline: count late starts
+            std::shared_ptr<const M4qXEDetail::CancelState> cancel;   // empty => not cancellable
+            Node*              freeNext{ nullptr };   // owned by whoever holds the node
+            bool               pooled{ true };
+        };
+
+        // Worker group: a lane index for dedicated workers, else shared.
+        static constexpr std::size_t kSharedGroup = kLaneCount;
+
+        static constexpr std::size_t kNodeChunk = 256;
+        static constexpr std::size_t kMaxNodeChunks = 1024;   // 256k pooled nodes
+        static constexpr std::size_t kFreeBatch = 64;         // worker-side frees per splice
+        static constexpr std::size_t kCacheBatch = 32;        // most nodes one producer holds
+
+        // Chase-Lev work-stealing deque (Le et al., "Correct and Efficient
+        // Work-Stealing for Weak Memory Models"). Owner pushes/takes at the
+        // bottom, thieves steal from the top. Outgrown rings are retired, not
+        // freed, until the deque dies, so a slow thief never reads freed memory.
+        class Deque {
+        public:
+            Deque();
+            ~Deque();
+            void  Push(Node* n);          // owner only
+            Node* Take();                 // owner only
+            Node* Steal();                // any thread
+            bool  Empty() const noexcept;
+
+        private:
+            struct Ring {
+                std::int64_t                         cap;
+                std::unique_ptr<std::atomic<Node*>[]> slots;
+                explicit Ring(std::int64_t c) : cap(c), slots(new std::atomic<Node*>[static_cast<std::size_t>(c)]) {}
+                Node* Get(std::int64_t i) const noexcept { return slots[static_cast<std::size_t>(i & (cap - 1))].load(std::memory_order_relaxed); }
+                void  Put(std::int64_t i, Node* n) noexcept { slots[static_cast<std::size_t>(i & (cap - 1))].store(n, std::memory_order_relaxed); }
+            };
+
+            alignas(64) std::atomic<std::int64_t> _top{ 0 };
+            alignas(64) std::atomic<std::int64_t> _bottom{ 0 };
+            std::atomic<Ring*>                    _ring;
+            std::vector<std::unique_ptr<Ring>>    _rings;   // owner only; current + retired
+        };
+
+        // Vyukov MPSC list for submissions from outside the pool. Any worker
+        // may consume, one at a time (try-lock), so inboxes can be stolen from.
+        struct Inbox {
+            alignas(64) std::atomic<Node*>         head;
+            std::atomic<std::uint64_t>             pushed{ 0 };
+            alignas(64) Node*                      tail;        // guarded by consuming
+            std::atomic<bool>                      consuming{ false };
+            std::atomic<std::uint64_t>             popped{ 0 };
+            Node                                   stub;
+
+            Inbox() : head(&stub), tail(&stub) {}
+            // Counts the push, then links n only if `open` still holds (the
+            // count doubles as Stop()'s view of pushes in flight). Returns
+            // false, n unlinked, if the pool stopped accepting meanwhile.
+            bool  TryPush(Node* n, const std::atomic<bool>& open) noexcept;
+            Node* TryPop() noexcept;            // nullptr if empty or contended
+            bool  Empty() const noexcept;
+        private:
+            void  link(Node* n) noexcept;
+            Node* popUnlocked() noexcept;
+        };
 
-        struct Q {
-            std::deque<Task> dq;
-            std::uint64_t enqCount{ 0 };
-            std::uint64_t execCount{ 0 };
+        // Shared EDF heap for the Deadline lane; `size` lets pickups skip the
+        // lock when it is empty.
+        struct DeadlineQueue {
+            std::mutex                 mx;
+            std::vector<Node*>         heap;          // guarded by mx
+            std::uint64_t              nextSeq{ 0 };  // guarded by mx
+            alignas(64) std::atomic<std::size_t>   size{ 0 };
+            std::atomic<std::uint64_t> pushed{ 0 };
         };
 
+        struct Worker {
+            Deque deques[kFifoLanes];
+            Inbox inbox[kFifoLanes];
+
+            // Owner-written counters, read by GetStats().
+            alignas(64) std::atomic<std::uint64_t> localPushed[kFifoLanes]{};
+            std::atomic<std::uint64_t> executed[kLaneCount]{};
+            std::atomic<std::uint64_t> steals{ 0 };
+            std::atomic<std::uint64_t> deadlineMisses{ 0 };
+            std::atomic<std::uint64_t> cancelledBeforeRun{ 0 };
+            std::atomic<std::uint64_t> cancelledDuringRun{ 0 };
+            std::atomic<double>        ewmaUsec{ 0.0 };
+            std::atomic<std::uint64_t> waitHist[kLaneCount][kHistBuckets]{};   // sampled enqueue->start
+            std::atomic<std::uint64_t> runHist[kLaneCount][kHistBuckets]{};    // sampled start->finish
+
+            std::size_t group{ kSharedGroup };
+
+            // Nodes this worker finished with, handed back in batches.
+            Node*       freeHead{ nullptr };
+            Node*       freeTail{ nullptr };
+            std::size_t freeCount{ 0 };
+        };
+
+        Node* findWork(unsigned self);
+        Node* takeFromLane(unsigned self, std::size_t lane);
+        Node* takeDedicated(unsigned self, std::size_t lane);
+        Node* takeDeadline();
+        bool  pushDeadline(Task&& task, std::int64_t deadlineNs, bool trackMiss, CancellationToken&& token);
+        bool  hasPendingFor(std::size_t group) const noexcept;
+        void  wakeGroup(std::size_t group);
+        void  applyThreadSettings(unsigned slot);
+        void  discardNode(Node* n) noexcept;
+        Node* acquireNode();
+        void  releaseNode(Worker& w, Node* n) noexcept;
+        void  flushFreeNodes(Worker& w) noexcept;
+        void  runTask(Worker& w, Node* n);
+        void  park(unsigned self);
+        std::uint64_t pendingTasks() const noexcept;
+        void  notifyFlush();
+        void  destroyPending(bool run);
+        void  workerLoop(unsigned workerIndex);
+        void  launchWorker(unsigned slot);
+        bool  tryRetire(unsigned self);
+        void  monitorLoop();
+        void  adjustPoolSize(std::uint64_t* prevHist, std::uint64_t& prevExec);
+
         Config _cfg{};
-        mutable std::mutex _mx;
-        std::condition_variable _cv;
 
         std::atomic<bool> _running{ false };
-        bool _stopping{ false };
+        std::atomic<bool> _accepting{ false };   // workers are built; Enqueue may proceed
+        std::atomic<bool> _stopping{ false };
+
+        // Weighted schedule plus, for each cursor position, the distinct lanes
+        // in the order a pickup starting there should try them.
+        std::vector<Lane>                                       _schedule;
+        std::vector<std::array<std::uint8_t, kFifoLanes>>       _laneOrder;
+        std::size_t                                             _sharedFifoLanes{ kFifoLanes };   // valid entries per row
+        alignas(64) std::atomic<std::uint64_t> _schedCursor{ 0 };   // the arbiter
+
+        DeadlineQueue                        _edf;
+
+        // Node pool: producers take batches into a thread-local cache;
+        // workers release theirs in kFreeBatch chains (releaseNode()).
+        NodePool<Node, kNodeChunk, kMaxNodeChunks, kCacheBatch> _nodes;
+        std::atomic<std::uint64_t>             _heapFallbacks{ 0 };
+
+        // One slot per possible worker (maxWorkers). Slots [0, _workerCount)
+        // have a live thread; producers target those. Thieves scan up to
+        // _slotsUsed so work stranded on a retired slot is still picked up.
+        std::vector<std::unique_ptr<Worker>> _workers;
+        std::vector<std::thread>             _threads;             // per slot; guarded by _resizeMx
+        std::atomic<std::size_t>             _workerCount{ 0 };
+        std::atomic<std::size_t>             _slotsUsed{ 0 };
+        unsigned                             _minWorkers{ 1 };
+        unsigned                             _maxWorkers{ 1 };
+        std::mutex                           _resizeMx;
+
+        // Dedicated workers sit in slots [_maxWorkers, _workers.size()), one
+        // contiguous range per lane. Fixed between Start() and Stop().
+        unsigned                             _dedicated[kLaneCount]{};
+        unsigned                             _dedicatedFirst[kLaneCount]{};
+
+        std::thread                          _monitor;
+        std::mutex                           _ctlMx;
+        std::condition_variable              _ctlCv;
+        std::atomic<std::uint64_t>           _grows{ 0 };
+        std::atomic<std::uint64_t>           _shrinks{ 0 };
+        std::atomic<std::uint64_t>           _lastWaitP95Usec{ 0 };
+
+        // Flush() callers waiting. Pending work is not counted globally: it is
+        // the per-inbox/per-worker pushed counts minus the per-worker executed
+        // counts, summed when a worker goes idle with a waiter registered.
+        alignas(64) std::atomic<unsigned> _flushWaiters{ 0 };
+
+        // Parking: workers sleep only after a failed scan; producers take the
+        // lock only if someone is asleep.
+        alignas(64) std::atomic<unsigned> _sleepers{ 0 };
+        std::atomic<unsigned>   _laneSleepers[kLaneCount]{};   // dedicated workers, per lane
+        std::mutex              _parkMx;
+        std::condition_variable _parkCv;
+        std::condition_variable _laneParkCv[kLaneCount];
+        std::uint64_t           _wakeSeq{ 0 };       // guarded by _parkMx
 
-        std::vector<Lane> _schedule;
-        std::size_t _schedCursor{ 0 };
+        std::mutex              _flushMx;
+        std::condition_variable _flushCv;
+    };
+
+    // ---------- Future ----------
+
+    template <class T>
+    class M4qXE::Future {
+    public:
+        using State = M4qXEDetail::FutureState<T>;
+
+        Future() = default;
+
+        bool Valid() const noexcept { return static_cast<bool>(_st); }
+
+        bool IsReady() const {
+            std::lock_guard<std::mutex> lk(_st->mx);
+            return _st->ready;
+        }
+
+        void Wait() const {
+            std::unique_lock<std::mutex> lk(_st->mx);
+            _st->cv.wait(lk, [this] { return _st->ready; });
+        }
+
+        template <class Rep, class Period>
+        bool WaitFor(const std::chrono::duration<Rep, Period>& d) const {
+            std::unique_lock<std::mutex> lk(_st->mx);
+            return _st->cv.wait_for(lk, d, [this] { return _st->ready; });
+        }
+
+        // Blocks, then returns the value (const T&) or rethrows the task's error.
+        decltype(auto) Get() const {
+            Wait();
+            if (_st->error) std::rethrow_exception(_st->error);
+            if constexpr (!std::is_void_v<T>) return static_cast<const T&>(*_st->value);
+        }
+
+        // Queue fn on `lane` once this future is ready. fn takes const T& (or
+        // nothing for Future<void>); if this future failed, fn is skipped and
+        // the error is forwarded.
+        template <class F>
+        auto Then(Lane lane, F&& fn) const {
+            using Fn = std::decay_t<F>;
+            using U = typename std::conditional_t<std::is_void_v<T>,
+                std::invoke_result<Fn&>, std::invoke_result<Fn&, const T&>>::type;
+
+            auto next = std::make_shared<M4qXEDetail::FutureState<U>>();
+            auto src = _st;
+            M4qXE* pool = _pool;
+            src->OnReady([src, next, pool, lane, f = Fn(std::forward<F>(fn))]() mutable {
+                if (src->error) {
+                    next->error = src->error;
+                    next->Finish();
+                    return;
+                }
+                // Refused (or no pool): destroying `run` completes `next`.
+                auto run = [src, p = M4qXEDetail::PromiseGuard<U>(next), f = std::move(f)]() mutable {
+                    p.Fulfil([&]() -> U {
+                        if constexpr (std::is_void_v<T>) return f();
+                        else return f(*src->value);
+                    });
+                };
+                if (pool) pool->Enqueue(lane, std::move(run));
+            });
+            return Future<U>(pool, std::move(next));
+        }
+
+    private:
+        friend class M4qXE;
+        template <class> friend class Future;
 
-        std::vector<std::thread> _threads;
+        Future(M4qXE* pool, std::shared_ptr<State> st) : _pool(pool), _st(std::move(st)) {}
 
-        Q _qHigh, _qNormal, _qLow, _qIO;
-        double _ewmaUsec{ 0.0 };
+        M4qXE*                 _pool{ nullptr };
+        std::shared_ptr<State> _st;
     };
 
+    template <class F, class R>
+    M4qXE::Future<R> M4qXE::SubmitFuture(Lane lane, F&& fn) {
+        auto st = std::make_shared<M4qXEDetail::FutureState<R>>();
+        // A refused task completes st with an error as it is destroyed.
+        Enqueue(lane, [p = M4qXEDetail::PromiseGuard<R>(st), f = std::decay_t<F>(std::forward<F>(fn))]() mutable {
+            p.Fulfil(f);
+        });
+        return Future<R>(this, std::move(st));
+    }
+
+    template <class T>
+    M4qXE::Future<void> M4qXE::WhenAll(const std::vector<Future<T>>& futures) {
+        auto out = std::make_shared<M4qXEDetail::FutureState<void>>();
+
+        struct Join {
+            std::atomic<std::size_t> left{ 0 };
+            std::mutex               mx;
+            std::exception_ptr       error;
+        };
+        auto join = std::make_shared<Join>();
+        join->left.store(futures.size() + 1, std::memory_order_relaxed);
+
+        auto arrive = [join, out](const std::exception_ptr& err) {
+            if (err) {
+                std::lock_guard<std::mutex> lk(join->mx);
+                if (!join->error) join->error = err;
+            }
+            if (join->left.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                out->error = join->error;
+                out->Finish();
+            }
+        };
+
+        for (const auto& f : futures) {
+            if (!f.Valid()) { arrive(nullptr); continue; }
+            auto st = f._st;
+            st->OnReady([st, arrive] { arrive(st->error); });
+        }
+        arrive(nullptr);   // registration done; an empty set completes here
+        return Future<void>(this, std::move(out));
+    }
+
+    template <class F>
+    void M4qXE::ParallelFor(std::size_t begin, std::size_t end, std::size_t grain, F&& fn, Lane lane) {
+        if (end <= begin) return;
+        if (grain == 0) grain = 1;
+        const std::size_t chunks = (end - begin + grain - 1) / grain;
+
+        auto runChunk = [&](std::size_t c) {
+            const std::size_t b = begin + c * grain;
+            const std::size_t e = (end - b > grain) ? b + grain : end;
+            if constexpr (std::is_invocable_v<F&, std::size_t, std::size_t>) {
+                fn(b, e);
+            }
+            else {
+                for (std::size_t i = b; i < e; ++i) fn(i);
+            }
+        };
+
+        std::size_t helpers = chunks - 1;
+        const std::size_t live = WorkerCount();
+        if (helpers > live) helpers = live;
+        if (helpers == 0) {
+            for (std::size_t c = 0; c < chunks; ++c) runChunk(c);
+            return;
+        }
+
+        auto st = std::make_shared<M4qXEDetail::ForState>();
+        st->chunks = chunks;
+        st->body = &runChunk;
+        st->call = [](void* body, std::size_t c) { (*static_cast<decltype(runChunk)*>(body))(c); };
+
+        for (std::size_t h = 0; h < helpers; ++h) {
+            if (!Enqueue(lane, [st] { st->Work(); })) break;
+        }
+        st->Work();
+
+        // Chunks claimed by helpers may still be running.
+        if (st->done.load(std::memory_order_acquire) != chunks) {
+            std::unique_lock<std::mutex> lk(st->mx);
+            st->cv.wait(lk, [&] { return st->done.load(std::memory_order_acquire) == chunks; });
+        }
+        if (st->error) std::rethrow_exception(st->error);
+    }
+
 } // namespace MB
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "InplaceFunction.hpp"
+
+namespace MB {
+
+    class M4qXE;
+
+    // -----------------------------------------------------------------------------
+    // AsyncIO: file reads/writes/fsyncs without parking a worker per syscall.
+    //
+    //  - Linux: operations become io_uring SQEs (raw syscalls, no liburing).
+    //    Submitters stage SQEs under a short lock; one reaper thread submits
+    //    whatever is staged and reaps completions in batches, so a burst of
+    //    small appends costs one io_uring_enter per batch, not one syscall per
+    //    write. A submitter only enters the kernel itself once kSubmitBatch
+    //    SQEs are waiting; otherwise an idle reaper is woken to submit, and a
+    //    busy one submits after its next completion.
+    //  - Elsewhere, or when io_uring_setup fails (old kernel, seccomp), the
+    //    same API runs each operation as a blocking call on M4qXE's IO lane
+    //    (or inline when no pool is given / the pool refuses work).
+    //  - Every operation holds one slot of a fixed table (Config::queueDepth);
+    //    when all are busy, submitters wait. Completions run on the reaper (or
+    //    on the IO worker) with the byte count or -errno; keep them short and
+    //    do not block on further AsyncIO work from inside one.
+    //  - Buffers must stay valid until the completion runs. offset < 0 means
+    //    "current file position" (appends on O_APPEND files).
+    // -----------------------------------------------------------------------------
+    class AsyncIO {
+    public:
+#if defined(_WIN32)
+        using FileHandle = void*;   // HANDLE
+#else
+        using FileHandle = int;
+#endif
+        enum class Backend { Auto, ThreadPool, IoUring };
+
+        // Bytes transferred, 0 for fsync, or -errno (Windows: -GetLastError()).
+        using Completion = InplaceFunction<void(std::int64_t), 48>;
+
+        struct Config {
+            Backend     backend{ Backend::Auto };
+            unsigned    queueDepth{ 256 };
+            M4qXE*      pool{ nullptr };   // thread-pool backend runs on pool's IO lane
+        };
+
+        struct Stats {
+            std::uint64_t submitted{ 0 };
+            std::uint64_t completed{ 0 };
+            std::uint64_t failed{ 0 };       // result < 0
+            std::uint64_t enterCalls{ 0 };   // io_uring_enter syscalls
+            std::uint64_t reapBatches{ 0 };  // reaper wake-ups that found completions
+            std::uint64_t slotWaits{ 0 };    // submitter blocked on a full table
+            std::size_t   inflight{ 0 };
+        };
+
+        static constexpr unsigned kSubmitBatch = 16;
+
+        explicit AsyncIO(const Config& cfg);
+        ~AsyncIO();   // waits for everything in flight
+
+        AsyncIO(const AsyncIO&) = delete;
+        AsyncIO& operator=(const AsyncIO&) = delete;
+
+        // False if the backend is shut down; the completion is not called then.
+        bool Read(FileHandle f, void* buf, std::size_t len, std::int64_t offset, Completion done);
+        bool Write(FileHandle f, const void* buf, std::size_t len, std::int64_t offset, Completion done);
+        bool Fsync(FileHandle f, Completion done);
+
+        // Block until every operation submitted so far has completed.
+        void Flush();
+
+        Backend     ActiveBackend() const noexcept { return _backend; }
+        Stats       GetStats() const;
+        std::string StatsJSON() const;
+
+    private:
+        enum class Op : std::uint8_t { Read, Write, Fsync };
+
+        struct Slot {
+            Op            op{ Op::Read };
+            FileHandle    file{};
+            void*         buf{ nullptr };
+            std::size_t   len{ 0 };
+            std::int64_t  offset{ 0 };
+            Completion    done;
+            std::uint32_t nextFree{ 0 };
+        };
+
+        struct Ring;   // io_uring mappings (Linux only)
+
+        bool     submit(Op op, FileHandle f, void* buf, std::size_t len, std::int64_t offset, Completion&& done);
+        std::uint32_t acquireSlot(std::unique_lock<std::mutex>& lk);
+        void     complete(const std::uint32_t* slots, const std::int64_t* results, std::size_t n);
+        void     runBlocking(std::uint32_t slot);
+        bool     setupRing(unsigned entries);
+        void     stageSqe(std::uint32_t slot);
+        unsigned unsubmitted() const noexcept;
+        void     enterRing(unsigned toSubmit, unsigned minComplete);
+        void     reaperLoop();
+
+        Backend                 _backend{ Backend::ThreadPool };
+        M4qXE*                  _pool{ nullptr };
+        std::unique_ptr<Slot[]> _slots;
+        std::uint32_t           _slotCount{ 0 };
+        std::uint32_t           _slotRefill{ 1 };   // free slots that wake blocked submitters
+
+        std::mutex              _mx;
+        std::condition_variable _slotCv;      // a slot was freed
+        std::condition_variable _reaperCv;    // work for an idle reaper
+        std::condition_variable _idleCv;      // inflight reached zero (Flush)
+        std::uint32_t           _freeHead{ 0 };    // guarded by _mx
+        std::size_t             _inflight{ 0 };    // guarded by _mx
+        unsigned                _slotWaiters{ 0 }; // guarded by _mx
+        bool                    _stopping{ false };
+
+        std::unique_ptr<Ring>   _ring;
+        std::thread             _reaper;
+
+        std::atomic<std::uint64_t> _submitted{ 0 };
+        std::atomic<std::uint64_t> _completed{ 0 };
+        std::atomic<std::uint64_t> _failed{ 0 };
+        std::atomic<std::uint64_t> _enterCalls{ 0 };
+        std::atomic<std::uint64_t> _reapBatches{ 0 };
+        std::atomic<std::uint64_t> _slotWaits{ 0 };
+    };
+
+} // namespace MB
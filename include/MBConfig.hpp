@@ -1,7 +1,12 @@
 #pragma once
 #include <atomic>
 #include <filesystem>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
+
+#include "MBSnapshot.hpp"
 
 namespace MB {
 
@@ -14,6 +19,26 @@ namespace MB {
         std::atomic<bool>     ipcEnabled{ true };
         std::wstring          ipcPipeName{ L"\\\\.\\pipe\\MirrorBladeBridge" };
         std::atomic<LogLevel> logLevel{ LogLevel::Info };
+        std::atomic<bool>     logBinary{ false };   // logging.format: "text" | "binary"
+
+        // logging.modules: per-module level overrides, indexed by MB::LogModule
+        // (core, ipc, upscaler, lights, loader); -1 follows logLevel.
+        static constexpr int  kLogModules = 5;
+        std::atomic<int>      logModuleLevel[kLogModules]{ -1, -1, -1, -1, -1 };
+
+        // logging.retention: rotated segments; 0 = no cap
+        std::atomic<int>      logKeep{ 5 };
+        std::atomic<int>      logMaxTotalMB{ 64 };
+        std::atomic<int>      logMaxAgeDays{ 7 };
+        std::atomic<bool>     logCompress{ true };
+
+        // logging.flight: crash flight recorder; level as MB::LogLevel
+        std::atomic<bool>     flightEnabled{ true };
+        std::atomic<int>      flightLevel{ 1 };   // debug
+
+        // watch: config hot reload; "auto" (change notifications) | "poll"
+        std::atomic<bool>     watchPoll{ false };
+        std::atomic<int>      watchCoalesceMs{ 100 };
 
         // --- explicit copy/move (atomics are non-copyable by default) ---
         Config() = default;
@@ -23,7 +48,17 @@ namespace MB {
             , traffic(o.traffic.load())
             , ipcEnabled(o.ipcEnabled.load())
             , ipcPipeName(o.ipcPipeName)
-            , logLevel(o.logLevel.load()) {
+            , logLevel(o.logLevel.load())
+            , logBinary(o.logBinary.load())
+            , logKeep(o.logKeep.load())
+            , logMaxTotalMB(o.logMaxTotalMB.load())
+            , logMaxAgeDays(o.logMaxAgeDays.load())
+            , logCompress(o.logCompress.load())
+            , flightEnabled(o.flightEnabled.load())
+            , flightLevel(o.flightLevel.load())
+            , watchPoll(o.watchPoll.load())
+            , watchCoalesceMs(o.watchCoalesceMs.load()) {
+            copyLogModules(o);
         }
 
         Config& operator=(const Config& o) {
@@ -33,6 +68,16 @@ namespace MB {
                 ipcEnabled.store(o.ipcEnabled.load());
                 ipcPipeName = o.ipcPipeName;
                 logLevel.store(o.logLevel.load());
+                logBinary.store(o.logBinary.load());
+                logKeep.store(o.logKeep.load());
+                logMaxTotalMB.store(o.logMaxTotalMB.load());
+                logMaxAgeDays.store(o.logMaxAgeDays.load());
+                logCompress.store(o.logCompress.load());
+                flightEnabled.store(o.flightEnabled.load());
+                flightLevel.store(o.flightLevel.load());
+                watchPoll.store(o.watchPoll.load());
+                watchCoalesceMs.store(o.watchCoalesceMs.load());
+                copyLogModules(o);
             }
             return *this;
         }
@@ -42,7 +87,17 @@ namespace MB {
             , traffic(o.traffic.load())
             , ipcEnabled(o.ipcEnabled.load())
             , ipcPipeName(std::move(o.ipcPipeName))
-            , logLevel(o.logLevel.load()) {
+            , logLevel(o.logLevel.load())
+            , logBinary(o.logBinary.load())
+            , logKeep(o.logKeep.load())
+            , logMaxTotalMB(o.logMaxTotalMB.load())
+            , logMaxAgeDays(o.logMaxAgeDays.load())
+            , logCompress(o.logCompress.load())
+            , flightEnabled(o.flightEnabled.load())
+            , flightLevel(o.flightLevel.load())
+            , watchPoll(o.watchPoll.load())
+            , watchCoalesceMs(o.watchCoalesceMs.load()) {
+            copyLogModules(o);
         }
 
         Config& operator=(Config&& o) noexcept {
@@ -52,6 +107,16 @@ namespace MB {
                 ipcEnabled.store(o.ipcEnabled.load());
                 ipcPipeName = std::move(o.ipcPipeName);
                 logLevel.store(o.logLevel.load());
+                logBinary.store(o.logBinary.load());
+                logKeep.store(o.logKeep.load());
+                logMaxTotalMB.store(o.logMaxTotalMB.load());
+                logMaxAgeDays.store(o.logMaxAgeDays.load());
+                logCompress.store(o.logCompress.load());
+                flightEnabled.store(o.flightEnabled.load());
+                flightLevel.store(o.flightLevel.load());
+                watchPoll.store(o.watchPoll.load());
+                watchCoalesceMs.store(o.watchCoalesceMs.load());
+                copyLogModules(o);
             }
             return *this;
         }
@@ -60,7 +125,12 @@ namespace MB {
         static std::filesystem::path ResolveConfigPath();
         static Config LoadFromFile(const std::filesystem::path& path);
         std::string ToJSON() const;
-        void ApplyRuntime(); // push live values into subsystems
+        void ApplyRuntime(); // push every live value into subsystems (all handlers)
+
+    private:
+        void copyLogModules(const Config& o) {
+            for (int i = 0; i < kLogModules; ++i) logModuleLevel[i].store(o.logModuleLevel[i].load());
+        }
     };
 
     // --- global API used by Plugin.cpp and ops ---
@@ -69,7 +139,46 @@ namespace MB {
     bool ReloadConfig();
     bool SaveConfig();
 
-    const Config& GetConfig();
-    void SetConfig(const Config& c);
+    // The live config is an immutable snapshot, replaced whole by every load,
+    // reload and SetConfig(). Every field read through ConfigSnapshot() comes
+    // from the same publish; keep the pointer for as long as the values have
+    // to agree with each other. ConfigSnapshot() takes a short spin lock to
+    // copy the pointer (a reference count increment). Hot paths that read it
+    // every frame hold a ConfigReader() per thread instead: once warm, its
+    // Get() is one atomic load, with no lock and no reference count traffic.
+    std::shared_ptr<const Config> ConfigSnapshot();
+    Snapshot<Config>::Reader ConfigReader();
+
+    Config GetConfig();                 // a copy of ConfigSnapshot()
+    void SetConfig(const Config& c);    // publishes a copy of c
+    // Edits a copy of the current config and publishes it, serialized with
+    // other writers (a reload cannot slip in between read and write).
+    std::shared_ptr<const Config> UpdateConfig(const std::function<void(Config&)>& edit);
+
+    // --- single values by JSON pointer into the file form (config.get/.set) ---
+    // Values are JSON text. Get is false if nothing is at the pointer ("" is
+    // the whole config). Set publishes and applies at once (objects merge,
+    // null removes, e.g. "/logging/modules/ipc" back to inherit) and returns
+    // the value now in force, after clamping, in `effective`. Sets collect
+    // in a dirty overlay that is replayed over reloads until the config's
+    // writer thread saves the file: once sets have been quiet for 500 ms, at
+    // most 5 s after the first, and on ShutdownConfig(). SetConfig() and
+    // UpdateConfig() change memory only, as before.
+    bool GetConfigValue(const std::string& pointer, std::string& valueJson);
+    bool SetConfigValue(const std::string& pointer, const std::string& valueJson,
+        std::string& effective, std::string& error);
+
+    // --- change handlers ---
+    // ApplyConfig() (run by every load and reload) diffs the current snapshot
+    // against the last applied one, leaf by leaf in the config's JSON form,
+    // logs each changed key with its old and new value, and calls only the
+    // handlers registered for a changed key or a parent of one. Keys are JSON
+    // pointers: "/logging" covers "/logging/retention/keep". The first apply
+    // runs every handler. Handlers run on the applying thread and must not
+    // call ApplyConfig() themselves.
+    using ConfigHandler = std::function<void(const Config&)>;
+    int  OnConfigChange(std::vector<std::string> keys, ConfigHandler fn);   // returns an id
+    void RemoveConfigHandler(int id);
+    void ApplyConfig();
 
 } // namespace MB
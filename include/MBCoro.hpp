@@ -0,0 +1,208 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace MB {
+
+    // -----------------------------------------------------------------------------
+    // Coroutines over M4qXE and the game-thread pump.
+    //
+    //  - Task<T> is lazy: nothing runs until it is awaited or handed to Spawn().
+    //    `co_await task` starts it and resumes the awaiter with its result (or
+    //    rethrows its exception) by symmetric transfer, so long await chains do
+    //    not grow the stack.
+    //  - A coroutine runs wherever its last await resumed it:
+    //        co_await pool.Schedule(M4qXE::Lane::Low);   // a worker serving Low
+    //        co_await NextTick();                        // next game-thread pump
+    //        co_await Delay(250);                        // game thread, >= 250 ms on
+    //  - Frames come from a pooled allocator: power-of-two size classes
+    //    (128 B..4 KB) carved from 64 KB slabs, with a per-thread free cache that
+    //    trades fixed batches with a shared list, so a frame created on one thread
+    //    and finished on another is recycled without touching the heap. Larger
+    //    frames fall back to the heap and are counted in CoroStats::heapFrames.
+    //  - NextTick()/Delay() need GameThreadHooks installed by the host (the
+    //    bridge does so at startup); without them the await throws
+    //    std::runtime_error. A coroutine parked on the game thread when the
+    //    bridge shuts down is never resumed and its frame is not reclaimed.
+    // -----------------------------------------------------------------------------
+
+    template <class T = void> class Task;
+
+    namespace CoroDetail {
+        void* AllocFrame(std::size_t size);
+        void  FreeFrame(void* p, std::size_t size) noexcept;
+        void  ReportDetachedError(std::exception_ptr error) noexcept;
+
+        struct PromiseBase {
+            std::coroutine_handle<> continuation;
+            std::exception_ptr      error;
+            bool                    detached{ false };
+
+            // Hand control to whoever awaited us; a detached frame frees itself.
+            struct FinalAwaiter {
+                bool await_ready() const noexcept { return false; }
+                template <class P>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+                    PromiseBase& p = h.promise();
+                    if (p.continuation) return p.continuation;
+                    if (p.detached) {
+                        if (p.error) ReportDetachedError(p.error);
+                        h.destroy();
+                    }
+                    return std::noop_coroutine();
+                }
+                void await_resume() const noexcept {}
+            };
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            FinalAwaiter        final_suspend() const noexcept { return {}; }
+            void unhandled_exception() noexcept { error = std::current_exception(); }
+
+            static void* operator new(std::size_t size) { return AllocFrame(size); }
+            static void  operator delete(void* p, std::size_t size) noexcept { FreeFrame(p, size); }
+        };
+
+        template <class T>
+        struct Promise : PromiseBase {
+            std::optional<T> value;
+
+            Task<T> get_return_object() noexcept;
+            template <class U = T>
+            void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+        };
+
+        template <>
+        struct Promise<void> : PromiseBase {
+            Task<void> get_return_object() noexcept;
+            void return_void() const noexcept {}
+        };
+    }
+
+    template <class T>
+    class [[nodiscard]] Task {
+        static_assert(!std::is_reference_v<T>, "Task<T&> is not supported; return a pointer");
+
+    public:
+        using promise_type = CoroDetail::Promise<T>;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Task() noexcept = default;
+        explicit Task(Handle h) noexcept : _h(h) {}
+        Task(Task&& o) noexcept : _h(std::exchange(o._h, {})) {}
+        Task& operator=(Task&& o) noexcept {
+            if (this != &o) {
+                reset();
+                _h = std::exchange(o._h, {});
+            }
+            return *this;
+        }
+        ~Task() { reset(); }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        bool Valid() const noexcept { return static_cast<bool>(_h); }
+        bool Done() const noexcept { return _h && _h.done(); }
+
+        // Start the coroutine now; its frame frees itself when it finishes.
+        // A detached task that throws has the error logged, not rethrown.
+        void Detach() && {
+            if (!_h) return;
+            Handle h = std::exchange(_h, {});
+            h.promise().detached = true;
+            h.resume();
+        }
+
+        auto operator co_await() & noexcept { return Awaiter{ _h }; }
+        auto operator co_await() && noexcept { return Awaiter{ _h }; }
+
+    private:
+        struct Awaiter {
+            Handle h;
+
+            bool await_ready() const noexcept { return !h || h.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                h.promise().continuation = awaiting;
+                return h;
+            }
+            T await_resume() {
+                if (!h) throw std::logic_error("MB::Task: awaiting an empty task");
+                auto& p = h.promise();
+                if (p.error) std::rethrow_exception(p.error);
+                if constexpr (!std::is_void_v<T>)
+                    return std::move(*p.value);
+            }
+        };
+
+        void reset() noexcept {
+            if (_h) {
+                _h.destroy();
+                _h = {};
+            }
+        }
+
+        Handle _h;
+    };
+
+    namespace CoroDetail {
+        template <class T>
+        Task<T> Promise<T>::get_return_object() noexcept {
+            return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+        }
+        inline Task<void> Promise<void>::get_return_object() noexcept {
+            return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+        }
+    }
+
+    // Fire and forget: starts on the calling thread, frees itself on completion.
+    template <class T>
+    void Spawn(Task<T> task) {
+        std::move(task).Detach();
+    }
+
+    // ---------- Game-thread awaitables ----------
+
+    // Installed by the host. post() must resume h from the next game-thread
+    // pump; postAfter() from a pump at least `ms` milliseconds from now.
+    struct GameThreadHooks {
+        void (*post)(std::coroutine_handle<> h) = nullptr;
+        void (*postAfter)(std::coroutine_handle<> h, std::uint32_t ms) = nullptr;
+    };
+
+    void SetGameThreadHooks(const GameThreadHooks& hooks) noexcept;
+
+    struct NextTickAwaiter {
+        bool unbound{ false };
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h);
+        void await_resume() const;
+    };
+
+    struct DelayAwaiter {
+        std::uint32_t ms{ 0 };
+        bool          unbound{ false };
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h);
+        void await_resume() const;
+    };
+
+    inline NextTickAwaiter NextTick() noexcept { return {}; }
+    inline DelayAwaiter    Delay(std::uint32_t ms) noexcept { return { ms }; }
+
+    struct CoroStats {
+        std::uint64_t heapFrames{ 0 };   // frame larger than the biggest size class
+        std::uint64_t slabBytes{ 0 };    // memory owned by the frame pool
+    };
+
+    CoroStats GetCoroStats() noexcept;
+
+} // namespace MB
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace MB::Deflate {
+
+    // -----------------------------------------------------------------------------
+    // Deflate (RFC 1951) in gzip framing (RFC 1952); no external library.
+    //
+    //  - GzipCompress(): LZ77 over the 32 KiB window (hash chains, one step of
+    //    lazy matching) coded with the fixed Huffman tables. No dynamic tables:
+    //    on log text the matches do most of the work. The output is a plain
+    //    .gz file, so gzip/zcat read it too.
+    //  - Gunzip(): full inflate (stored, fixed and dynamic blocks) of every
+    //    member in the buffer, checking CRC-32 and length. Reads anything gzip
+    //    writes, not just GzipCompress() output.
+    // -----------------------------------------------------------------------------
+
+    // Higher levels search longer hash chains.
+    enum class Level { Fast, Default, Best };
+
+    std::uint32_t Crc32(const void* data, std::size_t n, std::uint32_t crc = 0) noexcept;
+
+    bool IsGzip(const void* data, std::size_t n) noexcept;
+
+    // Appends one gzip member holding data to out.
+    void GzipCompress(const void* data, std::size_t n, std::string& out, Level level = Level::Default);
+
+    // Appends the decompressed bytes to out. On failure out holds what was
+    // decoded before the error and err (if given) says why.
+    bool Gunzip(const void* data, std::size_t n, std::string& out, std::string* err = nullptr);
+
+} // namespace MB::Deflate
@@ -3,10 +3,13 @@
 #include <unordered_map>
 #include <mutex>
 #include <atomic>
+#include <exception>
 #include <functional>
 #include <memory>   // <-- needed for std::shared_ptr
 #include <utility>
 
+#include "MBLog.hpp"
+
 namespace MB {
 
     struct FeatureState {
@@ -43,8 +46,13 @@ namespace MB {
             try {
                 std::invoke(std::forward<Fn>(fn));
             }
+            catch (const std::exception& e) {
+                ok = false;
+                MB_LOGW_RL(Core, "feature %s failed in %s: %s", name.c_str(), context ? context : "?", e.what());
+            }
             catch (...) {
                 ok = false;
+                MB_LOGW_RL(Core, "feature %s failed in %s: %s", name.c_str(), context ? context : "?", "unknown exception");
             }
 
             // Update failure counters / auto-disable under lock
@@ -52,10 +60,9 @@ namespace MB {
                 std::lock_guard<std::mutex> _l(_mtx);
                 auto& st = _getOrCreate_nolock(name);
                 int f = st.failures.fetch_add(1, std::memory_order_relaxed) + 1;
-                if (f >= st.failThreshold) {
-                    st.enabled.store(false, std::memory_order_relaxed);
+                if (f >= st.failThreshold && st.enabled.exchange(false, std::memory_order_relaxed)) {
+                    MB_LOGE(Core, "feature %s disabled after %d failures", name.c_str(), f);
                 }
-                (void)context; // (hook for logging if you add it later)
             }
         }
 
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace MB {
+
+    // -----------------------------------------------------------------------------
+    // FileWatcher: calls back once a single file has changed and then stayed
+    // quiet for a short coalescing window.
+    //
+    //  - Native backend: Windows ReadDirectoryChangesW, Linux inotify, on the
+    //    file's directory (so saves that replace the file by rename are seen)
+    //    filtered to the file's name. The thread sleeps in the kernel until
+    //    something happens; a stop request wakes it through its own event.
+    //  - Poll backend: stats the file (write time, size) every pollInterval.
+    //    Used when asked for, on other platforms, or when the native watch
+    //    cannot be set up (missing directory, inotify limits, network shares
+    //    without change notification).
+    //  - Editors often write a file in several steps (truncate, write, rename,
+    //    touch); every event restarts the window, and the callback runs on
+    //    the watcher thread once no event has arrived for `coalesce`.
+    // -----------------------------------------------------------------------------
+    class FileWatcher {
+    public:
+        enum class Backend { Auto, Native, Poll };
+
+        struct Options {
+            Backend                   backend{ Backend::Auto };
+            std::chrono::milliseconds coalesce{ 100 };
+            std::chrono::milliseconds pollInterval{ 250 };   // Poll backend
+        };
+
+        struct Stats {
+            std::uint64_t events{ 0 };      // native events / poll ticks that saw a change
+            std::uint64_t callbacks{ 0 };
+        };
+
+        using Callback = std::function<void()>;
+
+        FileWatcher() = default;
+        ~FileWatcher();   // Stop()
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        // Starts the watcher thread (stopping a previous one). False only if
+        // no backend could start; Auto falls back to Poll.
+        bool Start(const std::filesystem::path& file, Callback onChange, const Options& opt);
+        bool Start(const std::filesystem::path& file, Callback onChange) {
+            return Start(file, std::move(onChange), Options{});
+        }
+        // Waits for a running callback to finish; do not call from inside one.
+        void Stop();
+
+        void SetCoalesce(std::chrono::milliseconds window) noexcept {
+            _coalesceMs.store(window.count(), std::memory_order_relaxed);
+        }
+
+        Backend ActiveBackend() const noexcept { return _active.load(std::memory_order_relaxed); }
+        Stats   GetStats() const noexcept;
+
+    private:
+        bool startNative();
+        void nativeLoop();
+        void pollLoop();
+        void noteEvent(std::chrono::steady_clock::time_point& due, bool& pending);
+        void fire();
+        std::chrono::milliseconds coalesce() const noexcept {
+            return std::chrono::milliseconds(_coalesceMs.load(std::memory_order_relaxed));
+        }
+
+        std::filesystem::path     _file{};
+        Callback                  _onChange{};
+        std::chrono::milliseconds _pollInterval{ 250 };
+        std::atomic<std::int64_t> _coalesceMs{ 100 };
+        std::atomic<Backend>      _active{ Backend::Auto };
+        std::atomic<bool>         _stop{ false };
+        std::thread               _thread;
+
+        // Poll backend sleeps here; Stop() wakes it.
+        std::mutex                _pollMx;
+        std::condition_variable   _pollCv;
+
+#ifdef _WIN32
+        void*                     _dir{ nullptr };         // HANDLE, FILE_FLAG_OVERLAPPED
+        void*                     _stopEvent{ nullptr };   // HANDLE
+#else
+        int                       _notifyFd{ -1 };         // inotify
+        int                       _stopFd{ -1 };           // eventfd
+#endif
+
+        std::atomic<std::uint64_t> _events{ 0 };
+        std::atomic<std::uint64_t> _callbacks{ 0 };
+    };
+
+} // namespace MB
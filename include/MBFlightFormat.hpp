@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace MB::FlightWire {
+
+    // -----------------------------------------------------------------------------
+    // Flight recorder file (.flight), shared by FlightRecorder and mb_flightdump.
+    //
+    // The whole file is mapped; native byte order, fixed offsets:
+    //   [0, kHeaderBytes)        Header
+    //   [kHeaderBytes, +siteBytes) site table: LogWire 'S' entries back to back
+    //                            (u8 'S' u32 site u8 level u8 module u32 line
+    //                            u16 n file[n] u16 n fmt[n]), zero after the last
+    //   then slotCount slots of slotBytes, each a SlotHeader plus payload.
+    //
+    // Record number n (0-based, from Header::next) lives in slot n % slotCount;
+    // its seq is 0 while it is being written and n + 1 once complete, so after
+    // a crash the complete slots sorted by seq are the last slotCount records
+    // in order, and a slot the dying thread was filling is skipped. A record
+    // whose slot is still held by a writer a full ring behind is not written
+    // (Header::skipped), so numbers can have gaps.
+    //
+    // Payloads by kind:
+    //   kText    the line (level, module in the slot header)
+    //   kRecord  LogWire packed arguments of site `site` (possibly cut short)
+    //   kOp      i64 usec, then the op name; flags & kOpFailed if it threw
+    //   kEvent   f64 a, f64 b, f64 c, then the event name
+    //   kCrash   description of the fault (signal / exception code, address)
+    // -----------------------------------------------------------------------------
+    inline constexpr char          kMagic[8] = { 'M', 'B', 'F', 'L', 'I', 'G', 'H', 'T' };
+    inline constexpr std::uint32_t kVersion = 1;
+    inline constexpr std::size_t   kHeaderBytes = 4096;
+
+    enum State : std::uint32_t { kLive = 1, kClean = 2, kCrashed = 3 };
+    enum Kind : std::uint8_t { kText = 'T', kRecord = 'R', kOp = 'O', kEvent = 'E', kCrash = 'C' };
+    enum Flags : std::uint8_t { kOpFailed = 1 };
+
+    struct Header {
+        char          magic[8];
+        std::uint32_t version;
+        std::uint32_t slotBytes;
+        std::uint32_t slotCount;
+        std::uint32_t siteBytes;
+        std::uint32_t state;         // State
+        std::uint32_t pid;
+        std::int64_t  startWallNs;   // system_clock, ns since epoch
+        std::uint64_t next;          // records claimed so far (atomic)
+        std::uint32_t siteUsed;      // bytes of the site table claimed (atomic)
+        std::uint32_t skipped;       // records dropped: slot still being written (atomic)
+    };
+
+    struct SlotHeader {
+        std::uint64_t seq;           // record number + 1; 0 while written (atomic)
+        std::int64_t  wallNs;
+        std::uint32_t site;          // kRecord
+        std::uint16_t len;           // payload bytes
+        std::uint8_t  kind;          // Kind
+        std::uint8_t  level;
+        std::uint8_t  module;
+        std::uint8_t  flags;
+        std::uint8_t  reserved[6];
+    };
+
+    static_assert(sizeof(Header) == 56 && sizeof(Header) <= kHeaderBytes, "flight header layout");
+    static_assert(sizeof(SlotHeader) == 32, "flight slot header layout");
+
+} // namespace MB::FlightWire
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "MBFlightFormat.hpp"
+
+namespace MB {
+
+    enum class LogLevel;
+    enum class LogModule : std::uint8_t;
+    struct LogSite;
+
+    // -----------------------------------------------------------------------------
+    // FlightRecorder: the last few thousand log lines, op dispatches and
+    // telemetry events, kept in a memory-mapped file so they outlive a crash.
+    //
+    //  - The ring is a fixed table of slots in a shared file mapping
+    //    (FlightWire). Writing a record is one fetch_add on the mapped header,
+    //    a copy into the claimed slot and a release store of its sequence
+    //    number: no lock, no syscall, no allocation. Records longer than a
+    //    slot are cut short; a record whose slot a writer a whole ring behind
+    //    is still filling is dropped rather than mixed with it.
+    //  - Log lines arrive through the logger at their own level
+    //    (Logger::SetFlight()), so Debug lines can be kept here while the log
+    //    file stays at Info. MB_LOG*() records carry the site id and packed
+    //    arguments, as in binary logs; the site table lives in the mapping too.
+    //  - The pages belong to the file, not the process: whatever was written
+    //    is on disk after the process dies, however it dies. Open() marks the
+    //    file live and Close() marks it clean; a file found live (or crashed)
+    //    on the next Open() is moved aside to <name>.crash.flight first.
+    //  - While open, fatal signals (Windows: unhandled exceptions) add a
+    //    kCrash record naming the fault before the previous handler runs.
+    //  - The mapping is kept until the process exits (the destructor only
+    //    closes), so a thread that races Close() writes into a valid (ignored)
+    //    page rather than a freed one.
+    //  - mb_flightdump prints a recovered file.
+    // -----------------------------------------------------------------------------
+    class FlightRecorder {
+    public:
+        static constexpr std::size_t kSlotBytes = 256;
+        static constexpr std::size_t kSlotPayload = kSlotBytes - sizeof(FlightWire::SlotHeader);
+        static constexpr std::size_t kDefaultSlots = 4096;        // 1 MiB
+        static constexpr std::size_t kSiteBytes = 256 * 1024;
+
+        struct Stats {
+            bool          open{ false };
+            std::uint64_t records{ 0 };   // since the file was created
+            std::uint64_t skipped{ 0 };   // slot still held by a lapped writer
+            std::size_t   slots{ 0 };
+            std::size_t   siteBytes{ 0 }; // site table in use
+        };
+
+        FlightRecorder() = default;
+        ~FlightRecorder();
+
+        FlightRecorder(const FlightRecorder&) = delete;
+        FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+        // Creates (replaces) the file and maps it. The first successful Open()
+        // fixes the file for the life of the process; later calls re-open
+        // that mapping, whatever path they name.
+        bool Open(const std::filesystem::path& file, std::size_t slots = kDefaultSlots);
+        void Close();   // marks the file clean and stops recording
+
+        bool IsOpen() const noexcept { return _open.load(std::memory_order_relaxed); }
+
+        // The previous session's file, if Open() found it was not closed cleanly.
+        std::filesystem::path Recovered() const;
+
+        // Writers; no-ops while closed.
+        void Text(LogLevel lvl, LogModule mod, const char* text, std::size_t len) noexcept;
+        void Record(const LogSite& site, std::uint32_t id, const unsigned char* args, std::size_t len) noexcept;
+        void Op(std::string_view name, std::int64_t usec, bool failed) noexcept;
+        void Event(std::string_view name, double a, double b, double c) noexcept;
+        void Crash(const char* what) noexcept;
+
+        // Adds a log call site to the mapped site table (the logger does this
+        // once per site); false once the table is full.
+        bool DefineSite(std::uint32_t id, const LogSite& site) noexcept;
+
+        Stats       GetStats() const;
+        std::string StatsJSON() const;
+
+    private:
+        FlightWire::SlotHeader* claim(FlightWire::Kind kind, std::uint64_t& seq) noexcept;
+        void publish(FlightWire::SlotHeader* slot, std::uint64_t seq, std::size_t len) noexcept;
+        bool map(const std::filesystem::path& file, std::size_t bytes);
+        void installCrashHandlers();
+        void removeCrashHandlers();
+
+        std::atomic<bool>     _open{ false };
+        unsigned char*        _base{ nullptr };
+        FlightWire::Header*   _hdr{ nullptr };
+        unsigned char*        _sites{ nullptr };
+        unsigned char*        _slots{ nullptr };
+        std::size_t           _slotCount{ 0 };
+        std::size_t           _bytes{ 0 };
+
+        mutable std::mutex    _mx;            // Open/Close
+        std::filesystem::path _path{};        // guarded by _mx
+        std::filesystem::path _recovered{};   // guarded by _mx
+        bool                  _handlers{ false };
+#ifdef _WIN32
+        void*                 _file{ nullptr };      // HANDLE
+        void*                 _mapping{ nullptr };   // HANDLE
+#else
+        int                   _fd{ -1 };
+#endif
+    };
+
+    // Global accessor
+    FlightRecorder& Flight();
+
+} // namespace MB
@@ -28,10 +28,19 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdarg>
+#include <cstdint>
+#include <cstdio>
 #include <filesystem>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "MBLogFormat.hpp"
 
 namespace MB {
 
@@ -43,37 +52,420 @@ namespace MB {
         Error = 4
     };
 
+    enum class LogFormat {
+        Text,     // <base>.log, formatted by the writer thread
+        Binary    // <base>.mbl, deferred records; mb_logdecode turns them into text
+    };
+
+    // Subsystems with their own level (config "logging.modules"). Names are
+    // LogWire::ModuleName(); Core is everything not tagged otherwise.
+    enum class LogModule : std::uint8_t {
+        Core = 0,
+        IPC = 1,
+        Upscaler = 2,
+        Lights = 3,
+        Loader = 4
+    };
+
+    inline constexpr std::size_t kLogModuleCount = LogWire::kModuleCount;
+
+    // Config names: lower case ("ipc", "debug").
+    inline const char* LogModuleName(LogModule m) { return LogWire::ModuleName(static_cast<std::uint8_t>(m)); }
+    inline const char* LogLevelName(LogLevel l) {
+        static const char* const kNames[] = { "trace", "debug", "info", "warn", "error" };
+        const int i = static_cast<int>(l);
+        return i >= 0 && i < 5 ? kNames[i] : "?";
+    }
+
+    // False if the name is unknown.
+    inline bool LogModuleFromName(std::string_view s, LogModule& out) {
+        for (std::uint8_t i = 0; i < kLogModuleCount; ++i)
+            if (s == LogWire::ModuleName(i)) { out = static_cast<LogModule>(i); return true; }
+        return false;
+    }
+    inline bool LogLevelFromName(std::string_view s, LogLevel& out) {
+        for (int i = 0; i < 5; ++i)
+            if (s == LogLevelName(static_cast<LogLevel>(i))) { out = static_cast<LogLevel>(i); return true; }
+        return false;
+    }
+
+    // One per MB_LOG/MB_LOGF call site (a function-local static, constant-initialized).
+    struct LogSite {
+        constexpr LogSite(const char* f, const char* src, int ln, LogLevel lvl, LogModule mod = LogModule::Core) noexcept
+            : fmt(f), file(src), line(ln), level(lvl), module(mod) {}
+
+        const char*                fmt;
+        const char*                file;
+        int                        line;
+        LogLevel                   level;
+        LogModule                  module;
+        std::atomic<std::uint32_t> id{ 0 };   // assigned on first use
+    };
+
+    class LogLimit;
+
+    // -----------------------------------------------------------------------------
+    // Logger: callers never touch the file.
+    //
+    //  - Log() formats the message on the caller's stack, stamps it with a raw
+    //    clock value and copies it into a lock-free MPSC ring of fixed slots (a
+    //    line takes as many consecutive slots as it needs). No lock, no
+    //    allocation, no syscall on the calling thread.
+    //  - One writer thread owns a persistent file handle. It drains the ring in
+    //    batches, formats timestamps (date part cached per second), issues one
+    //    write per batch and keeps the file size itself, so rotation needs no
+    //    per-line stat. It wakes every kFlushInterval, or early for Warn/Error
+    //    lines and when the ring is half full.
+    //  - A full ring drops the line rather than stall the caller (Error lines
+    //    instead drain the ring on the calling thread); the writer reports how
+    //    many were dropped in the log itself.
+    //  - Lines logged before Init() wait in the ring. Without a writer thread
+    //    (after Shutdown()) the caller writes synchronously under a lock.
+    //  - MB_LOGF() skips formatting on the caller altogether: the record is a
+    //    call-site id, the timestamp and the raw arguments (LogWire). In Text
+    //    format the writer thread formats it; in Binary format the records go
+    //    to <base>.mbl as they are and mb_logdecode formats them offline.
+    //  - Levels are per module. SetLevel() sets the global level, which every
+    //    module follows unless SetModuleLevel() overrides it. The effective
+    //    level of each module is cached in its own atomic, so Enabled() is one
+    //    relaxed load. MB_LOG*() check it before evaluating any argument, and
+    //    drop call sites below MB_LOG_MIN_LEVEL at compile time.
+    //  - MB_LOG*_RL() sites are rate limited (LogLimit). What they suppress is
+    //    summed per site and written as "last message repeated N times" at
+    //    most once per kRepeatInterval, and on Shutdown().
+    //  - Rotation renames the full file once, to <base>.<local time>.<ext>, and
+    //    reopens. A separate maintenance thread gzips rotated segments
+    //    (MBDeflate) and prunes them by count, total size and age (Retention),
+    //    so neither the writer nor a draining caller waits on either. Init()
+    //    also sweeps segments a previous session left uncompressed.
+    //  - SetFlight() also copies lines, from the caller, into the crash flight
+    //    recorder (Flight()) at a level of its own; Enabled() lets a line
+    //    through when either the file or the recorder wants it.
+    // -----------------------------------------------------------------------------
     class Logger {
     public:
+        struct Stats {
+            std::uint64_t lines{ 0 };       // written to the file
+            std::uint64_t dropped{ 0 };     // ring full
+            std::uint64_t batches{ 0 };     // write calls
+            std::uint64_t bytes{ 0 };
+            std::uint64_t rotations{ 0 };
+            std::uint64_t suppressed{ 0 };  // rate-limited call sites
+            std::uint64_t compressed{ 0 };  // rotated segments gzipped
+            std::uint64_t pruned{ 0 };      // rotated segments deleted by Retention
+        };
+
+        // Caps on rotated segments (the live file is never touched); 0 = no cap.
+        struct Retention {
+            int                keep{ 5 };
+            std::uint64_t      maxTotalBytes{ 64ull * 1024 * 1024 };
+            std::chrono::hours maxAge{ 24 * 7 };
+            bool               compress{ true };
+        };
+
+        static constexpr std::size_t kSlotBytes = 128;
+        static constexpr std::size_t kRingSlots = 8192;     // 1 MiB
+        static constexpr std::size_t kMaxMessage = 2048;
+        static constexpr std::chrono::milliseconds kFlushInterval{ 50 };
+        static constexpr std::size_t kMaxSites = 4096;
+        static constexpr std::chrono::seconds kRepeatInterval{ 1 };
+        static constexpr int kFlightOff = 5;   // above Error
+
+        Logger();
+        ~Logger();
+
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        // Opens (appends to) <logDir>/<base>.log (.mbl) and starts the writer and
+        // maintenance threads. keep is Retention::keep.
         void Init(const std::filesystem::path& logDir,
             const std::wstring& base = L"MirrorBladeBridge",
             std::size_t maxBytes = 2 * 1024 * 1024,
-            int keep = 5);
+            int keep = 5,
+            LogFormat format = LogFormat::Text);
+
+        // Global level; modules without an override follow it.
+        void     SetLevel(LogLevel lvl);
+        LogLevel Level() const;
+
+        void     SetModuleLevel(LogModule mod, LogLevel lvl);
+        void     ClearModuleLevel(LogModule mod);              // follow the global level again
+        bool     HasModuleLevel(LogModule mod) const;
+        LogLevel ModuleLevel(LogModule mod) const noexcept {   // effective
+            return _modLvl[static_cast<std::size_t>(mod)].load(std::memory_order_relaxed);
+        }
+
+        // File or flight recorder
+        bool Enabled(LogModule mod, LogLevel lvl) const noexcept {
+            return static_cast<int>(lvl) >= static_cast<int>(_gateLvl[static_cast<std::size_t>(mod)].load(std::memory_order_relaxed));
+        }
+        bool Enabled(LogLevel lvl) const noexcept { return Enabled(LogModule::Core, lvl); }
+
+        // Lines at or above lvl (any module) also go to Flight() while on; the
+        // recorder itself must be open (SetFlightRecorder() does both).
+        void     SetFlight(bool on, LogLevel lvl = LogLevel::Debug);
+        bool     FlightOn() const;
+        LogLevel FlightLevel() const;
 
-        void SetLevel(LogLevel lvl);
+        void      SetRetention(const Retention& r);   // applied on the next rotation/sweep
+        Retention GetRetention() const;
+
+        // Switches files (closes one, opens the other) on the writer side.
+        void      SetFormat(LogFormat format);
+        LogFormat Format() const noexcept { return _format.load(std::memory_order_relaxed); }
 
         void Log(LogLevel lvl, const char* fmt, ...);
         void LogErr(const char* fmt, ...);
 
+        // Use MB_LOG*() / MB_LOGF(); the level check happens there.
+        template <class... Args>
+        void LogDeferred(LogSite& site, const Args&... args) {
+            if constexpr (sizeof...(Args) == 0) {
+                pushDeferred(site, nullptr, 0);
+            }
+            else {
+                unsigned char buf[kMaxMessage - sizeof(Record)];
+                pushDeferred(site, buf, LogWire::Pack(buf, sizeof(buf), args...));
+            }
+        }
+
+        // Block until every line logged so far is in the file.
+        void Flush();
+        // Drain, stop the writer thread; the file stays open for late lines.
+        // Finishes queued segment compression first.
+        void Shutdown();
+
+        Stats       GetStats() const;
+        std::string StatsJSON() const;
+
     private:
-        std::string timestamp();
-        void rotateIfNeededUnlocked();
-        void writeUnlocked(const std::string& line);
+        friend class LogLimit;
+
+        struct Slot {
+            std::atomic<std::uint64_t> seq;
+            unsigned char              data[kSlotBytes - sizeof(std::uint64_t)];
+        };
+
+        struct Record {
+            std::int64_t  wallNs;     // system_clock, ns since epoch
+            std::uint16_t len;
+            std::uint8_t  level;
+            std::uint8_t  slots;
+            std::uint32_t site;       // 0: formatted text; else packed arguments
+        };
 
-        std::mutex _mtx{};
+        void logV(LogLevel lvl, const char* fmt, va_list ap);
+        void pushDeferred(LogSite& site, const unsigned char* args, std::size_t len);
+        std::uint32_t registerSite(LogSite& site);
+        void defineFlightSitesUnlocked();
+        void updateGateUnlocked(std::size_t mod);
+        bool toFlight(LogLevel lvl) const noexcept {
+            return static_cast<int>(lvl) >= _flightGate.load(std::memory_order_relaxed);
+        }
+        void registerLimit(LogLimit& limit, const LogSite& site);
+        void reportRepeatsUnlocked();
+        bool push(LogLevel lvl, std::uint32_t site, const void* data, std::size_t len);
+        std::size_t drainUnlocked();
+        void consume(const Record& rec, const char* payload);
+        void appendLine(const Record& rec, const char* text, LogModule mod = LogModule::Core);
+        void appendBinary(const Record& rec, const char* payload);
+        void reserveUnlocked(std::size_t bytes);
+        void writeBatchUnlocked();
+        void openUnlocked();
+        void rotateUnlocked();
+        void startSegmentUnlocked();
+        std::filesystem::path segmentPathUnlocked() const;
+        void writerLoop();
+        void maintLoop();
+        void compressSegment(const std::filesystem::path& seg);
+        void pruneSegments(const std::filesystem::path& dir, const std::wstring& base, const Retention& r);
+
+        // Producer side
+        std::unique_ptr<Slot[]>     _ring;
+        alignas(64) std::atomic<std::uint64_t> _tail{ 0 };
+        alignas(64) std::atomic<std::uint64_t> _head{ 0 };   // advanced by the consumer
+        std::atomic<std::uint64_t>  _dropped{ 0 };
+        std::atomic<std::uint64_t>  _droppedTotal{ 0 };
+        std::atomic<LogLevel>       _modLvl[kLogModuleCount]{
+            LogLevel::Info, LogLevel::Info, LogLevel::Info, LogLevel::Info, LogLevel::Info };
+        std::atomic<LogLevel>       _gateLvl[kLogModuleCount]{   // min(_modLvl, flight level)
+            LogLevel::Info, LogLevel::Info, LogLevel::Info, LogLevel::Info, LogLevel::Info };
+        std::atomic<int>            _flightGate{ kFlightOff };   // flight level, or kFlightOff
+        std::atomic<bool>           _syncWrite{ false };   // no writer thread: callers drain
+        std::atomic<LogFormat>      _format{ LogFormat::Text };
+
+        // Level configuration behind _modLvl
+        mutable std::mutex          _lvlMx;
+        LogLevel                    _globalLvl{ LogLevel::Info };     // guarded by _lvlMx
+        LogLevel                    _override[kLogModuleCount]{};     // guarded by _lvlMx
+        bool                        _hasOverride[kLogModuleCount]{};  // guarded by _lvlMx
+        bool                        _flightOn{ false };               // guarded by _lvlMx
+        LogLevel                    _flightLvl{ LogLevel::Debug };    // guarded by _lvlMx
+
+        // Call sites, indexed by id - 1; append-only.
+        std::unique_ptr<std::atomic<const LogSite*>[]> _sites;
+        mutable std::mutex          _siteMx;
+        std::uint32_t               _siteCount{ 0 };       // guarded by _siteMx
+        std::uint32_t               _flightSites{ 0 };     // guarded by _siteMx; defined in Flight()
+        std::vector<LogLimit*>      _limits;               // guarded by _siteMx; sites that suppressed
+        std::atomic<bool>           _repeatsDue{ false };  // report repeats on the next drain
+
+        // Consumer side (whoever holds _mtx)
+        std::mutex            _mtx{};
+        std::FILE*            _file{ nullptr };
+        std::string           _batch;
+        std::string           _text;        // reassembled multi-slot line
+        std::string           _formatted;   // deferred record rendered as text
+        LogFormat             _fileFormat{ LogFormat::Text };
+        std::vector<bool>     _siteInFile;  // Binary: site definition already in this file
+        std::int64_t          _stampSec{ -1 };
+        std::int64_t          _repeatSweepNs{ 0 };   // steady clock, last repeat report
+        char                  _stamp[24]{};
         std::filesystem::path _dir{};
         std::filesystem::path _cur{};
-        std::wstring _base{ L"MirrorBladeBridge" };
-        std::size_t _maxBytes{ 2 * 1024 * 1024 };
-        int _keep{ 5 };
-        std::atomic<LogLevel> _lvl{ LogLevel::Info };
+        std::wstring          _base{ L"MirrorBladeBridge" };
+        std::size_t           _maxBytes{ 2 * 1024 * 1024 };
+        std::uint64_t         _curBytes{ 0 };
+
+        // Writer thread
+        std::thread             _writer;
+        std::mutex              _wakeMx;
+        std::condition_variable _wakeCv;
+        std::condition_variable _flushedCv;
+        std::atomic<bool>       _writerIdle{ false };
+        bool                    _stopping{ false };   // guarded by _wakeMx
+
+        // Maintenance thread: compression and retention of rotated segments
+        std::thread                        _maint;
+        mutable std::mutex                 _maintMx;
+        std::condition_variable            _maintCv;
+        std::vector<std::filesystem::path> _maintQ;               // guarded by _maintMx
+        bool                               _maintSweep{ false };  // guarded by _maintMx
+        bool                               _maintStop{ false };   // guarded by _maintMx
+        Retention                          _retention{};          // guarded by _maintMx
+        std::filesystem::path              _maintDir{};           // guarded by _maintMx
+        std::wstring                       _maintBase{};          // guarded by _maintMx
+
+        std::atomic<std::uint64_t> _lines{ 0 };
+        std::atomic<std::uint64_t> _batches{ 0 };
+        std::atomic<std::uint64_t> _bytes{ 0 };
+        std::atomic<std::uint64_t> _rotations{ 0 };
+        std::atomic<std::uint64_t> _compressed{ 0 };
+        std::atomic<std::uint64_t> _pruned{ 0 };
     };
 
     // Global accessor
     Logger& Log();
 
+    // -----------------------------------------------------------------------------
+    // LogLimit: token bucket for one MB_LOG*_RL() call site (a function-local
+    // static next to its LogSite).
+    //
+    //  - Up to `burst` lines pass at once, then `perSec` lines per second. The
+    //    bucket is kept as a GCRA theoretical arrival time, so admitting a line
+    //    is one CAS and a suppressed line one fetch_add.
+    //  - A site registers with the logger on its first suppressed line; the
+    //    writer thread then reports the count since its last report.
+    // -----------------------------------------------------------------------------
+    class LogLimit {
+    public:
+        constexpr LogLimit(double perSec, unsigned burst) noexcept
+            : _intervalNs(static_cast<std::int64_t>(1e9 / perSec))
+            , _toleranceNs(static_cast<std::int64_t>(1e9 / perSec) * static_cast<std::int64_t>(burst > 1 ? burst - 1 : 0)) {}
+
+        LogLimit(const LogLimit&) = delete;
+        LogLimit& operator=(const LogLimit&) = delete;
+
+        bool Admit(const LogSite& site) noexcept {
+            const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            std::int64_t tat = _tat.load(std::memory_order_relaxed);
+            do {
+                if (now < tat - _toleranceNs) {
+                    if (_suppressed.fetch_add(1, std::memory_order_relaxed) == 0) Log().registerLimit(*this, site);
+                    return false;
+                }
+            } while (!_tat.compare_exchange_weak(tat, (tat > now ? tat : now) + _intervalNs, std::memory_order_relaxed));
+            return true;
+        }
+
+        std::uint64_t Suppressed() const noexcept { return _suppressed.load(std::memory_order_relaxed); }
+
+    private:
+        friend class Logger;
+
+        const std::int64_t         _intervalNs;
+        const std::int64_t         _toleranceNs;
+        std::atomic<std::int64_t>  _tat{ 0 };
+        std::atomic<std::uint64_t> _suppressed{ 0 };
+        std::uint64_t              _reported{ 0 };     // guarded by Logger::_siteMx
+        const LogSite*             _site{ nullptr };   // guarded by Logger::_siteMx
+    };
+
     // Optional lifecycle helpers
     void InitLogs();
     void ShutdownLogs();
 
+    // Opens (or closes) the flight recorder at <logs>/MirrorBladeBridge.flight
+    // and routes lines at or above lvl into it. InitLogs() turns it on.
+    void SetFlightRecorder(bool on, LogLevel lvl = LogLevel::Debug);
+
 } // namespace MB
+
+// Call sites below this level (0 = Trace ... 4 = Error) compile to nothing;
+// e.g. -DMB_LOG_MIN_LEVEL=2 strips Trace and Debug from a release build.
+#ifndef MB_LOG_MIN_LEVEL
+#define MB_LOG_MIN_LEVEL 0
+#endif
+
+// MB_LOG(MB::LogModule::IPC, MB::LogLevel::Debug, "read %zu bytes", n):
+// deferred formatting; the caller only packs the arguments, and only when the
+// module's level lets the line through (arguments are not evaluated
+// otherwise). lvl and mod must be constant expressions; the format must be a
+// string literal (it is kept by pointer for the life of the process).
+#define MB_LOG(mod, lvl, fmt, ...) \
+    do { \
+        if constexpr (static_cast<int>(lvl) >= MB_LOG_MIN_LEVEL) { \
+            static ::MB::LogSite s_mbLogSite{ fmt, __FILE__, __LINE__, lvl, mod }; \
+            if (::MB::Log().Enabled(mod, lvl)) ::MB::Log().LogDeferred(s_mbLogSite, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+// MB_LOGD(Lights, "sweep %d", n): module by enumerator name.
+#define MB_LOGT(mod, fmt, ...) MB_LOG(::MB::LogModule::mod, ::MB::LogLevel::Trace, fmt, ##__VA_ARGS__)
+#define MB_LOGD(mod, fmt, ...) MB_LOG(::MB::LogModule::mod, ::MB::LogLevel::Debug, fmt, ##__VA_ARGS__)
+#define MB_LOGI(mod, fmt, ...) MB_LOG(::MB::LogModule::mod, ::MB::LogLevel::Info, fmt, ##__VA_ARGS__)
+#define MB_LOGW(mod, fmt, ...) MB_LOG(::MB::LogModule::mod, ::MB::LogLevel::Warn, fmt, ##__VA_ARGS__)
+#define MB_LOGE(mod, fmt, ...) MB_LOG(::MB::LogModule::mod, ::MB::LogLevel::Error, fmt, ##__VA_ARGS__)
+
+// MB_LOG_RL(MB::LogModule::IPC, MB::LogLevel::Warn, 2.0, 5, "...", ...):
+// MB_LOG through a per-site LogLimit (perSec lines per second, bursts of
+// `burst`). For paths that can fail in a tight loop.
+#define MB_LOG_RL(mod, lvl, perSec, burst, fmt, ...) \
+    do { \
+        if constexpr (static_cast<int>(lvl) >= MB_LOG_MIN_LEVEL) { \
+            static ::MB::LogSite s_mbLogSite{ fmt, __FILE__, __LINE__, lvl, mod }; \
+            static ::MB::LogLimit s_mbLogLimit{ perSec, burst }; \
+            if (::MB::Log().Enabled(mod, lvl) && s_mbLogLimit.Admit(s_mbLogSite)) \
+                ::MB::Log().LogDeferred(s_mbLogSite, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#ifndef MB_LOG_RL_PER_SEC
+#define MB_LOG_RL_PER_SEC 5.0
+#endif
+#ifndef MB_LOG_RL_BURST
+#define MB_LOG_RL_BURST 10
+#endif
+
+// MB_LOGW_RL(IPC, "pipe error %lu", err): default rate.
+#define MB_LOGT_RL(mod, fmt, ...) MB_LOG_RL(::MB::LogModule::mod, ::MB::LogLevel::Trace, MB_LOG_RL_PER_SEC, MB_LOG_RL_BURST, fmt, ##__VA_ARGS__)
+#define MB_LOGD_RL(mod, fmt, ...) MB_LOG_RL(::MB::LogModule::mod, ::MB::LogLevel::Debug, MB_LOG_RL_PER_SEC, MB_LOG_RL_BURST, fmt, ##__VA_ARGS__)
+#define MB_LOGI_RL(mod, fmt, ...) MB_LOG_RL(::MB::LogModule::mod, ::MB::LogLevel::Info, MB_LOG_RL_PER_SEC, MB_LOG_RL_BURST, fmt, ##__VA_ARGS__)
+#define MB_LOGW_RL(mod, fmt, ...) MB_LOG_RL(::MB::LogModule::mod, ::MB::LogLevel::Warn, MB_LOG_RL_PER_SEC, MB_LOG_RL_BURST, fmt, ##__VA_ARGS__)
+#define MB_LOGE_RL(mod, fmt, ...) MB_LOG_RL(::MB::LogModule::mod, ::MB::LogLevel::Error, MB_LOG_RL_PER_SEC, MB_LOG_RL_BURST, fmt, ##__VA_ARGS__)
+
+// MB_LOGF(MB::LogLevel::Info, "frame %u took %.2f ms", frame, ms): MB_LOG on
+// the core module.
+#define MB_LOGF(lvl, fmt, ...) MB_LOG(::MB::LogModule::Core, lvl, fmt, ##__VA_ARGS__)
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace MB::LogWire {
+
+    // -----------------------------------------------------------------------------
+    // Deferred-format log records, shared by the logger and mb_logdecode.
+    //
+    //  - A call site's format string is registered once and referred to by id;
+    //    a record carries only that id, a timestamp and the packed arguments.
+    //  - Arguments are packed as a 1-byte tag plus a fixed-width value
+    //    (integers widened to 64 bits, floats to double) or, for strings, a
+    //    16-bit length plus the bytes. Pointers are stored as addresses.
+    //  - Format() replays a printf format string against packed arguments; a
+    //    conversion whose argument is missing or of the wrong kind prints a
+    //    placeholder instead of reading garbage.
+    //
+    // Binary file (.mbl), native byte order:
+    //   header  "MBLOGBIN" u32 version u32 reserved
+    //   'S'     u32 site  u8 level  u8 module  u32 line  u16 n file[n]  u16 n fmt[n]
+    //   'R'     i64 wallNs  u32 site  u16 n args[n]
+    //   'T'     i64 wallNs  u8 level  u16 n text[n]
+    // Every file repeats the definitions of the sites it uses before their
+    // first record, so each rotated segment decodes on its own. Version 1
+    // files have no module byte (every site is "core").
+    // -----------------------------------------------------------------------------
+    inline constexpr char          kMagic[8] = { 'M', 'B', 'L', 'O', 'G', 'B', 'I', 'N' };
+    inline constexpr std::uint32_t kVersion = 2;
+    inline constexpr std::size_t   kHeaderBytes = 16;
+
+    enum Entry : std::uint8_t { kSite = 'S', kRecord = 'R', kText = 'T' };
+    enum Tag : std::uint8_t { kInt = 'i', kUInt = 'u', kDouble = 'f', kString = 's', kPtr = 'p' };
+
+    inline const char* LevelName(std::uint8_t level) {
+        static const char* const kNames[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR" };
+        return level < 5 ? kNames[level] : "?";
+    }
+
+    // Indexed by MB::LogModule.
+    inline constexpr std::uint8_t kModuleCount = 5;
+
+    inline const char* ModuleName(std::uint8_t module) {
+        static const char* const kNames[] = { "core", "ipc", "upscaler", "lights", "loader" };
+        return module < kModuleCount ? kNames[module] : "?";
+    }
+
+    // ---------- Packing (caller side) ----------
+
+    namespace Detail {
+        template <class V>
+        inline bool PutRaw(unsigned char*& p, unsigned char* end, std::uint8_t tag, V v) {
+            if (static_cast<std::size_t>(end - p) < 1 + sizeof(V)) return false;
+            *p++ = tag;
+            std::memcpy(p, &v, sizeof(V));
+            p += sizeof(V);
+            return true;
+        }
+
+        inline bool PutString(unsigned char*& p, unsigned char* end, const char* s, std::size_t n) {
+            if (static_cast<std::size_t>(end - p) < 3) return false;
+            const std::size_t room = static_cast<std::size_t>(end - p) - 3;
+            std::uint16_t len = static_cast<std::uint16_t>(n < room ? n : room);
+            if (n > 0xFFFF && len == 0xFFFF) len = 0xFFFF;
+            *p++ = kString;
+            std::memcpy(p, &len, sizeof(len));
+            p += sizeof(len);
+            std::memcpy(p, s, len);
+            p += len;
+            return true;
+        }
+
+        template <class T>
+        inline bool Put(unsigned char*& p, unsigned char* end, const T& v) {
+            using D = std::decay_t<T>;
+            if constexpr (std::is_same_v<D, bool> || (std::is_integral_v<D> && std::is_signed_v<D>))
+                return PutRaw(p, end, kInt, static_cast<std::int64_t>(v));
+            else if constexpr (std::is_integral_v<D>)
+                return PutRaw(p, end, kUInt, static_cast<std::uint64_t>(v));
+            else if constexpr (std::is_enum_v<D>)
+                return Put(p, end, static_cast<std::underlying_type_t<D>>(v));
+            else if constexpr (std::is_floating_point_v<D>)
+                return PutRaw(p, end, kDouble, static_cast<double>(v));
+            else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+                const char* s = v;   // also string literals (T is an array)
+                return s ? PutString(p, end, s, std::strlen(s)) : PutString(p, end, "(null)", 6);
+            }
+            else if constexpr (std::is_same_v<D, std::string> || std::is_same_v<D, std::string_view>)
+                return PutString(p, end, v.data(), v.size());
+            else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>)
+                return PutRaw(p, end, kPtr, static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(v)));
+            else {
+                static_assert(sizeof(D) == 0, "MB_LOGF: argument type has no binary encoding");
+                return false;
+            }
+        }
+    }
+
+    // Packs args into [buf, buf+cap); returns the bytes used. Arguments that do
+    // not fit are left out (and later print as "<missing>").
+    template <class... Args>
+    inline std::size_t Pack(unsigned char* buf, std::size_t cap, const Args&... args) {
+        unsigned char* p = buf;
+        unsigned char* const end = buf + cap;
+        (void)end;   // unused when args is empty
+        (void)((Detail::Put(p, end, args)) && ...);
+        return static_cast<std::size_t>(p - buf);
+    }
+
+    // ---------- Formatting (writer thread / decoder) ----------
+
+    class ArgReader {
+    public:
+        ArgReader(const unsigned char* p, std::size_t n) : _p(p), _end(p + n) {}
+
+        bool Next(std::uint8_t& tag, std::int64_t& i, double& d, const char*& s, std::size_t& len) {
+            if (_p >= _end) return false;
+            tag = *_p++;
+            switch (tag) {
+            case kInt: case kUInt: case kPtr:
+                if (_end - _p < 8) return false;
+                std::memcpy(&i, _p, 8);
+                _p += 8;
+                d = tag == kUInt ? static_cast<double>(static_cast<std::uint64_t>(i)) : static_cast<double>(i);
+                return true;
+            case kDouble:
+                if (_end - _p < 8) return false;
+                std::memcpy(&d, _p, 8);
+                _p += 8;
+                i = static_cast<std::int64_t>(d);
+                return true;
+            case kString: {
+                if (_end - _p < 2) return false;
+                std::uint16_t n;
+                std::memcpy(&n, _p, 2);
+                _p += 2;
+                if (_end - _p < n) return false;
+                s = reinterpret_cast<const char*>(_p);
+                len = n;
+                _p += n;
+                return true;
+            }
+            default:
+                _p = _end;
+                return false;
+            }
+        }
+
+    private:
+        const unsigned char* _p;
+        const unsigned char* _end;
+    };
+
+    // Appends fmt with its conversions replaced by the packed arguments.
+    inline void Format(const char* fmt, const unsigned char* args, std::size_t n, std::string& out) {
+        ArgReader rd(args, n);
+        char spec[32];
+        char tmp[512];
+        std::string str;
+
+        for (const char* f = fmt; *f;) {
+            if (*f != '%') {
+                const char* lit = f;
+                while (*f && *f != '%') ++f;
+                out.append(lit, static_cast<std::size_t>(f - lit));
+                continue;
+            }
+            if (f[1] == '%') { out.push_back('%'); f += 2; continue; }
+
+            // %[flags][width][.precision][length]conv; '*' is not supported
+            // (the width/precision would have to be packed as an argument).
+            const char* start = f++;
+            std::size_t k = 0;
+            spec[k++] = '%';
+            while (*f && std::strchr("-+ #0", *f) && k < 20) spec[k++] = *f++;
+            while (*f >= '0' && *f <= '9' && k < 20) spec[k++] = *f++;
+            if (*f == '.' && k < 20) {
+                spec[k++] = *f++;
+                while (*f >= '0' && *f <= '9' && k < 20) spec[k++] = *f++;
+            }
+            while (*f && std::strchr("hljztLIq", *f)) {
+                // MSVC I64/I32 width suffixes
+                if (*f == 'I' && ((f[1] == '6' && f[2] == '4') || (f[1] == '3' && f[2] == '2'))) f += 2;
+                ++f;
+            }
+            const char conv = *f;
+            if (!conv) { out.append(start); break; }
+            ++f;
+
+            std::uint8_t tag = 0;
+            std::int64_t iv = 0;
+            double dv = 0.0;
+            const char* sv = nullptr;
+            std::size_t sl = 0;
+            if (conv == 'n') continue;
+            if (!rd.Next(tag, iv, dv, sv, sl)) { out.append("<missing>"); continue; }
+
+            int w = 0;
+            if (std::strchr("diouxXc", conv)) {
+                if (tag == kString) { out.append("<str>"); continue; }
+                if (conv == 'c') {
+                    spec[k++] = 'c'; spec[k] = '\0';
+                    w = std::snprintf(tmp, sizeof(tmp), spec, static_cast<int>(iv));
+                    if (w > 0) out.append(tmp, static_cast<std::size_t>(w) < sizeof(tmp) ? static_cast<std::size_t>(w) : sizeof(tmp) - 1);
+                    continue;
+                }
+                spec[k++] = 'l'; spec[k++] = 'l'; spec[k++] = conv; spec[k] = '\0';
+                if (conv == 'd' || conv == 'i')
+                    w = std::snprintf(tmp, sizeof(tmp), spec, static_cast<long long>(iv));
+                else
+                    w = std::snprintf(tmp, sizeof(tmp), spec, static_cast<unsigned long long>(iv));
+            }
+            else if (std::strchr("fFeEgGaA", conv)) {
+                if (tag == kString) { out.append("<str>"); continue; }
+                spec[k++] = conv; spec[k] = '\0';
+                w = std::snprintf(tmp, sizeof(tmp), spec, dv);
+            }
+            else if (conv == 's' || conv == 'S') {
+                if (tag != kString) { out.append("<num>"); continue; }
+                spec[k++] = 's'; spec[k] = '\0';
+                str.assign(sv, sl);
+                if (k == 2) { out.append(str); continue; }   // plain %s
+                w = std::snprintf(tmp, sizeof(tmp), spec, str.c_str());
+            }
+            else if (conv == 'p') {
+                w = std::snprintf(tmp, sizeof(tmp), "0x%llx", static_cast<unsigned long long>(iv));
+            }
+            else {
+                out.append(start, static_cast<std::size_t>(f - start));
+                continue;
+            }
+            if (w > 0) out.append(tmp, static_cast<std::size_t>(w) < sizeof(tmp) ? static_cast<std::size_t>(w) : sizeof(tmp) - 1);
+        }
+    }
+
+} // namespace MB::LogWire
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace MB {
+
+    // -----------------------------------------------------------------------------
+    // NodePool: chunked free-list allocator for queue nodes (GameTaskQueue, M4qXE).
+    //
+    //  - Node needs `Node* freeNext` and `bool pooled`; both belong to whoever
+    //    holds the node. Nodes are default-constructed once per chunk and reused
+    //    as-is; the owner resets their payload before giving them back.
+    //  - Chunks of ChunkSize nodes, at most MaxChunks. Past the cap Acquire()
+    //    heap-allocates a node with pooled = false (counted in Misses()); the
+    //    owner deletes those instead of releasing them.
+    //  - Free chains are pushed lock-free (Release()); batches of up to
+    //    CacheBatch are taken under a mutex into a per-thread cache, so a
+    //    steady producer touches shared state once per batch. With one taker at
+    //    a time a node cannot leave the list and come back mid-take: no ABA.
+    //  - A thread caches nodes of one pool per Node type. Its cache goes back
+    //    when the thread exits or acquires from another pool, checked against a
+    //    registry of live pools by id, so a new pool at the same address is not
+    //    mistaken for a dead one.
+    // -----------------------------------------------------------------------------
+    namespace NodePoolDetail {
+        using PoolKey = std::pair<const void*, std::uint64_t>;
+
+        // Leaked: thread_local destructors can run after statics.
+        struct LivePools {
+            std::mutex           mx;
+            std::vector<PoolKey> pools;
+            std::uint64_t        nextId{ 1 };   // guarded by mx
+        };
+        inline LivePools& Live() {
+            static LivePools* live = new LivePools();
+            return *live;
+        }
+    }
+
+    template <class Node, std::size_t ChunkSize = 256, std::size_t MaxChunks = 1024, std::size_t CacheBatch = 32>
+    class NodePool {
+        static_assert(CacheBatch > 0 && CacheBatch < ChunkSize);
+
+    public:
+        NodePool() {
+            NodePoolDetail::LivePools& live = NodePoolDetail::Live();
+            std::lock_guard<std::mutex> lk(live.mx);
+            _id = live.nextId++;
+            live.pools.emplace_back(this, _id);
+        }
+
+        ~NodePool() {
+            // After this no exiting thread hands nodes back to us.
+            NodePoolDetail::LivePools& live = NodePoolDetail::Live();
+            std::lock_guard<std::mutex> lk(live.mx);
+            live.pools.erase(std::remove(live.pools.begin(), live.pools.end(), NodePoolDetail::PoolKey{ this, _id }), live.pools.end());
+        }
+
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        // Put one chunk on the free list up front so the first burst does not allocate.
+        void Reserve() {
+            if (Node* chain = grow())
+                Release(chain, chain + (ChunkSize - 1));
+        }
+
+        // Any thread. Never fails short of the heap itself.
+        Node* Acquire() {
+            Cache& cache = localCache();
+            if (cache.owner != this || cache.ownerId != _id) {
+                // Switching pools: the old pool's nodes go back to it.
+                cache.release();
+                cache.owner = this;
+                cache.ownerId = _id;
+            }
+
+            Node* n = cache.head;
+            if (!n) {
+                n = takeBatch();
+                if (!n) {
+                    // Pool is at its cap; keep accepting work rather than dropping it.
+                    _misses.fetch_add(1, std::memory_order_relaxed);
+                    Node* h = new Node();
+                    h->pooled = false;
+                    return h;
+                }
+            }
+            cache.head = n->freeNext;
+            n->freeNext = nullptr;
+            return n;
+        }
+
+        // Any thread: give back a chain of pooled nodes linked first..last
+        // through freeNext.
+        void Release(Node* first, Node* last) noexcept {
+            Node* head = _free.load(std::memory_order_relaxed);
+            do {
+                last->freeNext = head;
+            } while (!_free.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        // Hand back the calling thread's cached batch now (e.g. a worker
+        // retiring while its thread lives on elsewhere in the process).
+        static void ReleaseThreadCache() noexcept { localCache().release(); }
+
+        std::size_t   Nodes() const noexcept { return _chunkCount.load(std::memory_order_relaxed) * ChunkSize; }
+        std::uint64_t Misses() const noexcept { return _misses.load(std::memory_order_relaxed); }
+
+    private:
+        // Per-thread stash of up to CacheBatch free nodes from one pool.
+        struct Cache {
+            NodePool*     owner{ nullptr };
+            std::uint64_t ownerId{ 0 };
+            Node*         head{ nullptr };
+
+            void release() noexcept {
+                if (head) {
+                    NodePoolDetail::LivePools& live = NodePoolDetail::Live();
+                    std::lock_guard<std::mutex> lk(live.mx);
+                    if (std::find(live.pools.begin(), live.pools.end(), NodePoolDetail::PoolKey{ owner, ownerId }) != live.pools.end()) {
+                        Node* last = head;
+                        while (last->freeNext) last = last->freeNext;
+                        owner->Release(head, last);
+                    }
+                }
+                owner = nullptr;
+                ownerId = 0;
+                head = nullptr;
+            }
+
+            ~Cache() { release(); }
+        };
+
+        static Cache& localCache() noexcept {
+            thread_local Cache cache;
+            return cache;
+        }
+
+        Node* grow() {
+            std::lock_guard<std::mutex> lk(_growMx);
+            if (_chunks.size() >= MaxChunks) return nullptr;
+
+            std::unique_ptr<Node[]> chunk(new (std::nothrow) Node[ChunkSize]);
+            if (!chunk) return nullptr;
+
+            for (std::size_t i = 0; i + 1 < ChunkSize; ++i)
+                chunk[i].freeNext = &chunk[i + 1];
+            Node* first = chunk.get();
+            _chunks.push_back(std::move(chunk));
+            _chunkCount.store(_chunks.size(), std::memory_order_relaxed);
+            return first;
+        }
+
+        Node* takeBatch() {
+            std::lock_guard<std::mutex> lk(_takeMx);
+
+            Node* head = _free.load(std::memory_order_acquire);
+            while (head) {
+                Node* last = head;
+                for (std::size_t i = 1; i < CacheBatch && last->freeNext; ++i)
+                    last = last->freeNext;
+                // Only pushes can move the head meanwhile; retry on top of them.
+                if (_free.compare_exchange_weak(head, last->freeNext, std::memory_order_acquire, std::memory_order_acquire)) {
+                    last->freeNext = nullptr;
+                    return head;
+                }
+            }
+
+            Node* chunk = grow();
+            if (!chunk) return nullptr;
+            // Keep one batch, the rest of the chunk goes to the shared list.
+            chunk[CacheBatch - 1].freeNext = nullptr;
+            Release(chunk + CacheBatch, chunk + (ChunkSize - 1));
+            return chunk;
+        }
+
+        alignas(64) std::atomic<Node*>       _free{ nullptr };
+        std::mutex                           _takeMx;
+        std::vector<std::unique_ptr<Node[]>> _chunks;        // guarded by _growMx
+        std::atomic<std::size_t>             _chunkCount{ 0 };
+        std::mutex                           _growMx;
+        std::atomic<std::uint64_t>           _misses{ 0 };
+        std::uint64_t                        _id{ 0 };       // tags thread-local caches
+    };
+
+} // namespace MB
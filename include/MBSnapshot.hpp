@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace MB {
+
+    // -----------------------------------------------------------------------------
+    // Snapshot<T>: one current value of T, published as an immutable object
+    // and replaced whole (read-copy-update).
+    //
+    //  - Load() hands out a reference to the current object. Everything read
+    //    through it comes from the same Publish(), whatever writers do
+    //    meanwhile; an object lives until its last reader lets go of it, which
+    //    is the grace period.
+    //  - Publish() swaps the pointer in one step. Update() is the
+    //    read-modify-write form (copy, edit, publish); writers are serialized
+    //    so two edits cannot lose each other.
+    //  - Every publish bumps Version(). A Reader keeps its own reference plus
+    //    the version it was taken at, and only goes back to the shared pointer
+    //    when the version moves: the steady-state read is one atomic load of a
+    //    counter only writers write, with no lock and no reference count
+    //    traffic, so hot readers on many threads do not contend at all.
+    //  - The pointer itself is guarded by a spin flag held only to copy or
+    //    swap it (a reference count increment). std::atomic<std::shared_ptr>
+    //    does the same, but libstdc++ 12 drops its lock bit with relaxed
+    //    order after a load, which lets that load race with the next swap.
+    // -----------------------------------------------------------------------------
+    template <class T>
+    class Snapshot {
+    public:
+        using Ptr = std::shared_ptr<const T>;
+
+        // Cached view for one thread (not thread-safe itself).
+        class Reader {
+        public:
+            explicit Reader(const Snapshot& s) : _snap(&s) {}
+
+            // The current value; valid until the next Get() on this Reader.
+            const T& Get() {
+                const std::uint64_t v = _snap->Version();
+                if (v != _seen) {
+                    _cur = _snap->Load();
+                    _seen = v;
+                }
+                return *_cur;
+            }
+            const Ptr& Current() { Get(); return _cur; }
+
+        private:
+            const Snapshot* _snap;
+            Ptr             _cur{};
+            std::uint64_t   _seen{ 0 };
+        };
+
+        Snapshot() : _cur(std::make_shared<const T>()) {}
+        explicit Snapshot(T initial) : _cur(std::make_shared<const T>(std::move(initial))) {}
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        Ptr Load() const noexcept {
+            lock();
+            Ptr p = _cur;
+            unlock();
+            return p;
+        }
+
+        void Publish(Ptr next) {
+            if (!next) return;
+            std::scoped_lock lk{ _writeMx };
+            publishLocked(std::move(next));
+        }
+        void Publish(T next) { Publish(std::make_shared<const T>(std::move(next))); }
+
+        // fn(T&) edits a copy of the current value; returns what was published.
+        template <class F>
+        Ptr Update(F&& fn) {
+            std::scoped_lock lk{ _writeMx };
+            auto next = std::make_shared<T>(*Load());
+            std::forward<F>(fn)(*next);
+            Ptr out = std::move(next);
+            publishLocked(out);
+            return out;
+        }
+
+        std::uint64_t Version() const noexcept { return _version.load(std::memory_order_acquire); }
+
+    private:
+        void lock() const noexcept {
+            while (_spin.test_and_set(std::memory_order_acquire)) std::this_thread::yield();
+        }
+        void unlock() const noexcept { _spin.clear(std::memory_order_release); }
+
+        // The pointer first, then the version: a Reader that sees the new
+        // version loads (at least) the new pointer. The old object is
+        // released after the flag is dropped.
+        void publishLocked(Ptr next) {
+            lock();
+            _cur.swap(next);
+            unlock();
+            _version.fetch_add(1, std::memory_order_release);
+        }
+
+        Ptr                        _cur;       // guarded by _spin
+        mutable std::atomic_flag   _spin = ATOMIC_FLAG_INIT;
+        std::atomic<std::uint64_t> _version{ 1 };
+        std::mutex                 _writeMx;   // writers only
+    };
+
+} // namespace MB
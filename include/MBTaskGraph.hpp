@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "M4qXE.hpp"
+
+namespace MB {
+
+    // -----------------------------------------------------------------------------
+    // TaskGraph: per-frame work as a dependency graph replayed on M4qXE.
+    //
+    //  - Built once: Add() a node with the nodes it depends on (which must
+    //    already exist, so the graph is acyclic and insertion order is a valid
+    //    topological order), then Compile(). After that the shape is frozen and
+    //    Run() replays it every frame without allocating.
+    //  - Run(pool) releases each node as soon as its last dependency finishes.
+    //    Pool nodes go to their lane; Caller nodes (engine-affine work) run on
+    //    the thread that called Run(). A thread that finishes a node keeps one
+    //    newly ready successor on the same lane instead of re-enqueuing it.
+    //    Run() returns once every node has run. If the pool refuses work
+    //    (stopped), those nodes run on the caller too.
+    //  - Every node is timed. The report carries wall time, summed work and the
+    //    critical path: the longest dependency chain by measured run time, with
+    //    the nodes on it, i.e. which chain of subsystems sets the frame's cost.
+    //  - A node that throws is counted and its dependents still run, so a frame
+    //    always completes.
+    //  - One Run() at a time; node names are plain identifiers (not escaped in
+    //    ReportJSON()).
+    // -----------------------------------------------------------------------------
+    class TaskGraph {
+    public:
+        using NodeId = std::uint32_t;
+        using Lane = M4qXE::Lane;
+        static constexpr NodeId kNoNode = 0xFFFFFFFFu;
+
+        struct FrameReport {
+            std::uint64_t       frame{ 0 };
+            std::uint64_t       wallUsec{ 0 };
+            std::uint64_t       workUsec{ 0 };           // sum of node run times
+            std::uint64_t       criticalPathUsec{ 0 };   // lower bound on wallUsec
+            std::vector<NodeId> criticalPath;            // first node to last
+            std::size_t         failed{ 0 };
+            NodeId              firstFailed{ kNoNode };
+
+            double Parallelism() const noexcept {
+                return wallUsec ? static_cast<double>(workUsec) / static_cast<double>(wallUsec) : 0.0;
+            }
+        };
+
+        TaskGraph() = default;
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+
+        // Throws std::invalid_argument on an unknown dependency and
+        // std::logic_error once the graph is compiled.
+        NodeId Add(std::string name, std::function<void()> fn,
+            const std::vector<NodeId>& deps = {}, Lane lane = Lane::High);
+        NodeId AddOnCaller(std::string name, std::function<void()> fn,
+            const std::vector<NodeId>& deps = {});
+
+        void Compile();
+        bool Compiled() const noexcept { return _compiled; }
+
+        // Blocking; compiles on first use. The report stays valid until the
+        // next Run().
+        const FrameReport& Run(M4qXE& pool);
+
+        const FrameReport& LastReport() const noexcept { return _report; }
+        std::string        ReportJSON() const;   // last frame, with per-node timings
+
+        std::size_t        Size() const noexcept { return _nodes.size(); }
+        const std::string& Name(NodeId id) const { return _nodes.at(id).name; }
+
+    private:
+        struct Node {
+            std::string           name;
+            std::function<void()> fn;
+            Lane                  lane{ Lane::High };
+            bool                  onCaller{ false };
+            std::vector<NodeId>   deps;
+            std::vector<NodeId>   succ;
+        };
+
+        NodeId addNode(std::string&& name, std::function<void()>&& fn,
+            const std::vector<NodeId>& deps, Lane lane, bool onCaller);
+        void   execute(NodeId id, bool onCaller);
+        NodeId release(NodeId id, bool onCaller);
+        void   dispatch(NodeId id);
+        void   pushCaller(NodeId id);
+        void   runNode(NodeId id) noexcept;
+        void   buildReport(std::int64_t t0, std::int64_t t1);
+
+        std::vector<Node>   _nodes;
+        std::vector<NodeId> _roots;
+        bool                _compiled{ false };
+
+        // Per-frame state, sized by Compile().
+        std::unique_ptr<std::atomic<std::uint32_t>[]> _pending;   // unfinished deps
+        std::vector<std::int64_t> _startNs;
+        std::vector<std::int64_t> _endNs;
+        std::vector<std::int64_t> _finishNs;    // critical-path scratch
+        std::vector<NodeId>       _pred;        // critical-path scratch
+        std::int64_t              _frameStartNs{ 0 };
+        M4qXE*                    _pool{ nullptr };
+
+        std::atomic<std::size_t> _remaining{ 0 };
+        std::atomic<std::size_t> _failed{ 0 };
+        std::atomic<NodeId>      _firstFailed{ kNoNode };
+
+        std::mutex              _mx;
+        std::condition_variable _cv;
+        std::vector<NodeId>     _callerReady;   // guarded by _mx
+        bool                    _done{ false }; // guarded by _mx
+
+        FrameReport _report;
+    };
+
+} // namespace MB
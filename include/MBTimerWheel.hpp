@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "InplaceFunction.hpp"
+
+namespace MB {
+
+    // -----------------------------------------------------------------------------
+    // TimerWheel: hashed hierarchical timing wheel (1 ms resolution).
+    //
+    //  - 4 levels x 256 slots cover ~49 days; Schedule() and Cancel() are O(1).
+    //  - Timer nodes live in a chunked slab with an index free list and the
+    //    callback is stored inline, so pending timers never allocate one by one
+    //    (Reserve() pre-sizes the slab; 100k timers need ~13 MB).
+    //  - Not thread-safe: owned and advanced by the tick (the game-thread pump).
+    //    Callbacks run inside Advance() and may schedule or cancel timers.
+    // -----------------------------------------------------------------------------
+    class TimerWheel {
+    public:
+        using Callback = InplaceFunction<void(), 64>;
+
+        // Opaque handle: slab index + generation. Zero is never a live timer.
+        using TimerId = std::uint64_t;
+        static constexpr TimerId kInvalidTimer = 0;
+
+        explicit TimerWheel(std::uint64_t nowMs = 0);
+        ~TimerWheel();
+
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        void Reserve(std::size_t timers);
+
+        // Fire cb once, delayMs after the wheel's current time (0 => next Advance).
+        template <class F>
+        TimerId Schedule(std::uint64_t delayMs, F&& cb) {
+            const std::uint32_t idx = allocNode();
+            Node& n = node(idx);
+            n.cb.Emplace(std::forward<F>(cb));
+            n.expiry = _now + (delayMs ? delayMs : 1);
+            insert(idx);
+            ++_pending;
+            return makeId(idx, n.generation);
+        }
+
+        // Returns false if the timer already fired or was cancelled.
+        bool Cancel(TimerId id) noexcept;
+        bool IsPending(TimerId id) const noexcept;
+
+        // Move time forward to nowMs, firing everything that expired; returns
+        // the number of callbacks run.
+        std::size_t Advance(std::uint64_t nowMs);
+
+        // Conservative next wake-up: never later than the earliest pending
+        // expiry (it may be earlier, at a cascade boundary). UINT64_MAX if idle.
+        std::uint64_t NextWakeMs() const noexcept;
+
+        std::uint64_t NowMs() const noexcept { return _now; }
+        std::size_t   Pending() const noexcept { return _pending; }
+        std::size_t   Capacity() const noexcept { return _chunks.size() * kChunkSize; }
+
+    private:
+        static constexpr std::uint32_t kNil = 0xFFFFFFFFu;
+        static constexpr int           kLevels = 4;
+        static constexpr int           kSlotBits = 8;
+        static constexpr std::uint32_t kSlots = 1u << kSlotBits;
+        static constexpr std::uint32_t kChunkShift = 12;              // 4096 timers per chunk
+        static constexpr std::uint32_t kChunkSize = 1u << kChunkShift;
+
+        struct Node {
+            Callback      cb;
+            std::uint64_t expiry{ 0 };
+            std::uint32_t prev{ kNil };
+            std::uint32_t next{ kNil };      // slot list, or free list when idle
+            std::uint32_t generation{ 1 };
+            std::uint16_t slot{ 0xFFFF };    // level * kSlots + slot; 0xFFFF => not linked
+        };
+
+        struct Level {
+            std::array<std::uint32_t, kSlots> head;
+            std::array<std::uint64_t, kSlots / 64> occupied{};   // bitmap of non-empty slots
+        };
+
+        static TimerId makeId(std::uint32_t idx, std::uint32_t gen) noexcept {
+            return (static_cast<TimerId>(gen) << 32) | (static_cast<TimerId>(idx) + 1);
+        }
+
+        Node&       node(std::uint32_t idx) noexcept { return _chunks[idx >> kChunkShift][idx & (kChunkSize - 1)]; }
+        const Node& node(std::uint32_t idx) const noexcept { return _chunks[idx >> kChunkShift][idx & (kChunkSize - 1)]; }
+        const Node* lookup(TimerId id) const noexcept;
+
+        std::uint32_t allocNode();
+        void          freeNode(std::uint32_t idx) noexcept;
+        void          growSlab();
+        void          insert(std::uint32_t idx) noexcept;
+        void          unlink(std::uint32_t idx) noexcept;
+        void          cascade(int level) noexcept;
+        std::size_t   fireSlot(std::uint32_t slot);
+
+        std::vector<std::unique_ptr<Node[]>> _chunks;
+        std::uint32_t                        _freeHead{ kNil };
+        std::array<Level, kLevels>           _levels;
+        std::uint64_t                        _now{ 0 };
+        std::size_t                          _pending{ 0 };
+    };
+
+} // namespace MB
@@ -12,6 +12,7 @@ namespace MB
     // Stop workers, close pipe, cleanup.
     void ShutdownBridge();
 
-    // Optional: run queued tasks once (useful if you later wire a real game-tick).
+    // Run queued tasks once on the calling thread. Call from the engine's frame
+    // callback; while frames keep arriving the fallback tick worker stays idle.
     void PumpOnce();
 }
@@ -61,8 +61,10 @@
    *
    * Behavior:
    * - File writes use an atomic temp-file + MoveFileExW replacement.
-   * - A background watcher polls file timestamp with simple debounce.
-   * - On reload, live systems are updated via Config::ApplyRuntime().
+   * - A background watcher reloads the file once it has been quiet for
+   *   watch.coalesceMs (change notifications, or polling as a fallback).
+   * - On reload, only the handlers registered for changed keys run
+   *   (MB::OnConfigChange); Config::ApplyRuntime() still pushes everything.
    */
 
    /**
@@ -182,6 +184,12 @@
         * MB::SaveConfig();
         * @endcode
         *
+        * Read config (all fields from the same load):
+        * @code{.cpp}
+        * auto cfg = MB::ConfigSnapshot();
+        * if (cfg->upscaler.load()) boost = cfg->traffic.load();
+        * @endcode
+        *
         * Dispatch op:
         * @code{.cpp}
         * nlohmann::json args = { {"enabled", true} };
@@ -1,6 +1,7 @@
 // src/AILLTUO.cpp
 #include "AILLTUO.hpp"
 #include "LoomisUnderfold.hpp"
+#include "M4qXE.hpp"
 
 #include <algorithm>
 #include <cmath>
@@ -169,9 +170,38 @@ namespace MB {
             return;
         }
 
-        for (size_t i = 0; i < n; ++i) {
+        evaluateOffsets(uf->Snapshot(), p, xs, out, 0, n);
+    }
+
+    void AILLTUO::EvaluateNPCOffsetsMany(const double* xs, double* out, size_t n, M4qXE& pool, size_t grain) const {
+        if (!xs || !out || n == 0) return;
+        const LoomisUnderfold* uf;
+        Params p;
+        {
+            std::lock_guard<std::mutex> lk(_mx);
+            uf = _underfold;
+            p = _params;
+        }
+        if (!p.enabled || !uf) {
+            if (out != xs) std::fill(out, out + n, 0.0);
+            return;
+        }
+
+        // The creases are copied and sorted once here; the chunks only read
+        // that snapshot, so they share no lock and elements need no
+        // coordination.
+        const UnderfoldSnapshot folds = uf->Snapshot();
+        pool.ParallelFor(0, n, grain, [&](size_t b, size_t e) {
+            evaluateOffsets(folds, p, xs, out, b, e);
+        });
+    }
+
+    void AILLTUO::evaluateOffsets(const UnderfoldSnapshot& uf, const Params& p,
+        const double* xs, double* out, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i) {
             double x = xs[i];
-            double y = uf->Evaluate(x);
+            double y = uf.Evaluate(x);
             double d = y - x;
             double td = clamp(d, -p.truncation, p.truncation);
             out[i] = crooked(td, p.crookedness);
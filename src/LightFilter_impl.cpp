@@ -1,5 +1,6 @@
 ﻿#include <atomic>
 #include "LightFilter.hpp" // adjust if your header is named differently
+#include "MBLog.hpp"
 
 namespace {
     struct LFState {
@@ -15,5 +16,11 @@ namespace MB {
     void LightFilter::SetAdverts(bool v) { state().adverts.store(v, std::memory_order_relaxed); }
     void LightFilter::SetPortals(bool v) { state().portals.store(v, std::memory_order_relaxed); }
     void LightFilter::SetForcePortals(bool v) { state().forcePortals.store(v, std::memory_order_relaxed); }
-    void LightFilter::SweepWorld(void* /*world*/) { /* stub; wire up later */ }
+    void LightFilter::SweepWorld(void* /*world*/) {
+        /* stub; wire up later */
+        MB_LOGD(Lights, "sweep adverts=%d portals=%d forcePortals=%d",
+            state().adverts.load(std::memory_order_relaxed),
+            state().portals.load(std::memory_order_relaxed),
+            state().forcePortals.load(std::memory_order_relaxed));
+    }
 } // namespace MB
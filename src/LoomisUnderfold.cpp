@@ -104,59 +104,66 @@ namespace MB {
 
     // ---------- Evaluation ----------
 
-    void LoomisUnderfold::snapshot(std::vector<Crease>& out, Curve& curve) const {
-        out.clear();
-        {
-            std::lock_guard<std::mutex> lk(_mx);
-            out = _creases;
-            curve = _curve;
-        }
-        std::sort(out.begin(), out.end(),
-            [](const Crease& a, const Crease& b) {
-                if (a.priority != b.priority) return a.priority < b.priority;
-                return a.name < b.name; // stable tie-breaker
+    UnderfoldSnapshot LoomisUnderfold::Snapshot() const {
+        std::vector<const Crease*> order;
+        UnderfoldSnapshot s;
+        std::lock_guard<std::mutex> lk(_mx);
+        s._curve = _curve;
+        order.reserve(_creases.size());
+        for (const auto& c : _creases)
+            if (c.enabled && c.radius > 0.0) order.push_back(&c);
+        std::sort(order.begin(), order.end(),
+            [](const Crease* a, const Crease* b) {
+                if (a->priority != b->priority) return a->priority < b->priority;
+                return a->name < b->name; // stable tie-breaker
             });
+        s._folds.reserve(order.size());
+        for (const Crease* c : order)
+            s._folds.push_back({ c->pos, c->radius, c->gain });
+        return s;
     }
 
     double LoomisUnderfold::Evaluate(double x) const {
-        std::vector<Crease> cs;
-        Curve curve;
-        snapshot(cs, curve);
+        return Snapshot().Evaluate(x);
+    }
 
+    double LoomisUnderfold::EvaluateDelta(double x) const {
+        return Evaluate(x) - x;
+    }
+
+    double LoomisUnderfold::EvaluateDerivative(double x) const {
+        return Snapshot().EvaluateDerivative(x);
+    }
+
+    void LoomisUnderfold::EvaluateMany(const double* xs, double* out, size_t n) const {
+        if (!xs || !out || n == 0) return;
+        Snapshot().EvaluateMany(xs, out, n);
+    }
+
+    double UnderfoldSnapshot::Evaluate(double x) const {
         double y = x;
-        for (const auto& c : cs) {
-            if (!c.enabled || c.radius <= 0.0) continue;
+        for (const Fold& c : _folds) {
             const double d = std::abs(y - c.pos);
             const double t = d / c.radius;
             if (t >= 1.0) continue;
-            const double K = kernel(t);
+            const double K = LoomisUnderfold::kernel(_curve, t);
             y = y + c.gain * K * (c.pos - y);
         }
         return y;
     }
 
-    double LoomisUnderfold::EvaluateDelta(double x) const {
-        return Evaluate(x) - x;
-    }
-
-    double LoomisUnderfold::EvaluateDerivative(double x) const {
-        std::vector<Crease> cs;
-        Curve curve;
-        snapshot(cs, curve);
-
+    double UnderfoldSnapshot::EvaluateDerivative(double x) const {
         double y = x;
         double dydx = 1.0;
 
-        for (const auto& c : cs) {
-            if (!c.enabled || c.radius <= 0.0) continue;
-
+        for (const Fold& c : _folds) {
             const double d = std::abs(y - c.pos);
             const double t = d / c.radius;
             if (t >= 1.0) continue;
 
             const double u = (c.pos - y);   // = -(y - c.pos)
-            const double K = kernel(t);
-            const double Kd = kernel_deriv_dt(t);
+            const double K = LoomisUnderfold::kernel(_curve, t);
+            const double Kd = LoomisUnderfold::kernel_deriv_dt(_curve, t);
 
             // dt/dy = sign(y - c.pos)/radius; at center use 0 to avoid NaN
             double sgn = 0.0;
@@ -173,14 +180,9 @@ namespace MB {
         return dydx;
     }
 
-    void LoomisUnderfold::EvaluateMany(const double* xs, double* out, size_t n) const {
-        if (!xs || !out || n == 0) return;
-        if (out == xs) {
-            for (size_t i = 0; i < n; ++i) out[i] = Evaluate(out[i]);
-        }
-        else {
-            for (size_t i = 0; i < n; ++i) out[i] = Evaluate(xs[i]);
-        }
+    void UnderfoldSnapshot::EvaluateMany(const double* xs, double* out, size_t n) const {
+        if (!xs || !out) return;
+        for (size_t i = 0; i < n; ++i) out[i] = Evaluate(xs[i]);
     }
 
     // ---------- Kernels ----------
@@ -204,11 +206,11 @@ namespace MB {
         return 6.0 * t5 - 15.0 * t4 + 10.0 * t3;
     }
 
-    double LoomisUnderfold::kernel(double t) const {
+    double LoomisUnderfold::kernel(Curve c, double t) {
         if (t <= 0.0) return 1.0;
         if (t >= 1.0) return 0.0;
 
-        switch (_curve) {
+        switch (c) {
         default:
         case Curve::Linear:
             return 1.0 - t;
@@ -230,10 +232,10 @@ namespace MB {
         }
     }
 
-    double LoomisUnderfold::kernel_deriv_dt(double t) const {
+    double LoomisUnderfold::kernel_deriv_dt(Curve c, double t) {
         if (t <= 0.0 || t >= 1.0) return 0.0;
 
-        switch (_curve) {
+        switch (c) {
         default:
         case Curve::Linear:
             return -1.0;
@@ -55,7 +55,18 @@
 #include <memory>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <sstream>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 // --- safe logging (scrubs cstdarg early via MBLog.hpp) ---
 #include "MBLog.hpp"
@@ -63,11 +74,35 @@
 // --- then your own headers that might pull Windows stuff ---
 #include "M4qXE.hpp"
 
+// --- Win32 AFTER STL; be lean; then scrub MIDL keywords again ---
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+
+#ifdef string
+#undef string
+#endif
+#ifdef small
+#undef small
+#endif
+#ifdef uuid
+#undef uuid
+#endif
+#ifdef hyper
+#undef hyper
+#endif
+#endif // _WIN32
+
 #if __has_include("MBLog.hpp")
 
-#define MBLOGI(fmt, ...) MB::Log().Log(MB::LogLevel::Info,  fmt, __VA_ARGS__)
-#define MBLOGW(fmt, ...) MB::Log().Log(MB::LogLevel::Warn,  fmt, __VA_ARGS__)
-#define MBLOGE(fmt, ...) MB::Log().Log(MB::LogLevel::Error, fmt, __VA_ARGS__)
+#define MBLOGI(fmt, ...) MB::Log().Log(MB::LogLevel::Info,  fmt, ##__VA_ARGS__)
+#define MBLOGW(fmt, ...) MB::Log().Log(MB::LogLevel::Warn,  fmt, ##__VA_ARGS__)
+#define MBLOGE(fmt, ...) MB::Log().Log(MB::LogLevel::Error, fmt, ##__VA_ARGS__)
 #else
 #define MBLOGI(...) (void)0
 #define MBLOGW(...) (void)0
@@ -80,17 +115,373 @@ namespace MB {
         return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
     }
 
+    namespace {
+        // Which pool (if any) the calling thread works for; worker-side
+        // Enqueue() goes to the worker's own deque instead of an inbox.
+        struct WorkerSelf {
+            const M4qXE* pool{ nullptr };
+            unsigned     index{ 0 };
+        };
+        thread_local WorkerSelf t_self;
+
+        // Token of the task running on this thread (runTask sets it).
+        thread_local const std::shared_ptr<const M4qXEDetail::CancelState>* t_cancel = nullptr;
+
+        // Coroutine this thread is handing to Enqueue() in Schedule(). A
+        // refusal destroys the task inside that call, and the awaiter then
+        // continues inline; only a drop after acceptance resumes it from here.
+        thread_local const void* t_handing = nullptr;
+
+        // The task behind ScheduleAwaiter: resumes the coroutine when run;
+        // destroyed unrun after acceptance, it resumes it with `dropped` set.
+        class ScheduledResume {
+        public:
+            ScheduledResume(std::coroutine_handle<> h, bool* dropped) noexcept : _h(h), _dropped(dropped) {}
+            ScheduledResume(ScheduledResume&& o) noexcept : _h(std::exchange(o._h, nullptr)), _dropped(o._dropped) {}
+            ScheduledResume& operator=(ScheduledResume&&) = delete;
+
+            ~ScheduledResume() {
+                if (!_h || _h.address() == t_handing) return;
+                *_dropped = true;
+                _h.resume();
+            }
+
+            void operator()() { std::exchange(_h, nullptr).resume(); }
+
+        private:
+            std::coroutine_handle<> _h;
+            bool*                   _dropped;
+        };
+
+        // External producers rotate over inboxes from a per-thread start point.
+        thread_local unsigned t_inboxCursor =
+            static_cast<unsigned>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+        // Idle escalation: pause-spin, then yield, then park.
+        constexpr int kSpinPause = 32;
+        constexpr int kSpinYield = 64;
+
+        // Task timing for the EWMA is sampled; two clock reads per task cost
+        // more than a small task itself.
+        constexpr std::uint32_t kTimingSampleMask = 15;   // 1 in 16
+
+        // Queue wait is sampled per producer thread and lane (enqueue stamp
+        // 1 in 16, like the run-time EWMA: a clock read per 4 tasks showed in
+        // submit throughput). One tick per lane: with a shared tick, a
+        // producer cycling lanes in step with the mask stamps only one lane.
+        constexpr std::uint32_t kWaitSampleMask = 15;
+        thread_local std::uint32_t t_waitSampleTick[M4qXE::kLaneCount]{};
+
+        // Elastic sizing: control window and the fewest samples worth a p95.
+        constexpr std::chrono::milliseconds kControlPeriod{ 10 };
+        constexpr std::uint64_t kMinWaitSamples = 8;
+
+        inline std::int64_t SteadyNs() noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        inline std::size_t HistBucket(std::uint64_t usec) noexcept {
+            std::size_t b = 0;
+            while (usec) { usec >>= 1; ++b; }
+            return b < M4qXE::kHistBuckets ? b : M4qXE::kHistBuckets - 1;
+        }
+
+        inline std::int64_t ToNs(M4qXE::TimePoint t) noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+        }
+
+        inline void Bump(std::atomic<std::uint64_t>& c) noexcept {
+            c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        // Heap order for the Deadline lane: the top is the earliest deadline.
+        struct DeadlineLater {
+            template <class N>
+            bool operator()(const N* a, const N* b) const noexcept {
+                return a->deadlineNs != b->deadlineNs ? a->deadlineNs > b->deadlineNs : a->seq > b->seq;
+            }
+        };
+
+        void HistJSON(std::ostringstream& ss, const M4qXE::Histogram& h) {
+            std::size_t last = 0;
+            for (std::size_t b = 0; b < M4qXE::kHistBuckets; ++b)
+                if (h.buckets[b]) last = b + 1;
+            ss << "{\"samples\":" << h.Count()
+                << ",\"p50\":" << h.PercentileUsec(0.50)
+                << ",\"p95\":" << h.PercentileUsec(0.95)
+                << ",\"p99\":" << h.PercentileUsec(0.99)
+                << ",\"buckets\":[";
+            for (std::size_t b = 0; b < last; ++b)
+                ss << (b ? "," : "") << h.buckets[b];
+            ss << "]}";
+        }
+
+        inline std::uint64_t BucketUpperUsec(std::size_t b) noexcept {
+            return 1ull << b;
+        }
+
+        // Name, pin and prioritise the calling thread. Returns false if the OS
+        // refused any part (e.g. a raised priority without the privilege).
+        bool ConfigureThisThread(const std::string& name, std::uint64_t cpuMask, int priority) {
+            bool ok = true;
+#if defined(_WIN32)
+            const std::wstring wname(name.begin(), name.end());
+            SetThreadDescription(GetCurrentThread(), wname.c_str());
+            if (cpuMask)
+                ok &= SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(cpuMask)) != 0;
+            if (priority) {
+                static const int kWinPrio[] = { THREAD_PRIORITY_LOWEST, THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL,
+                                                THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST };
+                ok &= SetThreadPriority(GetCurrentThread(), kWinPrio[std::clamp(priority, -2, 2) + 2]) != 0;
+            }
+#elif defined(__linux__)
+            pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());   // kernel limit: 15 chars
+            if (cpuMask) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for (int c = 0; c < 64 && c < CPU_SETSIZE; ++c)
+                    if (cpuMask & (1ull << c)) CPU_SET(c, &set);
+                ok &= pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+            }
+            if (priority < 0) {
+                // Background classes: the scheduler gives them leftover time only.
+                sched_param sp{};
+                ok &= sched_setscheduler(0, priority <= -2 ? SCHED_IDLE : SCHED_BATCH, &sp) == 0;
+            }
+            else if (priority > 0) {
+                // SCHED_FIFO/RR would let a busy lane starve the game; raise nice instead.
+                const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+                ok &= setpriority(PRIO_PROCESS, static_cast<id_t>(tid), priority >= 2 ? -10 : -5) == 0;
+            }
+#else
+            (void)name; (void)cpuMask; (void)priority;
+#endif
+            return ok;
+        }
+
+        inline void CpuRelax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        }
+    }
+
     const char* M4qXE::LaneName(Lane l) noexcept {
         switch (l) {
         case Lane::High:   return "High";
         case Lane::Normal: return "Normal";
         case Lane::Low:    return "Low";
         case Lane::IO:     return "IO";
+        case Lane::Deadline: return "Deadline";
         default:           return "?";
         }
     }
 
-    M4qXE::M4qXE() = default;
+    std::uint64_t M4qXE::Histogram::Count() const noexcept {
+        std::uint64_t n = 0;
+        for (std::uint64_t c : buckets) n += c;
+        return n;
+    }
+
+    std::uint64_t M4qXE::Histogram::PercentileUsec(double q) const noexcept {
+        const std::uint64_t n = Count();
+        if (!n) return 0;
+        const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(n))));
+        std::uint64_t seen = 0;
+        for (std::size_t b = 0; b < kHistBuckets; ++b) {
+            seen += buckets[b];
+            if (seen >= rank) return BucketUpperUsec(b);
+        }
+        return BucketUpperUsec(kHistBuckets - 1);
+    }
+
+    // ---------- Chase-Lev deque ----------
+
+    M4qXE::Deque::Deque() {
+        _rings.emplace_back(new Ring(64));
+        _ring.store(_rings.back().get(), std::memory_order_relaxed);
+    }
+
+    M4qXE::Deque::~Deque() = default;
+
+    void M4qXE::Deque::Push(Node* n) {
+        const std::int64_t b = _bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = _top.load(std::memory_order_acquire);
+        Ring* r = _ring.load(std::memory_order_relaxed);
+
+        if (b - t > r->cap - 1) {
+            auto grown = std::make_unique<Ring>(r->cap * 2);
+            for (std::int64_t i = t; i < b; ++i)
+                grown->Put(i, r->Get(i));
+            r = grown.get();
+            _rings.push_back(std::move(grown));
+            _ring.store(r, std::memory_order_release);
+        }
+
+        r->Put(b, n);
+        _bottom.store(b + 1, std::memory_order_release);   // publishes n to Steal()
+    }
+
+    M4qXE::Node* M4qXE::Deque::Take() {
+        // Empty is final for the owner (only it adds, thieves only raise
+        // _top), so skip the fence: pickups try the deque before every inbox.
+        if (_bottom.load(std::memory_order_relaxed) <= _top.load(std::memory_order_relaxed))
+            return nullptr;
+        const std::int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        Ring* r = _ring.load(std::memory_order_relaxed);
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = _top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Node* n = r->Get(b);
+        if (t == b) {
+            // Last element: race the thieves for it.
+            if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                n = nullptr;
+            _bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    M4qXE::Node* M4qXE::Deque::Steal() {
+        std::int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = _bottom.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        Ring* r = _ring.load(std::memory_order_acquire);
+        Node* n = r->Get(t);
+        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr; // lost to the owner or another thief
+        return n;
+    }
+
+    bool M4qXE::Deque::Empty() const noexcept {
+        return _bottom.load(std::memory_order_acquire) <= _top.load(std::memory_order_acquire);
+    }
+
+    // ---------- Inbox (MPSC, stealable) ----------
+
+    void M4qXE::Inbox::link(Node* n) noexcept {
+        n->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    // Dekker pair with Stop(): the count is bumped before `open` is read, and
+    // destroyPending() reads the counts after Stop() cleared `open`, so either
+    // Stop() waits for this node or this push sees the pool closed.
+    bool M4qXE::Inbox::TryPush(Node* n, const std::atomic<bool>& open) noexcept {
+        pushed.fetch_add(1, std::memory_order_seq_cst);
+        if (!open.load(std::memory_order_seq_cst)) {
+            pushed.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        link(n);
+        return true;
+    }
+
+    M4qXE::Node* M4qXE::Inbox::popUnlocked() noexcept {
+        Node* t = tail;
+        Node* next = t->next.load(std::memory_order_acquire);
+
+        if (t == &stub) {
+            if (!next) return nullptr;
+            tail = next;
+            t = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail = next;
+            return t;
+        }
+
+        // t is the last linked node; a producer may be mid-push.
+        if (t != head.load(std::memory_order_acquire))
+            return nullptr;
+
+        link(&stub);
+        next = t->next.load(std::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return t;
+        }
+        return nullptr;
+    }
+
+    M4qXE::Node* M4qXE::Inbox::TryPop() noexcept {
+        if (Empty()) return nullptr;
+        if (consuming.load(std::memory_order_relaxed) || consuming.exchange(true, std::memory_order_acquire))
+            return nullptr; // someone else is draining this inbox
+
+        Node* n = popUnlocked();
+        if (n) popped.store(popped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        consuming.store(false, std::memory_order_release);
+        return n;
+    }
+
+    bool M4qXE::Inbox::Empty() const noexcept {
+        // pushed is bumped before the node is linked, so an in-flight push
+        // already counts as pending (keeps the parking check conservative).
+        return pushed.load(std::memory_order_acquire) == popped.load(std::memory_order_acquire);
+    }
+
+    // ---------- Node pool ----------
+
+    M4qXE::Node* M4qXE::acquireNode() {
+        // Workers reuse what they just ran first; no shared state touched.
+        if (t_self.pool == this) {
+            Worker& w = *_workers[t_self.index];
+            if (Node* n = w.freeHead) {
+                w.freeHead = n->freeNext;
+                if (!w.freeHead) w.freeTail = nullptr;
+                --w.freeCount;
+                n->freeNext = nullptr;
+                return n;
+            }
+        }
+
+        return _nodes.Acquire();
+    }
+
+    // A node filled by a producer whose push was refused; straight back to the pool.
+    void M4qXE::discardNode(Node* n) noexcept {
+        n->fn.Reset();
+        n->cancel.reset();
+        if (!n->pooled) { delete n; return; }
+        _nodes.Release(n, n);
+    }
+
+    void M4qXE::releaseNode(Worker& w, Node* n) noexcept {
+        if (!n->pooled) { delete n; return; }
+        n->freeNext = w.freeHead;
+        w.freeHead = n;
+        if (!w.freeTail) w.freeTail = n;
+        if (++w.freeCount >= kFreeBatch)
+            flushFreeNodes(w);
+    }
+
+    void M4qXE::flushFreeNodes(Worker& w) noexcept {
+        if (!w.freeHead) return;
+        _nodes.Release(w.freeHead, w.freeTail);
+        w.freeHead = w.freeTail = nullptr;
+        w.freeCount = 0;
+    }
+
+    // ---------- Pool ----------
+
+    M4qXE::M4qXE() : M4qXE(Config{}) {}
+
     M4qXE::M4qXE(const Config& cfg) : _cfg(cfg) {}
 
     M4qXE::~M4qXE() {
@@ -103,12 +494,40 @@ namespace MB {
             return; // already running
         }
 
-        std::lock_guard<std::mutex> lk(_mx);
-        _stopping = false;
+        _stopping.store(false, std::memory_order_relaxed);
+
+        // The layout depends on the config alone and is built on the first
+        // Start() only: slots outlive Stop() because a producer refused by
+        // Stop() may still be backing out of an inbox (or reading _dedicated)
+        // when the pool restarts.
+        if (_workers.empty()) {
+            // Lanes with dedicated workers are left out of the shared schedule.
+            for (std::size_t l = 0; l < kLaneCount; ++l)
+                _dedicated[l] = _cfg.lanes[l].dedicated;
+
+            // Sizing: an explicit worker count without maxWorkers keeps the old
+            // fixed-size behaviour; otherwise the pool floats in [min, max].
+            const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+            _maxWorkers = _cfg.maxWorkers ? _cfg.maxWorkers : (_cfg.workers ? _cfg.workers : hw);
+            _minWorkers = std::clamp(_cfg.minWorkers ? _cfg.minWorkers : 1u, 1u, _maxWorkers);
+            if (_cfg.workers && !_cfg.maxWorkers) _minWorkers = _maxWorkers;
+
+            for (unsigned i = 0; i < _maxWorkers; ++i)
+                _workers.push_back(std::make_unique<Worker>());
+            for (std::size_t l = 0; l < kLaneCount; ++l) {
+                _dedicatedFirst[l] = static_cast<unsigned>(_workers.size());
+                for (unsigned i = 0; i < _dedicated[l]; ++i) {
+                    _workers.push_back(std::make_unique<Worker>());
+                    _workers.back()->group = l;
+                }
+            }
+        }
+        const unsigned N = _cfg.workers ? std::clamp(_cfg.workers, _minWorkers, _maxWorkers) : _minWorkers;
 
         // Build schedule from weights
         _schedule.clear();
         auto pushN = [this](Lane l, unsigned n) {
+            if (_dedicated[static_cast<std::size_t>(l)]) return;
             if (n == 0) n = 1;
             for (unsigned i = 0; i < n; ++i) _schedule.push_back(l);
             };
@@ -116,97 +535,300 @@ namespace MB {
         pushN(Lane::Normal, _cfg.weightNormal);
         pushN(Lane::Low, _cfg.weightLow);
         pushN(Lane::IO, _cfg.weightIO);
-        if (_schedule.empty()) _schedule.push_back(Lane::Normal);
-        _schedCursor = 0;
 
-        const unsigned N = _cfg.workers ? _cfg.workers : 1;
-        _threads.reserve(N);
-        for (unsigned i = 0; i < N; ++i) {
-            _threads.emplace_back(&M4qXE::workerLoop, this, i);
+        // Precompute the fall-through order for each cursor position so a
+        // pickup never retries a lane it already found empty.
+        const std::size_t S = _schedule.size();
+        _sharedFifoLanes = 0;
+        for (std::size_t l = 0; l < kFifoLanes; ++l)
+            if (!_dedicated[l]) ++_sharedFifoLanes;
+        _laneOrder.assign(std::max<std::size_t>(S, 1), {});
+        for (std::size_t c = 0; c < S; ++c) {
+            bool seen[kFifoLanes]{};
+            std::size_t k = 0;
+            for (std::size_t j = 0; j < S && k < _sharedFifoLanes; ++j) {
+                const std::size_t l = static_cast<std::size_t>(_schedule[(c + j) % S]);
+                if (!seen[l]) { seen[l] = true; _laneOrder[c][k++] = static_cast<std::uint8_t>(l); }
+            }
         }
+        _schedCursor.store(0, std::memory_order_relaxed);
+
+        _threads.clear();
+        _threads.resize(_workers.size());
+        _slotsUsed.store(0, std::memory_order_relaxed);
+        _grows.store(0, std::memory_order_relaxed);
+        _shrinks.store(0, std::memory_order_relaxed);
+        _lastWaitP95Usec.store(0, std::memory_order_relaxed);
 
-        MBLOGI("M4qXE started with %u workers", N);
+        {
+            std::lock_guard<std::mutex> lk(_resizeMx);
+            for (unsigned i = 0; i < N; ++i)
+                launchWorker(i);
+            for (std::size_t s = _maxWorkers; s < _workers.size(); ++s)
+                launchWorker(static_cast<unsigned>(s));
+            _workerCount.store(N, std::memory_order_release);
+        }
+        _accepting.store(true, std::memory_order_release);
 
-        // Optional per-run reset of stats/ewma
-        _qHigh.execCount = _qNormal.execCount = _qLow.execCount = _qIO.execCount = 0;
-        _qHigh.enqCount = _qNormal.enqCount = _qLow.enqCount = _qIO.enqCount = 0;
-        _ewmaUsec = 0.0;
+        if (_minWorkers < _maxWorkers)
+            _monitor = std::thread(&M4qXE::monitorLoop, this);
+
+        MBLOGI("M4qXE started with %u workers (min %u, max %u, dedicated %u)", N, _minWorkers, _maxWorkers,
+            static_cast<unsigned>(_workers.size() - _maxWorkers));
     }
 
     void M4qXE::Stop() {
         if (!_running.exchange(false)) {
             return; // was not running
         }
+        // Pushes already counted in an inbox still land; destroyPending()
+        // waits for them. Later ones see the flag and back out.
+        _accepting.store(false, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lk(_ctlMx);
+            _stopping.store(true, std::memory_order_release);
+        }
+        _ctlCv.notify_all();
+        if (_monitor.joinable()) _monitor.join();
+
         {
-            std::lock_guard<std::mutex> lk(_mx);
-            _stopping = true;
-            if (!_cfg.drainOnStop) {
-                clearAllUnlocked();
+            std::lock_guard<std::mutex> lk(_parkMx);
+            ++_wakeSeq;
+        }
+        _parkCv.notify_all();
+        for (auto& cv : _laneParkCv) cv.notify_all();
+
+        {
+            std::lock_guard<std::mutex> lk(_resizeMx);
+            for (auto& t : _threads) {
+                if (t.joinable()) t.join();
             }
+            _threads.clear();
+            _workerCount.store(0, std::memory_order_release);
         }
-        _cv.notify_all();
 
-        for (auto& t : _threads) {
-            if (t.joinable()) t.join();
+        // Anything that slipped in while the workers were exiting.
+        destroyPending(_cfg.drainOnStop);
+
+        {
+            std::lock_guard<std::mutex> lk(_flushMx);
         }
-        _threads.clear();
+        _flushCv.notify_all();
 
         MBLOGI("M4qXE stopped");
     }
 
     void M4qXE::Flush() {
-        std::unique_lock<std::mutex> lk(_mx);
-        _cv.wait(lk, [this] {
+        std::unique_lock<std::mutex> lk(_flushMx);
+        // Registered before the first check: see notifyFlush().
+        _flushWaiters.fetch_add(1, std::memory_order_seq_cst);
+        _flushCv.wait(lk, [this] {
             // Exit if not running OR no pending work (covers drain and non-drain)
-            return !_running.load(std::memory_order_acquire) || !hasAnyPendingUnlocked();
+            return !_running.load(std::memory_order_acquire) || pendingTasks() == 0;
             });
+        _flushWaiters.fetch_sub(1, std::memory_order_relaxed);
     }
 
-    bool M4qXE::Enqueue(Lane lane, Task task) {
-        if (!task) return false;
-        if (!_running.load(std::memory_order_acquire)) return false;
+    // Enqueued minus finished, over every slot. Executed counts are read
+    // first: a task is counted as pushed before it can run, so a zero here is
+    // never early. seq_cst loads pair with the fence in notifyFlush().
+    std::uint64_t M4qXE::pendingTasks() const noexcept {
+        std::uint64_t exec = 0, enq = 0;
+        for (const auto& w : _workers)
+            for (std::size_t l = 0; l < kLaneCount; ++l)
+                exec += w->executed[l].load(std::memory_order_seq_cst);
+        enq = _edf.pushed.load(std::memory_order_seq_cst);
+        for (const auto& w : _workers) {
+            for (std::size_t l = 0; l < kFifoLanes; ++l)
+                enq += w->localPushed[l].load(std::memory_order_seq_cst) + w->inbox[l].pushed.load(std::memory_order_seq_cst);
+        }
+        return enq > exec ? enq - exec : 0;
+    }
 
+    // A worker that just ran out of work. The fence orders its executed
+    // counts before the waiter check; Flush() registers before it sums. So
+    // either the last worker to go idle sees the waiter and a zero sum, or
+    // Flush() sees every finished task itself.
+    void M4qXE::notifyFlush() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_flushWaiters.load(std::memory_order_relaxed) == 0 || pendingTasks() != 0) return;
         {
-            std::lock_guard<std::mutex> lk(_mx);
-            if (_stopping) return false;
+            std::lock_guard<std::mutex> lk(_flushMx);
+        }
+        _flushCv.notify_all();
+    }
+
+    bool M4qXE::Enqueue(Lane lane, Task task, CancellationToken token) {
+        if (lane == Lane::Deadline)
+            return pushDeadline(std::move(task), SteadyNs(), false, std::move(token));
+        if (!task) return false;
+        // Also orders everything Start() set up before what follows.
+        if (!_accepting.load(std::memory_order_acquire)) return false;
 
-            auto& q = (lane == Lane::High) ? _qHigh
-                : (lane == Lane::Normal) ? _qNormal
-                : (lane == Lane::Low) ? _qLow
-                : _qIO; // default to IO only if explicitly asked
+        Node* n = acquireNode();
+        n->fn = std::move(task);
+        if (!n->fn.IsInline())
+            _heapFallbacks.fetch_add(1, std::memory_order_relaxed);
+        n->lane = lane;
+        n->trackMiss = false;
+        if (token._state) n->cancel = std::move(token._state);
+        n->enqNs = ((t_waitSampleTick[static_cast<std::size_t>(lane)]++ & kWaitSampleMask) == 0) ? SteadyNs() : 0;
 
-            q.dq.emplace_back(std::move(task));
-            ++q.enqCount;
+        // A worker keeps its own spawns if it serves the lane; everything else
+        // goes to an inbox of the lane's group (dedicated range or shared).
+        // Workers are joined before Stop() drains, so their own pushes need no
+        // handshake; inbox pushes go through TryPush().
+        const std::size_t li = static_cast<std::size_t>(lane);
+        const std::size_t group = _dedicated[li] ? li : kSharedGroup;
+        if (t_self.pool == this && _workers[t_self.index]->group == group) {
+            Worker& w = *_workers[t_self.index];
+            w.deques[li].Push(n);
+            w.localPushed[li].store(w.localPushed[li].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        else {
+            Inbox* box = nullptr;
+            if (group != kSharedGroup) {
+                box = &_workers[_dedicatedFirst[li] + t_inboxCursor++ % _dedicated[li]]->inbox[li];
+            }
+            else if (const std::size_t W = _workerCount.load(std::memory_order_acquire)) {
+                box = &_workers[t_inboxCursor++ % W]->inbox[li];
+            }
+            if (!box || !box->TryPush(n, _accepting)) {
+                discardNode(n);
+                return false;
+            }
         }
-        _cv.notify_one();
+
+        wakeGroup(group);
         return true;
     }
 
+    bool M4qXE::EnqueueDeadline(TimePoint deadline, Task task, CancellationToken token) {
+        return pushDeadline(std::move(task), ToNs(deadline), true, std::move(token));
+    }
+
+    bool M4qXE::pushDeadline(Task&& task, std::int64_t deadlineNs, bool trackMiss, CancellationToken&& token) {
+        if (!task) return false;
+        if (!_accepting.load(std::memory_order_acquire)) return false;
+
+        Node* n = acquireNode();
+        n->fn = std::move(task);
+        if (!n->fn.IsInline())
+            _heapFallbacks.fetch_add(1, std::memory_order_relaxed);
+        if (token._state) n->cancel = std::move(token._state);
+        n->lane = Lane::Deadline;
+        n->enqNs = SteadyNs();      // always stamped
+        n->deadlineNs = deadlineNs;
+        n->trackMiss = trackMiss;
+
+        {
+            // Checked under the heap lock: destroyPending() takes it after
+            // Stop() cleared the flag, so a push either lands before the
+            // drain or sees the pool closed.
+            std::lock_guard<std::mutex> lk(_edf.mx);
+            if (!_accepting.load(std::memory_order_relaxed)) {
+                discardNode(n);
+                return false;
+            }
+            // Counted before a worker can pop it (pendingTasks() relies on it).
+            _edf.pushed.fetch_add(1, std::memory_order_relaxed);
+            n->seq = _edf.nextSeq++;
+            _edf.heap.push_back(n);
+            std::push_heap(_edf.heap.begin(), _edf.heap.end(), DeadlineLater{});
+            _edf.size.store(_edf.heap.size(), std::memory_order_release);
+        }
+
+        const std::size_t dl = static_cast<std::size_t>(Lane::Deadline);
+        wakeGroup(_dedicated[dl] ? dl : kSharedGroup);
+        return true;
+    }
+
+    CancellationToken M4qXE::CurrentToken() {
+        return t_cancel ? CancellationToken(*t_cancel) : CancellationToken();
+    }
+
+    bool M4qXE::CancellationRequested() noexcept {
+        return t_cancel && *t_cancel && (*t_cancel)->IsCancelled();
+    }
+
+    bool M4qXE::ScheduleAwaiter::await_suspend(std::coroutine_handle<> h) {
+        // Once accepted, the coroutine may already be running elsewhere:
+        // nothing below may touch the awaiter or the frame.
+        t_handing = h.address();
+        const bool queued = pool->Enqueue(lane, ScheduledResume(h, &dropped));
+        t_handing = nullptr;
+        return queued;
+    }
+
     bool M4qXE::IsRunning() const noexcept {
         return _running.load(std::memory_order_acquire);
     }
 
     size_t M4qXE::WorkerCount() const {
-        std::lock_guard<std::mutex> lk(_mx);
-        return _threads.size();
+        return _workerCount.load(std::memory_order_acquire);
     }
 
     M4qXE::Stats M4qXE::GetStats() const {
-        std::lock_guard<std::mutex> lk(_mx);
+        std::uint64_t enq[kLaneCount]{};
+        std::uint64_t exec[kLaneCount]{};
         Stats s;
-        s.executedHigh = _qHigh.execCount;
-        s.executedNormal = _qNormal.execCount;
-        s.executedLow = _qLow.execCount;
-        s.executedIO = _qIO.execCount;
-        s.enqHigh = _qHigh.enqCount;
-        s.enqNormal = _qNormal.enqCount;
-        s.enqLow = _qLow.enqCount;
-        s.enqIO = _qIO.enqCount;
-        s.pendingHigh = _qHigh.dq.size();
-        s.pendingNormal = _qNormal.dq.size();
-        s.pendingLow = _qLow.dq.size();
-        s.pendingIO = _qIO.dq.size();
-        s.ewmaUsec = _ewmaUsec;
+        double ewmaSum = 0.0;
+        std::size_t ewmaN = 0;
+
+        // Sum every slot: retired workers' counters still count, never-used
+        // slots are zero.
+        for (const auto& wp : _workers) {
+            const Worker& w = *wp;
+            for (std::size_t l = 0; l < kFifoLanes; ++l) {
+                enq[l] += w.localPushed[l].load(std::memory_order_relaxed)
+                    + w.inbox[l].pushed.load(std::memory_order_relaxed);
+            }
+            for (std::size_t l = 0; l < kLaneCount; ++l) {
+                exec[l] += w.executed[l].load(std::memory_order_relaxed);
+                for (std::size_t b = 0; b < kHistBuckets; ++b) {
+                    s.lanes[l].wait.buckets[b] += w.waitHist[l][b].load(std::memory_order_relaxed);
+                    s.lanes[l].run.buckets[b] += w.runHist[l][b].load(std::memory_order_relaxed);
+                }
+            }
+            s.steals += w.steals.load(std::memory_order_relaxed);
+            s.deadlineMisses += w.deadlineMisses.load(std::memory_order_relaxed);
+            s.cancelledBeforeRun += w.cancelledBeforeRun.load(std::memory_order_relaxed);
+            s.cancelledDuringRun += w.cancelledDuringRun.load(std::memory_order_relaxed);
+            const double e = w.ewmaUsec.load(std::memory_order_relaxed);
+            if (e > 0.0) { ewmaSum += e; ++ewmaN; }
+        }
+
+        enq[static_cast<std::size_t>(Lane::Deadline)] = _edf.pushed.load(std::memory_order_relaxed);
+
+        auto pending = [&](std::size_t l) {
+            return static_cast<std::size_t>(enq[l] > exec[l] ? enq[l] - exec[l] : 0);
+        };
+        s.executedHigh = exec[0];
+        s.executedNormal = exec[1];
+        s.executedLow = exec[2];
+        s.executedIO = exec[3];
+        s.executedDeadline = exec[4];
+        s.enqHigh = enq[0];
+        s.enqNormal = enq[1];
+        s.enqLow = enq[2];
+        s.enqIO = enq[3];
+        s.enqDeadline = enq[4];
+        s.pendingHigh = pending(0);
+        s.pendingNormal = pending(1);
+        s.pendingLow = pending(2);
+        s.pendingIO = pending(3);
+        s.pendingDeadline = pending(4);
+        s.ewmaUsec = ewmaN ? ewmaSum / static_cast<double>(ewmaN) : 0.0;
+        s.dedicatedWorkers = _workers.size() > _maxWorkers ? _workers.size() - _maxWorkers : 0;
+        s.workers = _workerCount.load(std::memory_order_acquire) + (_running.load(std::memory_order_acquire) ? s.dedicatedWorkers : 0);
+        s.minWorkers = _minWorkers;
+        s.maxWorkers = _maxWorkers;
+        s.grows = _grows.load(std::memory_order_relaxed);
+        s.shrinks = _shrinks.load(std::memory_order_relaxed);
+        s.waitP95Usec = _lastWaitP95Usec.load(std::memory_order_relaxed);
+        s.heapFallbacks = _heapFallbacks.load(std::memory_order_relaxed);
+        s.poolMisses = _nodes.Misses();
+        s.poolNodes = _nodes.Nodes();
         return s;
     }
 
@@ -220,131 +842,489 @@ namespace MB {
             << "\"high\":" << s.executedHigh << ","
             << "\"normal\":" << s.executedNormal << ","
             << "\"low\":" << s.executedLow << ","
-            << "\"io\":" << s.executedIO
+            << "\"io\":" << s.executedIO << ","
+            << "\"deadline\":" << s.executedDeadline
             << "},"
             << "\"enqueued\":{"
             << "\"high\":" << s.enqHigh << ","
             << "\"normal\":" << s.enqNormal << ","
             << "\"low\":" << s.enqLow << ","
-            << "\"io\":" << s.enqIO
+            << "\"io\":" << s.enqIO << ","
+            << "\"deadline\":" << s.enqDeadline
             << "},"
             << "\"pending\":{"
             << "\"high\":" << s.pendingHigh << ","
             << "\"normal\":" << s.pendingNormal << ","
             << "\"low\":" << s.pendingLow << ","
-            << "\"io\":" << s.pendingIO
+            << "\"io\":" << s.pendingIO << ","
+            << "\"deadline\":" << s.pendingDeadline
             << "},"
-            << "\"ewmaUsec\":" << s.ewmaUsec
-            << "}";
+            << "\"deadlineMisses\":" << s.deadlineMisses << ","
+            << "\"cancelled\":{"
+            << "\"beforeRun\":" << s.cancelledBeforeRun << ","
+            << "\"duringRun\":" << s.cancelledDuringRun
+            << "},"
+            << "\"ewmaUsec\":" << s.ewmaUsec << ","
+            << "\"steals\":" << s.steals << ","
+            << "\"workers\":" << s.workers << ","
+            << "\"pool\":{"
+            << "\"min\":" << s.minWorkers << ","
+            << "\"max\":" << s.maxWorkers << ","
+            << "\"grows\":" << s.grows << ","
+            << "\"shrinks\":" << s.shrinks << ","
+            << "\"waitP95Usec\":" << s.waitP95Usec << ","
+            << "\"dedicated\":" << s.dedicatedWorkers
+            << "},"
+            << "\"alloc\":{"
+            << "\"heapFallbacks\":" << s.heapFallbacks << ","
+            << "\"poolMisses\":" << s.poolMisses << ","
+            << "\"poolNodes\":" << s.poolNodes
+            << "},"
+            << "\"lanes\":{";
+        static const char* const kKeys[kLaneCount] = { "high", "normal", "low", "io", "deadline" };
+        for (std::size_t l = 0; l < kLaneCount; ++l) {
+            ss << (l ? "," : "") << "\"" << kKeys[l] << "\":{\"waitUsec\":";
+            HistJSON(ss, s.lanes[l].wait);
+            ss << ",\"runUsec\":";
+            HistJSON(ss, s.lanes[l].run);
+            ss << "}";
+        }
+        ss << "}}";
         return ss.str();
     }
 
-    bool M4qXE::hasAnyPendingUnlocked() const {
-        return !_qHigh.dq.empty() || !_qNormal.dq.empty() || !_qLow.dq.empty() || !_qIO.dq.empty();
+    // ---------- Worker side ----------
+
+    M4qXE::Node* M4qXE::takeFromLane(unsigned self, std::size_t lane) {
+        Worker& me = *_workers[self];
+        if (Node* n = me.deques[lane].Take()) return n;
+        if (Node* n = me.inbox[lane].TryPop()) return n;
+
+        const std::size_t W = _slotsUsed.load(std::memory_order_acquire);
+        for (std::size_t k = 1; k < W; ++k) {
+            Worker& victim = *_workers[(self + k) % W];
+            Node* n = victim.deques[lane].Steal();
+            if (!n) n = victim.inbox[lane].TryPop();
+            if (n) {
+                me.steals.store(me.steals.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return n;
+            }
+        }
+        return nullptr;
     }
 
-    void M4qXE::clearAllUnlocked() {
-        _qHigh.dq.clear();
-        _qNormal.dq.clear();
-        _qLow.dq.clear();
-        _qIO.dq.clear();
+    M4qXE::Node* M4qXE::takeDeadline() {
+        if (_edf.size.load(std::memory_order_acquire) == 0) return nullptr;
+        std::lock_guard<std::mutex> lk(_edf.mx);
+        if (_edf.heap.empty()) return nullptr;
+        std::pop_heap(_edf.heap.begin(), _edf.heap.end(), DeadlineLater{});
+        Node* n = _edf.heap.back();
+        _edf.heap.pop_back();
+        _edf.size.store(_edf.heap.size(), std::memory_order_release);
+        return n;
     }
 
-    bool M4qXE::tryPop(Task& out, Lane& outLane) {
-        // Requires external lock held
-        if (_schedule.empty()) {
-            // Fallback ordering if someone bypassed Start()
-            _schedule = { Lane::High, Lane::Normal, Lane::Low, Lane::IO };
+    M4qXE::Node* M4qXE::takeDedicated(unsigned self, std::size_t lane) {
+        if (lane == static_cast<std::size_t>(Lane::Deadline)) return takeDeadline();
+
+        Worker& me = *_workers[self];
+        if (Node* n = me.deques[lane].Take()) return n;
+        if (Node* n = me.inbox[lane].TryPop()) return n;
+
+        // Steal only within the lane's own group.
+        const unsigned first = _dedicatedFirst[lane];
+        const unsigned count = _dedicated[lane];
+        for (unsigned k = 1; k < count; ++k) {
+            Worker& victim = *_workers[first + (self - first + k) % count];
+            Node* n = victim.deques[lane].Steal();
+            if (!n) n = victim.inbox[lane].TryPop();
+            if (n) {
+                me.steals.store(me.steals.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return n;
+            }
         }
+        return nullptr;
+    }
 
-        const size_t N = _schedule.size();
-        for (size_t k = 0; k < N; ++k) {
-            const Lane l = _schedule[_schedCursor];
-            _schedCursor = (_schedCursor + 1) % N;
+    M4qXE::Node* M4qXE::findWork(unsigned self) {
+        const std::size_t group = _workers[self]->group;
+        if (group != kSharedGroup) return takeDedicated(self, group);
 
-            switch (l) {
-            case Lane::High:
-                if (!_qHigh.dq.empty()) {
-                    out = std::move(_qHigh.dq.front()); _qHigh.dq.pop_front(); outLane = Lane::High; return true;
-                }
-                break;
-            case Lane::Normal:
-                if (!_qNormal.dq.empty()) {
-                    out = std::move(_qNormal.dq.front()); _qNormal.dq.pop_front(); outLane = Lane::Normal; return true;
-                }
-                break;
-            case Lane::Low:
-                if (!_qLow.dq.empty()) {
-                    out = std::move(_qLow.dq.front()); _qLow.dq.pop_front(); outLane = Lane::Low; return true;
-                }
-                break;
-            case Lane::IO:
-                if (!_qIO.dq.empty()) {
-                    out = std::move(_qIO.dq.front()); _qIO.dq.pop_front(); outLane = Lane::IO; return true;
-                }
-                break;
-            default:
-                break;
+        if (!_dedicated[static_cast<std::size_t>(Lane::Deadline)]) {
+            if (Node* n = takeDeadline()) return n;
+        }
+
+        // The arbiter: one shared cursor over the weighted schedule decides
+        // which lane this pickup favours; the rest follow in schedule order.
+        const std::uint64_t c = _schedCursor.fetch_add(1, std::memory_order_relaxed);
+        const auto& order = _laneOrder[static_cast<std::size_t>(c % _laneOrder.size())];
+        for (std::size_t k = 0; k < _sharedFifoLanes; ++k) {
+            if (Node* n = takeFromLane(self, order[k])) return n;
+        }
+        return nullptr;
+    }
+
+    bool M4qXE::hasPendingFor(std::size_t group) const noexcept {
+        const std::size_t dl = static_cast<std::size_t>(Lane::Deadline);
+        if (group == dl)
+            return _edf.size.load(std::memory_order_acquire) != 0;
+
+        if (group != kSharedGroup) {
+            const unsigned first = _dedicatedFirst[group];
+            for (unsigned i = first; i < first + _dedicated[group]; ++i) {
+                const Worker& w = *_workers[i];
+                if (!w.deques[group].Empty() || !w.inbox[group].Empty()) return true;
+            }
+            return false;
+        }
+
+        if (!_dedicated[dl] && _edf.size.load(std::memory_order_acquire) != 0) return true;
+        const std::size_t W = _slotsUsed.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < W; ++i) {
+            const Worker& w = *_workers[i];
+            for (std::size_t l = 0; l < kFifoLanes; ++l) {
+                if (_dedicated[l]) continue;
+                if (!w.deques[l].Empty() || !w.inbox[l].Empty()) return true;
             }
         }
         return false;
     }
 
-    void M4qXE::workerLoop(unsigned /*workerIndex*/) {
+    void M4qXE::runTask(Worker& w, Node* n) {
         using clock = std::chrono::steady_clock;
-        for (;;) {
-            Task t;
-            Lane lane = Lane::Normal;
-
-            {
-                std::unique_lock<std::mutex> lk(_mx);
-                _cv.wait(lk, [this] {
-                    // Wake when there is work, or we are stopping
-                    return _stopping || hasAnyPendingUnlocked();
-                    });
-
-                if (_stopping) {
-                    if (!_cfg.drainOnStop) break;
-                    if (!hasAnyPendingUnlocked()) break; // drained
-                }
+        const std::size_t li = static_cast<std::size_t>(n->lane);
 
-                if (!tryPop(t, lane)) {
-                    // Spurious wake or no work after drain; continue wait
-                    continue;
-                }
+        // Only this worker writes its counters; plain load/store avoids a locked op.
+        const std::uint64_t seq = w.executed[li].load(std::memory_order_relaxed);
+
+        // Cancelled while queued: drop it unrun. It still retires as executed
+        // so pending counts and Flush() stay exact.
+        if (n->cancel && n->cancel->IsCancelled()) {
+            n->fn.Reset();
+            n->cancel.reset();
+            releaseNode(w, n);
+            w.executed[li].store(seq + 1, std::memory_order_release);
+            Bump(w.cancelledBeforeRun);
+            return;
+        }
+        const bool timed = (seq & kTimingSampleMask) == 0;
+
+        // Run time follows the EWMA sampling (a second clock read per task
+        // shows up in submit throughput); deadline tasks are always measured.
+        const bool stamped = n->enqNs != 0;
+        const bool measured = timed || n->lane == Lane::Deadline;
+        const auto t0 = (measured || stamped) ? clock::now() : clock::time_point{};
+        if (stamped) {
+            const std::int64_t startNs = ToNs(t0);
+            const std::int64_t waitNs = startNs - n->enqNs;
+            Bump(w.waitHist[li][HistBucket(waitNs > 0 ? static_cast<std::uint64_t>(waitNs) / 1000 : 0)]);
+            if (n->trackMiss && startNs > n->deadlineNs)
+                Bump(w.deadlineMisses);
+        }
+
+        // Token bookkeeping only for tasks that carry one (or run nested in
+        // one that does); the common tokenless task skips it.
+        uint64_t usec = 0;
+        const auto* prevCancel = t_cancel;
+        const bool swapCancel = n->cancel || prevCancel;
+        if (swapCancel) t_cancel = n->cancel ? &n->cancel : nullptr;
+        try {
+            n->fn();
+            if (measured) usec = toUsec(clock::now() - t0);
+        }
+        catch (const OperationCanceled&) {
+            // Cooperative exit; counted below.
+        }
+        catch (...) {
+            MBLOGE("M4qXE: task threw an exception");
+        }
+        if (swapCancel) {
+            t_cancel = prevCancel;
+            if (n->cancel) {
+                if (n->cancel->IsCancelled()) Bump(w.cancelledDuringRun);
+                n->cancel.reset();
             }
+        }
+        n->fn.Reset();
+        releaseNode(w, n);
+
+        // Release: pendingTasks() may read this before the lane counts.
+        w.executed[li].store(seq + 1, std::memory_order_release);
+        if (measured)
+            Bump(w.runHist[li][HistBucket(usec)]);
+        if (timed) {
+            const double alpha = 0.1;
+            const double prev = w.ewmaUsec.load(std::memory_order_relaxed);
+            w.ewmaUsec.store((prev <= 0.0)
+                ? static_cast<double>(usec)
+                : (alpha * usec + (1.0 - alpha) * prev), std::memory_order_relaxed);
+        }
+    }
+
+    void M4qXE::wakeGroup(std::size_t group) {
+        const bool shared = group == kSharedGroup;
+        std::atomic<unsigned>& sleepers = shared ? _sleepers : _laneSleepers[group];
+
+        // Pairs with the fence in park(): either a parking worker sees this
+        // task on its final scan or we see it counted as a sleeper.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) == 0) return;
+        {
+            std::lock_guard<std::mutex> lk(_parkMx);
+            ++_wakeSeq;
+        }
+        (shared ? _parkCv : _laneParkCv[group]).notify_one();
+    }
+
+    void M4qXE::park(unsigned self) {
+        const std::size_t group = _workers[self]->group;
+        const bool shared = group == kSharedGroup;
+        std::atomic<unsigned>& sleepers = shared ? _sleepers : _laneSleepers[group];
+        std::condition_variable& cv = shared ? _parkCv : _laneParkCv[group];
+
+        std::unique_lock<std::mutex> lk(_parkMx);
+        const std::uint64_t seen = _wakeSeq;
+
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!hasPendingFor(group) && !_stopping.load(std::memory_order_acquire)) {
+            auto woken = [&] {
+                return _wakeSeq != seen || _stopping.load(std::memory_order_acquire);
+                };
+            // Shared workers above the minimum wake after the linger to consider retiring.
+            if (shared && self >= _minWorkers)
+                cv.wait_for(lk, std::chrono::milliseconds(_cfg.lingerMs), woken);
+            else
+                cv.wait(lk, woken);
+        }
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // ---------- Elastic sizing ----------
+
+    void M4qXE::launchWorker(unsigned slot) {
+        // Caller holds _resizeMx. A retired thread may still be unwinding.
+        if (_threads[slot].joinable()) _threads[slot].join();
+        if (slot < _maxWorkers && _slotsUsed.load(std::memory_order_relaxed) < slot + 1u)
+            _slotsUsed.store(slot + 1u, std::memory_order_release);
+        _threads[slot] = std::thread(&M4qXE::workerLoop, this, slot);
+    }
+
+    void M4qXE::applyThreadSettings(unsigned slot) {
+        const std::size_t group = _workers[slot]->group;
+        std::string name = _cfg.threadName.empty() ? std::string("M4qXE") : _cfg.threadName;
+        std::uint64_t mask = _cfg.sharedCpuMask;
+        int prio = _cfg.sharedPriority;
+        if (group == kSharedGroup) {
+            name += "/" + std::to_string(slot);
+        }
+        else {
+            name += std::string("/") + LaneName(static_cast<Lane>(group)) + "." + std::to_string(slot - _dedicatedFirst[group]);
+            mask = _cfg.lanes[group].cpuMask;
+            prio = _cfg.lanes[group].priority;
+        }
+        if (!ConfigureThisThread(name, mask, prio))
+            MBLOGW("M4qXE: %s: could not apply affinity 0x%llx / priority %d", name.c_str(),
+                static_cast<unsigned long long>(mask), prio);
+    }
+
+    bool M4qXE::tryRetire(unsigned self) {
+        // Only the highest live slot retires, so live slots stay contiguous.
+        if (self < _minWorkers || _workerCount.load(std::memory_order_acquire) != self + 1u)
+            return false;
+
+        std::unique_lock<std::mutex> lk(_resizeMx, std::try_to_lock);
+        if (!lk.owns_lock()) return false;
+        if (_workerCount.load(std::memory_order_acquire) != self + 1u || hasPendingFor(kSharedGroup))
+            return false;
+
+        _workerCount.store(self, std::memory_order_release);
+        _shrinks.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void M4qXE::adjustPoolSize(std::uint64_t* prevHist, std::uint64_t& prevExec) {
+        Histogram window;
+        std::uint64_t samples = 0;
+        std::uint64_t exec = 0;
 
-            uint64_t usec = 0;
-            try {
-                const auto t0 = clock::now();
-                t();
-                const auto t1 = clock::now();
-                usec = toUsec(t1 - t0);
+        // Shared workers only: dedicated lanes never reach shared slots.
+        std::uint64_t enq = _dedicated[static_cast<std::size_t>(Lane::Deadline)] ? 0 : _edf.pushed.load(std::memory_order_relaxed);
+        double ewmaSum = 0.0;
+        std::size_t ewmaN = 0;
+
+        const std::size_t used = _slotsUsed.load(std::memory_order_acquire);
+        std::uint64_t cur[kHistBuckets]{};
+        for (std::size_t i = 0; i < used; ++i) {
+            const Worker& w = *_workers[i];
+            for (std::size_t l = 0; l < kLaneCount; ++l) {
+                for (std::size_t b = 0; b < kHistBuckets; ++b)
+                    cur[b] += w.waitHist[l][b].load(std::memory_order_relaxed);
+                exec += w.executed[l].load(std::memory_order_relaxed);
             }
-            catch (...) {
-                MBLOGE("M4qXE: task threw an exception");
+            for (std::size_t l = 0; l < kFifoLanes; ++l) {
+                enq += w.localPushed[l].load(std::memory_order_relaxed)
+                    + w.inbox[l].pushed.load(std::memory_order_relaxed);
             }
+            const double e = w.ewmaUsec.load(std::memory_order_relaxed);
+            if (e > 0.0) { ewmaSum += e; ++ewmaN; }
+        }
+        for (std::size_t b = 0; b < kHistBuckets; ++b) {
+            window.buckets[b] = cur[b] - prevHist[b];
+            prevHist[b] = cur[b];
+            samples += window.buckets[b];
+        }
+
+        std::uint64_t p95 = 0;
+        if (samples) {
+            p95 = window.PercentileUsec(0.95);
+            _lastWaitP95Usec.store(p95, std::memory_order_relaxed);
+        }
+
+        const bool progressed = exec != prevExec;
+        prevExec = exec;
+        if (!hasPendingFor(kSharedGroup)) return;
+
+        // Projected wait of the current backlog (Little's law): queued tasks x
+        // mean run time / live workers. Catches a burst before its tail has
+        // started, which the sampled p95 only sees after the fact.
+        const unsigned live = static_cast<unsigned>(_workerCount.load(std::memory_order_acquire));
+        const double backlog = static_cast<double>(enq > exec ? enq - exec : 0);
+        const double ewma = ewmaN ? ewmaSum / static_cast<double>(ewmaN) : 0.0;
+        const double threshold = static_cast<double>(std::max(1u, _cfg.growWaitP95Usec));
+        const double projected = live ? backlog * ewma / live : 0.0;
+
+        // Grow on slow pickups, a backlog projected past the threshold, or
+        // queued work that saw no completion at all this window (every
+        // worker is stuck in a long task).
+        const bool slow = samples >= kMinWaitSamples && p95 > _cfg.growWaitP95Usec;
+        if (!slow && projected <= threshold && progressed) return;
+
+        std::lock_guard<std::mutex> lk(_resizeMx);
+        const unsigned liveNow = static_cast<unsigned>(_workerCount.load(std::memory_order_acquire));
+        const unsigned wanted = static_cast<unsigned>(std::min<double>(_maxWorkers, std::ceil(backlog * ewma / threshold)));
+        const unsigned target = std::min(_maxWorkers, std::max(liveNow + std::max(1u, liveNow / 2), wanted));
+        if (target <= liveNow) return;
 
-            {
-                std::lock_guard<std::mutex> lk(_mx);
-                switch (lane) {
-                case Lane::High:   ++_qHigh.execCount;   break;
-                case Lane::Normal: ++_qNormal.execCount; break;
-                case Lane::Low:    ++_qLow.execCount;    break;
-                case Lane::IO:     ++_qIO.execCount;     break;
-                default: break;
+        for (unsigned s = liveNow; s < target; ++s)
+            launchWorker(s);
+        _workerCount.store(target, std::memory_order_release);
+        _grows.fetch_add(target - liveNow, std::memory_order_relaxed);
+    }
+
+    void M4qXE::monitorLoop() {
+        std::uint64_t prevHist[kHistBuckets]{};
+        std::uint64_t prevExec = 0;
+
+        std::unique_lock<std::mutex> lk(_ctlMx);
+        while (!_stopping.load(std::memory_order_acquire)) {
+            _ctlCv.wait_for(lk, kControlPeriod, [this] { return _stopping.load(std::memory_order_acquire); });
+            if (_stopping.load(std::memory_order_acquire)) break;
+
+            lk.unlock();
+            adjustPoolSize(prevHist, prevExec);
+            lk.lock();
+        }
+    }
+
+    void M4qXE::destroyPending(bool run) {
+        // Workers are joined: every queue is ours, owner-side calls are safe.
+        Worker* sink = _workers.empty() ? nullptr : _workers.front().get();
+        // Dropped tasks still count as executed so pending counts stay exact.
+        auto dispose = [&](Node* n) {
+            if (run && sink) { runTask(*sink, n); return; }
+            const std::size_t li = static_cast<std::size_t>(n->lane);
+            n->fn.Reset();
+            n->cancel.reset();
+            if (sink) {
+                releaseNode(*sink, n);
+                sink->executed[li].store(sink->executed[li].load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+            else if (!n->pooled) delete n;
+        };
+        while (Node* n = takeDeadline())
+            dispose(n);
+        for (auto& w : _workers) {
+            for (std::size_t l = 0; l < kFifoLanes; ++l) {
+                while (Node* n = w->deques[l].Take())
+                    dispose(n);
+                // An inbox push counted before Stop() cleared _accepting may
+                // still be linking (or backing out); wait until it settles.
+                Inbox& box = w->inbox[l];
+                while (box.pushed.load(std::memory_order_seq_cst) != box.popped.load(std::memory_order_relaxed)) {
+                    if (Node* n = box.TryPop()) dispose(n);
+                    else std::this_thread::yield();
                 }
-                const double alpha = 0.1;
-                _ewmaUsec = (_ewmaUsec <= 0.0)
-                    ? static_cast<double>(usec)
-                    : (alpha * usec + (1.0 - alpha) * _ewmaUsec);
+            }
+        }
+        for (auto& w : _workers)
+            flushFreeNodes(*w);
+    }
 
-                if (!hasAnyPendingUnlocked()) {
-                    _cv.notify_all();
+    void M4qXE::workerLoop(unsigned workerIndex) {
+        t_self.pool = this;
+        t_self.index = workerIndex;
+        Worker& me = *_workers[workerIndex];
+        applyThreadSettings(workerIndex);
+
+        using clock = std::chrono::steady_clock;
+        const bool elastic = _minWorkers < _maxWorkers && me.group == kSharedGroup;
+        const auto linger = std::chrono::milliseconds(_cfg.lingerMs);
+
+        int idle = 0;
+        clock::time_point idleSince{};
+        for (;;) {
+            if (_stopping.load(std::memory_order_acquire) && !_cfg.drainOnStop) break;
+
+            if (Node* n = findWork(workerIndex)) {
+                runTask(me, n);
+                idle = 0;
+                idleSince = clock::time_point{};
+                continue;
+            }
+
+            if (_stopping.load(std::memory_order_acquire)) {
+                // Draining: leave once nothing is queued or running anywhere.
+                if (pendingTasks() == 0) break;
+                std::this_thread::yield();
+                continue;
+            }
+
+            // First miss after running something: a Flush() may be waiting on us.
+            if (idle++ == 0)
+                notifyFlush();
+            if (idle < kSpinPause) {
+                CpuRelax();
+                continue;
+            }
+            if (idle < kSpinYield) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (idleSince == clock::time_point{}) {
+                idleSince = clock::now();
+            }
+            else if (elastic && clock::now() - idleSince >= linger && tryRetire(workerIndex)) {
+                // The next-highest worker has likely lingered as long; let the
+                // idle ones re-check now instead of after their own timeout.
+                {
+                    std::lock_guard<std::mutex> lk(_parkMx);
+                    ++_wakeSeq;
                 }
+                _parkCv.notify_all();
+                break;
             }
+            flushFreeNodes(me);
+            park(workerIndex);
+            idle = 0;
         }
-        _cv.notify_all();
+
+        // Retiring or stopping: hand back both this worker's freed nodes and
+        // any batch it took as a producer, so resizing does not leak capacity.
+        flushFreeNodes(me);
+        _nodes.ReleaseThreadCache();
+        t_self = WorkerSelf{};
     }
 
 } // namespace MB
@@ -1,5 +1,6 @@
 ﻿// src/MBConfig.cpp
 #include "MBConfig.hpp"
+#include "MBFileWatch.hpp"
 #include "MBLog.hpp"
 #include "MirrorBladeOps.hpp"     // for MirrorBladeOps::Instance()
 #ifndef WIN32_LEAN_AND_MEAN
@@ -10,9 +11,13 @@
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
+#include <algorithm>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
+#include <map>
 #include <string>
+#include <vector>
 #include <mutex>
 #include <atomic>
 #include <thread>
@@ -43,14 +48,43 @@ namespace MB {
 
     namespace {
         // ---------------------------
-        // Globals (guarded by g_cfgMtx)
+        // Globals
         // ---------------------------
-        static Config        g_cfg;           // current in-memory config
-        static std::mutex    g_cfgMtx;
+        static Snapshot<Config> g_cfg;        // current config, published whole
 
         // Live-reload watcher
-        static std::thread       g_watchThr;
-        static std::atomic<bool> g_watchRun{ false };
+        static FileWatcher       g_watcher;
+
+        // Change handlers, and the snapshot they last saw
+        struct Handler {
+            int                      id;
+            std::vector<std::string> keys;   // JSON pointers
+            ConfigHandler            fn;
+        };
+        static std::mutex                    g_handlersMtx;
+        static std::vector<Handler>          g_handlers;       // guarded by g_handlersMtx
+        static int                           g_nextHandler = 1;
+        static std::mutex                    g_applyMtx;       // one apply at a time
+        static std::shared_ptr<const Config> g_applied;        // guarded by g_applyMtx
+
+        // config.set values not yet on disk, as a JSON merge patch (null
+        // removes). Replayed over every (re)load until written, so a reload
+        // cannot undo a set the file does not have yet.
+        static std::mutex                    g_overlayMtx;     // also orders sets against reloads
+        static json                          g_overlay = json::object();   // guarded by g_overlayMtx
+        static std::uint64_t                 g_overlayGen = 0; // guarded by g_overlayMtx; one per set
+
+        // Debounced writer: once sets have been quiet for kPersistQuiet, and
+        // at most kPersistMaxDelay after the first unsaved one.
+        constexpr std::chrono::milliseconds  kPersistQuiet{ 500 };
+        constexpr std::chrono::milliseconds  kPersistMaxDelay{ 5000 };
+        static std::mutex                    g_persistMtx;
+        static std::condition_variable       g_persistCv;
+        static std::thread                   g_persistThread;
+        static bool                          g_persistPending = false;   // guarded by g_persistMtx
+        static bool                          g_persistStop = false;      // guarded by g_persistMtx
+        static std::chrono::steady_clock::time_point g_persistFirst{};   // guarded by g_persistMtx
+        static std::chrono::steady_clock::time_point g_persistLast{};    // guarded by g_persistMtx
 
         // ---------------------------
         // Helpers
@@ -104,18 +138,66 @@ namespace MB {
             return true;
         }
 
-        // FILETIME helpers for cheap polling
-        static FILETIME GetFileTimeOrZero(const std::filesystem::path& p)
+        // ---------------------------
+        // Diff
+        // ---------------------------
+
+        // Leaves of the config's JSON form by JSON pointer
+        // ("/logging/retention/keep"); arrays count as one leaf.
+        static void Flatten(const json& j, std::string& path, std::map<std::string, json>& out)
+        {
+            if (!j.is_object()) { out.emplace(path, j); return; }
+            for (auto& [k, v] : j.items()) {
+                const size_t n = path.size();
+                path += '/';
+                for (char ch : k) {
+                    if (ch == '~') path += "~0";
+                    else if (ch == '/') path += "~1";
+                    else path += ch;
+                }
+                Flatten(v, path, out);
+                path.resize(n);
+            }
+        }
+
+        struct Change {
+            std::string path;
+            json        before;   // null: absent
+            json        after;
+        };
+
+        static std::vector<Change> Diff(const json& a, const json& b)
         {
-            WIN32_FILE_ATTRIBUTE_DATA fad{};
-            if (GetFileAttributesExW(p.c_str(), GetFileExInfoStandard, &fad))
-                return fad.ftLastWriteTime;
-            FILETIME z{}; z.dwLowDateTime = 0; z.dwHighDateTime = 0;
-            return z;
+            std::map<std::string, json> fa, fb;
+            std::string path;
+            Flatten(a, path, fa);
+            Flatten(b, path, fb);
+
+            std::vector<Change> out;
+            auto ia = fa.begin();
+            auto ib = fb.begin();
+            while (ia != fa.end() || ib != fb.end()) {
+                if (ib == fb.end() || (ia != fa.end() && ia->first < ib->first)) {
+                    out.push_back({ ia->first, ia->second, nullptr });
+                    ++ia;
+                }
+                else if (ia == fa.end() || ib->first < ia->first) {
+                    out.push_back({ ib->first, nullptr, ib->second });
+                    ++ib;
+                }
+                else {
+                    if (ia->second != ib->second) out.push_back({ ia->first, ia->second, ib->second });
+                    ++ia; ++ib;
+                }
+            }
+            return out;
         }
-        static bool FileTimeChanged(const FILETIME& a, const FILETIME& b)
+
+        // "/logging" covers "/logging/level"; "" covers everything.
+        static bool Covers(const std::string& key, const std::string& path)
         {
-            return a.dwLowDateTime != b.dwLowDateTime || a.dwHighDateTime != b.dwHighDateTime;
+            return path.compare(0, key.size(), key) == 0
+                && (path.size() == key.size() || path[key.size()] == '/');
         }
 
         // Map Config::LogLevel → MB::LogLevel
@@ -131,6 +213,89 @@ namespace MB {
             return MB::LogLevel::Info;
         }
 
+        // ---------------------------
+        // Change handlers
+        // ---------------------------
+
+        // One per subsystem, so a reload only re-applies what it touched.
+        // Caller holds g_handlersMtx.
+        static void InstallBuiltinsLocked()
+        {
+            auto add = [](std::vector<std::string> keys, ConfigHandler fn) {
+                g_handlers.push_back({ g_nextHandler++, std::move(keys), std::move(fn) });
+            };
+            add({ "/upscaler" }, [](const Config& c) {
+                if (auto* ops = MirrorBladeOps::Instance()) ops->EnableUpscaler(c.upscaler.load());
+            });
+            add({ "/trafficBoost" }, [](const Config& c) {
+                if (auto* ops = MirrorBladeOps::Instance()) ops->SetTrafficBoost(c.traffic.load());
+            });
+            add({ "/logging/level", "/logging/modules" }, [](const Config& c) {
+                MB::Log().SetLevel(ToLoggerLevel(c.logLevel.load()));
+                for (int i = 0; i < Config::kLogModules; ++i) {
+                    const auto m = static_cast<MB::LogModule>(i);
+                    const int ml = c.logModuleLevel[i].load();
+                    if (ml >= 0) MB::Log().SetModuleLevel(m, static_cast<MB::LogLevel>(ml));
+                    else MB::Log().ClearModuleLevel(m);
+                }
+            });
+            add({ "/logging/format" }, [](const Config& c) {
+                MB::Log().SetFormat(c.logBinary.load() ? MB::LogFormat::Binary : MB::LogFormat::Text);
+            });
+            add({ "/logging/retention" }, [](const Config& c) {
+                MB::Logger::Retention ret;
+                ret.keep = c.logKeep.load();
+                ret.maxTotalBytes = static_cast<std::uint64_t>(c.logMaxTotalMB.load()) * 1024 * 1024;
+                ret.maxAge = std::chrono::hours(24 * c.logMaxAgeDays.load());
+                ret.compress = c.logCompress.load();
+                MB::Log().SetRetention(ret);
+            });
+            add({ "/logging/flight" }, [](const Config& c) {
+                MB::SetFlightRecorder(c.flightEnabled.load(), static_cast<MB::LogLevel>(c.flightLevel.load()));
+            });
+            add({ "/watch/coalesceMs" }, [](const Config& c) {
+                g_watcher.SetCoalesce(std::chrono::milliseconds(c.watchCoalesceMs.load()));
+            });
+            // ipc.* and watch.mode take effect on the next start.
+        }
+
+        static std::vector<Handler> Handlers()
+        {
+            static bool installed = false;
+            std::scoped_lock lk{ g_handlersMtx };
+            if (!installed) {
+                InstallBuiltinsLocked();
+                installed = true;
+            }
+            return g_handlers;
+        }
+
+        static bool Handles(const Handler& h, const std::string& path)
+        {
+            return std::any_of(h.keys.begin(), h.keys.end(), [&](const std::string& k) { return Covers(k, path); });
+        }
+
+        // Runs the handlers covering any of `changes` (all of them when null);
+        // returns how many ran.
+        static int RunHandlers(const std::vector<Handler>& handlers, const Config& c, const std::vector<Change>* changes)
+        {
+            int ran = 0;
+            for (const auto& h : handlers) {
+                if (changes && std::none_of(changes->begin(), changes->end(),
+                    [&](const Change& ch) { return Handles(h, ch.path); }))
+                    continue;
+                try { h.fn(c); }
+                catch (const std::exception& e) {
+                    MB::Log().Log(MB::LogLevel::Warn, "Config: handler for %s threw: %s", h.keys.front().c_str(), e.what());
+                }
+                catch (...) {
+                    MB::Log().Log(MB::LogLevel::Warn, "Config: handler for %s threw", h.keys.front().c_str());
+                }
+                ++ran;
+            }
+            return ran;
+        }
+
     } // anonymous namespace
 
     // ---------------------------
@@ -152,6 +317,63 @@ namespace MB {
         return Config::LogLevel::Info;
     }
 
+    // Fields present in `j` (the file's JSON form) onto c; throws
+    // nlohmann::json::exception on a value of the wrong type.
+    static void ReadTree(const json& j, Config& c)
+    {
+        // version (optional)
+        const int version = j.value("version", 1);
+        (void)version;
+
+        // core
+        c.upscaler.store(j.value("upscaler", c.upscaler.load()));
+        c.traffic.store(clampf(j.value("trafficBoost", c.traffic.load()), 0.10f, 50.0f));
+
+        // ipc
+        if (auto it = j.find("ipc"); it != j.end() && it->is_object()) {
+            c.ipcEnabled.store(it->value("enabled", c.ipcEnabled.load()));
+            const std::string pn = it->value("pipeName", std::string(c.ipcPipeName.begin(), c.ipcPipeName.end()));
+            c.ipcPipeName = std::wstring(pn.begin(), pn.end());
+        }
+
+        // logging
+        if (auto it = j.find("logging"); it != j.end() && it->is_object()) {
+            c.logLevel.store(ParseLogLevel(it->value("level", "info")));
+            c.logBinary.store(it->value("format", std::string("text")) == "binary");
+            if (auto mods = it->find("modules"); mods != it->end() && mods->is_object()) {
+                for (auto& kv : mods->items()) {
+                    MB::LogModule m{};
+                    MB::LogLevel l{};
+                    if (kv.value().is_string() && MB::LogModuleFromName(kv.key(), m)
+                        && MB::LogLevelFromName(kv.value().get<std::string>(), l))
+                        c.logModuleLevel[static_cast<int>(m)].store(static_cast<int>(l));
+                    else
+                        MB::Log().Log(MB::LogLevel::Warn, "Config: ignoring logging.modules.%s", kv.key().c_str());
+                }
+            }
+            if (auto ret = it->find("retention"); ret != it->end() && ret->is_object()) {
+                c.logKeep.store((std::max)(0, ret->value("keep", c.logKeep.load())));
+                c.logMaxTotalMB.store((std::max)(0, ret->value("maxTotalMB", c.logMaxTotalMB.load())));
+                c.logMaxAgeDays.store((std::max)(0, ret->value("maxAgeDays", c.logMaxAgeDays.load())));
+                c.logCompress.store(ret->value("compress", c.logCompress.load()));
+            }
+            if (auto fl = it->find("flight"); fl != it->end() && fl->is_object()) {
+                c.flightEnabled.store(fl->value("enabled", c.flightEnabled.load()));
+                MB::LogLevel l{};
+                if (MB::LogLevelFromName(fl->value("level", std::string("debug")), l))
+                    c.flightLevel.store(static_cast<int>(l));
+                else
+                    MB::Log().Log(MB::LogLevel::Warn, "Config: ignoring logging.flight.level");
+            }
+        }
+
+        // watch (hot reload); mode takes effect on the next start
+        if (auto it = j.find("watch"); it != j.end() && it->is_object()) {
+            c.watchPoll.store(it->value("mode", std::string("auto")) == "poll");
+            c.watchCoalesceMs.store(std::clamp(it->value("coalesceMs", c.watchCoalesceMs.load()), 0, 10000));
+        }
+    }
+
     Config Config::LoadFromFile(const std::filesystem::path& path)
     {
         json j;
@@ -185,26 +407,7 @@ namespace MB {
             }
 
             json j; f >> j;
-
-            // version (optional)
-            const int version = j.value("version", 1);
-            (void)version;
-
-            // core
-            c.upscaler.store(j.value("upscaler", c.upscaler.load()));
-            c.traffic.store(clampf(j.value("trafficBoost", c.traffic.load()), 0.10f, 50.0f));
-
-            // ipc
-            if (auto it = j.find("ipc"); it != j.end() && it->is_object()) {
-                c.ipcEnabled.store(it->value("enabled", c.ipcEnabled.load()));
-                const std::string pn = it->value("pipeName", std::string(c.ipcPipeName.begin(), c.ipcPipeName.end()));
-                c.ipcPipeName = std::wstring(pn.begin(), pn.end());
-            }
-
-            // logging
-            if (auto it = j.find("logging"); it != j.end() && it->is_object()) {
-                c.logLevel.store(ParseLogLevel(it->value("level", "info")));
-            }
+            ReadTree(j, c);
 
             MB::Log().Log(MB::LogLevel::Info, "Config loaded: upscaler=%d, traffic=%.2f, ipc=%d",
                 c.upscaler.load() ? 1 : 0, c.traffic.load(), c.ipcEnabled.load() ? 1 : 0);
@@ -220,65 +423,295 @@ namespace MB {
         return c;
     }
 
-    std::string Config::ToJSON() const
+    // The config as written to disk; also the shape change handlers are keyed by.
+    static json ToTree(const Config& c)
     {
         json j;
         j["version"] = 1;
-        j["upscaler"] = upscaler.load();
-        j["trafficBoost"] = traffic.load();
+        j["upscaler"] = c.upscaler.load();
+        j["trafficBoost"] = c.traffic.load();
         j["ipc"] = {
-          {"enabled", ipcEnabled.load()},
-          {"pipeName", WStringToUtf8(ipcPipeName)}  // was std::string(ipcPipeName.begin(), ipcPipeName.end())
+          {"enabled", c.ipcEnabled.load()},
+          {"pipeName", WStringToUtf8(c.ipcPipeName)}  // was std::string(ipcPipeName.begin(), ipcPipeName.end())
         };
 
         j["ipc"] = {
-            {"enabled",  ipcEnabled.load()},
-            {"pipeName", std::string(ipcPipeName.begin(), ipcPipeName.end())}
+            {"enabled",  c.ipcEnabled.load()},
+            {"pipeName", std::string(c.ipcPipeName.begin(), c.ipcPipeName.end())}
         };
 
         const char* lvl = "info";
-        switch (logLevel.load()) {
-        case LogLevel::Trace: lvl = "trace"; break;
-        case LogLevel::Debug: lvl = "debug"; break;
-        case LogLevel::Info:  lvl = "info";  break;
-        case LogLevel::Warn:  lvl = "warn";  break;
-        case LogLevel::Error: lvl = "error"; break;
+        switch (c.logLevel.load()) {
+        case Config::LogLevel::Trace: lvl = "trace"; break;
+        case Config::LogLevel::Debug: lvl = "debug"; break;
+        case Config::LogLevel::Info:  lvl = "info";  break;
+        case Config::LogLevel::Warn:  lvl = "warn";  break;
+        case Config::LogLevel::Error: lvl = "error"; break;
         }
-        j["logging"] = { {"level", lvl} };
+        j["logging"] = { {"level", lvl}, {"format", c.logBinary.load() ? "binary" : "text"} };
+
+        json mods = json::object();
+        for (int i = 0; i < Config::kLogModules; ++i) {
+            const int ml = c.logModuleLevel[i].load();
+            if (ml >= 0)
+                mods[MB::LogModuleName(static_cast<MB::LogModule>(i))] = MB::LogLevelName(static_cast<MB::LogLevel>(ml));
+        }
+        if (!mods.empty()) j["logging"]["modules"] = std::move(mods);
+        j["logging"]["retention"] = {
+            {"keep", c.logKeep.load()},
+            {"maxTotalMB", c.logMaxTotalMB.load()},
+            {"maxAgeDays", c.logMaxAgeDays.load()},
+            {"compress", c.logCompress.load()}
+        };
+        j["watch"] = {
+            {"mode", c.watchPoll.load() ? "poll" : "auto"},
+            {"coalesceMs", c.watchCoalesceMs.load()}
+        };
+        j["logging"]["flight"] = {
+            {"enabled", c.flightEnabled.load()},
+            {"level", MB::LogLevelName(static_cast<MB::LogLevel>(c.flightLevel.load()))}
+        };
 
-        return j.dump(2);
+        return j;
     }
 
-    void Config::ApplyRuntime()
+    std::string Config::ToJSON() const
     {
-        // Push into ops
-        if (auto* ops = MirrorBladeOps::Instance()) {
-            ops->EnableUpscaler(upscaler.load());
-            ops->SetTrafficBoost(traffic.load());
-        }
+        return ToTree(*this).dump(2);
+    }
 
-        // Apply log level immediately
-        MB::Log().SetLevel(ToLoggerLevel(logLevel.load()));
+    void Config::ApplyRuntime()
+    {
+        // Every handler, changed or not
+        RunHandlers(Handlers(), *this, nullptr);
 
         // If you manage IPC lifetime/dynamic rename, do it here based on ipcEnabled/ipcPipeName.
         MB::Log().Log(MB::LogLevel::Debug, "Runtime applied: upscaler=%d, traffic=%.2f, loglevel=%d",
             upscaler.load() ? 1 : 0, traffic.load(), static_cast<int>(logLevel.load()));
     }
 
+    // ---------------------------
+    // Overlay and persistence
+    // ---------------------------
+
+    static void ApplyConfigLogged(MB::LogLevel detail);
+
+    // merge_patch, but nulls are kept: in the overlay they are removals
+    // still to replay.
+    static void MergeKeepNulls(json& dst, const json& src)
+    {
+        if (!src.is_object() || !dst.is_object()) { dst = src; return; }
+        for (auto& [k, v] : src.items()) MergeKeepNulls(dst[k], v);
+    }
+
+    // A freshly loaded config with the unsaved sets on top.
+    // Caller holds g_overlayMtx.
+    static Config WithOverlayLocked(Config c)
+    {
+        if (g_overlay.empty()) return c;
+        json tree = ToTree(c);
+        tree.merge_patch(g_overlay);
+        Config out;
+        ReadTree(tree, out);
+        return out;
+    }
+
+    // Writes the current snapshot. The overlay is dropped only if no set
+    // came in meanwhile; otherwise the write that set scheduled covers it.
+    static bool PersistNow()
+    {
+        std::shared_ptr<const Config> cur;
+        std::uint64_t gen = 0;
+        {
+            std::scoped_lock lk{ g_overlayMtx };
+            cur = g_cfg.Load();
+            gen = g_overlayGen;
+        }
+        const auto path = Config::ResolveConfigPath();
+        const bool ok = AtomicWriteUTF8(path, cur->ToJSON());
+        if (ok) {
+            std::scoped_lock lk{ g_overlayMtx };
+            if (gen == g_overlayGen) g_overlay = json::object();
+        }
+        MB::Log().Log(ok ? MB::LogLevel::Info : MB::LogLevel::Error,
+            ok ? "Config saved to %ls" : "Config save FAILED to %ls",
+            path.c_str());
+        return ok;
+    }
+
+    static void SchedulePersist()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        {
+            std::scoped_lock lk{ g_persistMtx };
+            if (!g_persistPending) g_persistFirst = now;
+            g_persistPending = true;
+            g_persistLast = now;
+        }
+        g_persistCv.notify_one();
+    }
+
+    // The config's own writer thread (a plain std::thread, not M4qXE's IO
+    // lane or AsyncIO): sleeps until a write is due, then writes.
+    static void PersistLoop()
+    {
+        std::unique_lock lk{ g_persistMtx };
+        while (!g_persistStop) {
+            if (!g_persistPending) { g_persistCv.wait(lk); continue; }
+            const auto due = (std::min)(g_persistLast + kPersistQuiet, g_persistFirst + kPersistMaxDelay);
+            if (std::chrono::steady_clock::now() < due) { g_persistCv.wait_until(lk, due); continue; }
+            g_persistPending = false;
+            lk.unlock();
+            PersistNow();
+            lk.lock();
+        }
+    }
+
     // ---------------------------
     // Global getters/setters
     // ---------------------------
 
-    const Config& GetConfig()
+    std::shared_ptr<const Config> ConfigSnapshot()
+    {
+        return g_cfg.Load();
+    }
+
+    Snapshot<Config>::Reader ConfigReader()
+    {
+        return Snapshot<Config>::Reader{ g_cfg };
+    }
+
+    Config GetConfig()
     {
-        std::scoped_lock lk{ g_cfgMtx };
-        return g_cfg;
+        return *g_cfg.Load();
     }
 
     void SetConfig(const Config& c)
     {
-        std::scoped_lock lk{ g_cfgMtx };
-        g_cfg = c;
+        g_cfg.Publish(c);
+    }
+
+    std::shared_ptr<const Config> UpdateConfig(const std::function<void(Config&)>& edit)
+    {
+        return g_cfg.Update(edit);
+    }
+
+    bool GetConfigValue(const std::string& pointer, std::string& valueJson)
+    {
+        try {
+            const json tree = ToTree(*g_cfg.Load());
+            const json::json_pointer p(pointer);
+            if (!tree.contains(p)) return false;
+            valueJson = tree.at(p).dump();
+            return true;
+        }
+        catch (const json::exception&) {
+            return false;   // malformed pointer
+        }
+    }
+
+    bool SetConfigValue(const std::string& pointer, const std::string& valueJson, std::string& effective, std::string& error)
+    {
+        json patch;
+        json value;
+        json::json_pointer p;
+        try {
+            p = json::json_pointer(pointer);
+            value = json::parse(valueJson);
+        }
+        catch (const json::exception& e) {
+            error = e.what();
+            return false;
+        }
+        if (p.empty()) { error = "pointer must name a key"; return false; }
+        patch[p] = value;
+
+        {
+            std::scoped_lock lk{ g_overlayMtx };
+            json tree = ToTree(*g_cfg.Load());
+            tree.merge_patch(patch);
+            Config next;
+            try { ReadTree(tree, next); }
+            catch (const json::exception&) { error = "wrong type"; return false; }
+
+            // Whatever the file form does not keep was not a setting (or not
+            // a valid value for one); null must have removed it.
+            const json now = ToTree(next);
+            if (value.is_null() ? now.contains(p) : !now.contains(p)) {
+                error = value.is_null() ? "cannot be removed" : "unknown key or invalid value";
+                return false;
+            }
+            effective = value.is_null() ? "null" : now.at(p).dump();   // after clamping
+            MergeKeepNulls(g_overlay, patch);
+            ++g_overlayGen;
+            g_cfg.Publish(std::move(next));
+        }
+        ApplyConfigLogged(MB::LogLevel::Debug);
+        SchedulePersist();
+        return true;
+    }
+
+    // ---------------------------
+    // Change handlers
+    // ---------------------------
+
+    int OnConfigChange(std::vector<std::string> keys, ConfigHandler fn)
+    {
+        Handlers();   // built-ins first
+        std::scoped_lock lk{ g_handlersMtx };
+        const int id = g_nextHandler++;
+        g_handlers.push_back({ id, std::move(keys), std::move(fn) });
+        return id;
+    }
+
+    void RemoveConfigHandler(int id)
+    {
+        std::scoped_lock lk{ g_handlersMtx };
+        g_handlers.erase(std::remove_if(g_handlers.begin(), g_handlers.end(),
+            [id](const Handler& h) { return h.id == id; }), g_handlers.end());
+    }
+
+    // `detail`: level of the per-change lines and summary (config.set sends
+    // a stream of them from UI sliders; those go to Debug).
+    static void ApplyConfigLogged(MB::LogLevel detail)
+    {
+        std::scoped_lock lk{ g_applyMtx };
+        const auto now = g_cfg.Load();
+        const auto handlers = Handlers();
+        const auto t0 = std::chrono::steady_clock::now();
+        auto elapsedMs = [&t0] {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        };
+
+        if (!g_applied) {
+            const int ran = RunHandlers(handlers, *now, nullptr);
+            g_applied = now;
+            MB::Log().Log(MB::LogLevel::Info, "Config applied: all %d handler(s) in %.2f ms", ran, elapsedMs());
+            return;
+        }
+        if (g_applied == now) return;
+
+        const auto changes = Diff(ToTree(*g_applied), ToTree(*now));
+        g_applied = now;
+        if (changes.empty()) {
+            MB::Log().Log(MB::LogLevel::Debug, "Config applied: no changes");
+            return;
+        }
+        for (const auto& ch : changes) {
+            const bool live = std::any_of(handlers.begin(), handlers.end(), [&](const Handler& h) { return Handles(h, ch.path); });
+            MB::Log().Log(detail, "Config: %s %s -> %s%s", ch.path.c_str(),
+                ch.before.is_null() ? "(unset)" : ch.before.dump().c_str(),
+                ch.after.is_null() ? "(unset)" : ch.after.dump().c_str(),
+                live ? "" : " (takes effect on restart)");
+        }
+        const int ran = RunHandlers(handlers, *now, &changes);
+        MB::Log().Log(detail, "Config applied: %zu key(s) changed, %d handler(s) in %.2f ms",
+            changes.size(), ran, elapsedMs());
+    }
+
+    void ApplyConfig()
+    {
+        ApplyConfigLogged(MB::LogLevel::Info);
     }
 
     // ---------------------------
@@ -290,90 +723,84 @@ namespace MB {
         const auto path = Config::ResolveConfigPath();
         Config c = Config::LoadFromFile(path);
         {
-            std::scoped_lock lk{ g_cfgMtx };
-            g_cfg = c;
+            std::scoped_lock lk{ g_overlayMtx };
+            g_cfg.Publish(WithOverlayLocked(std::move(c)));
         }
-        c.ApplyRuntime();
+        ApplyConfig();
         MB::Log().Log(MB::LogLevel::Info, "Config reloaded");
         return true;
     }
 
     bool SaveConfig()
     {
-        std::string jsonStr;
         {
-            std::scoped_lock lk{ g_cfgMtx };
-            jsonStr = g_cfg.ToJSON();
+            std::scoped_lock lk{ g_persistMtx };
+            g_persistPending = false;   // this write covers it
         }
-        const auto path = Config::ResolveConfigPath();
-        const bool ok = AtomicWriteUTF8(path, jsonStr);
-        MB::Log().Log(ok ? MB::LogLevel::Info : MB::LogLevel::Error,
-            ok ? "Config saved to %ls" : "Config save FAILED to %ls",
-            path.c_str());
-        return ok;
+        return PersistNow();
     }
 
     void InitConfig()
     {
         const auto path = Config::ResolveConfigPath();
 
-        // Initial load
+        // Initial load (the first apply runs every handler)
+        g_cfg.Publish(Config::LoadFromFile(path));
+        ApplyConfig();
+
+        // Start file watcher (change notifications, polling as a fallback;
+        // reloads once the file has been quiet for watch.coalesceMs)
+        FileWatcher::Options opt;
         {
-            Config c = Config::LoadFromFile(path);
-            {
-                std::scoped_lock lk{ g_cfgMtx };
-                g_cfg = c;
-            }
-            c.ApplyRuntime();
+            const auto cur = g_cfg.Load();
+            opt.backend = cur->watchPoll.load() ? FileWatcher::Backend::Poll : FileWatcher::Backend::Auto;
+            opt.coalesce = std::chrono::milliseconds(cur->watchCoalesceMs.load());
         }
-
-        // Start file watcher (timestamp polling + debounce)
-        g_watchRun = true;
-        g_watchThr = std::thread([path] {
-            FILETIME last = GetFileTimeOrZero(path);
-            FILETIME stableProbe = last;
-            int stableTicks = 0;
-
-            while (g_watchRun.load(std::memory_order_relaxed)) {
-                ::Sleep(250); // poll interval
-                const FILETIME now = GetFileTimeOrZero(path);
-
-                if (FileTimeChanged(now, stableProbe)) {
-                    // observed change; begin/continue debounce
-                    stableProbe = now;
-                    stableTicks = 0;
-                }
-                else if (FileTimeChanged(now, last)) {
-                    // no further change since last probe → count toward stability
-                    if (++stableTicks >= 4) { // ~1s stable
-                        last = now;
-                        stableTicks = 0;
-
-                        try {
-                            Config c = Config::LoadFromFile(path);
-                            {
-                                std::scoped_lock lk{ g_cfgMtx };
-                                g_cfg = c;
-                            }
-                            c.ApplyRuntime();
-                            MB::Log().Log(MB::LogLevel::Info, "Config auto-reloaded");
-                        }
-                        catch (...) {
-                            MB::Log().Log(MB::LogLevel::Warn, "Config auto-reload failed");
-                        }
-                    }
+        g_watcher.Start(path, [path] {
+            try {
+                Config c = Config::LoadFromFile(path);
+                {
+                    std::scoped_lock lk{ g_overlayMtx };
+                    g_cfg.Publish(WithOverlayLocked(std::move(c)));
                 }
+                ApplyConfig();
+                MB::Log().Log(MB::LogLevel::Info, "Config auto-reloaded");
             }
-            });
+            catch (...) {
+                MB::Log().Log(MB::LogLevel::Warn, "Config auto-reload failed");
+            }
+            }, opt);
+
+        // Debounced writes for config.set
+        {
+            std::scoped_lock lk{ g_persistMtx };
+            g_persistStop = false;
+        }
+        if (!g_persistThread.joinable()) g_persistThread = std::thread(PersistLoop);
 
-        MB::Log().Log(MB::LogLevel::Info, "Config initialized (watching %ls)", path.c_str());
+        MB::Log().Log(MB::LogLevel::Info, "Config initialized (watching %ls, %s)", path.c_str(),
+            g_watcher.ActiveBackend() == FileWatcher::Backend::Native ? "change notifications" : "polling");
     }
 
     void ShutdownConfig()
     {
-        g_watchRun = false;
-        if (g_watchThr.joinable())
-            g_watchThr.join();
+        g_watcher.Stop();
+
+        // Stop the writer, then write whatever it had not got to yet.
+        {
+            std::scoped_lock lk{ g_persistMtx };
+            g_persistStop = true;
+            g_persistPending = false;
+        }
+        g_persistCv.notify_all();
+        if (g_persistThread.joinable()) g_persistThread.join();
+        bool dirty = false;
+        {
+            std::scoped_lock lk{ g_overlayMtx };
+            dirty = !g_overlay.empty();
+        }
+        if (dirty) PersistNow();
+
         MB::Log().Log(MB::LogLevel::Info, "Config shutdown");
     }
 
@@ -0,0 +1,209 @@
+// src/MBCoro.cpp
+#include "MBCoro.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if __has_include("MBLog.hpp")
+#include "MBLog.hpp"
+#define MBLOGE(fmt, ...) MB::Log().Log(MB::LogLevel::Error, fmt, __VA_ARGS__)
+#else
+#define MBLOGE(...) (void)0
+#endif
+
+namespace MB {
+
+    namespace {
+        // ---------- Frame pool ----------
+        constexpr std::size_t kMinClassShift = 7;                 // 128 B
+        constexpr std::size_t kClasses = 6;                       // 128 B .. 4 KB
+        constexpr std::size_t kMaxFrame = std::size_t(1) << (kMinClassShift + kClasses - 1);
+        constexpr std::size_t kSlabBytes = 64 * 1024;
+        constexpr std::size_t kBatch = 32;                        // blocks per exchange with the shared list
+        constexpr std::size_t kCacheCap = 2 * kBatch;             // per thread, per class
+
+        struct FreeBlock { FreeBlock* next; };
+
+        inline std::size_t ClassOf(std::size_t size) noexcept {
+            std::size_t c = 0;
+            while ((std::size_t(1) << (kMinClassShift + c)) < size) ++c;
+            return c;
+        }
+        inline std::size_t ClassBytes(std::size_t c) noexcept {
+            return std::size_t(1) << (kMinClassShift + c);
+        }
+
+        // Shared free lists. Never destroyed: frames freed by exiting threads or
+        // during static destruction still have somewhere to go.
+        struct Central {
+            std::mutex  mx;
+            FreeBlock*  head[kClasses]{};
+            std::size_t count[kClasses]{};
+            std::vector<void*> slabs;
+        };
+        Central& Shared() {
+            static Central* c = new Central();
+            return *c;
+        }
+
+        std::atomic<std::uint64_t> g_heapFrames{ 0 };
+        std::atomic<std::uint64_t> g_slabBytes{ 0 };
+
+        // Detach up to n blocks from the front of list; returns the detached chain.
+        FreeBlock* TakeChain(FreeBlock*& list, std::size_t& count, std::size_t n, std::size_t& taken) noexcept {
+            FreeBlock* first = list;
+            FreeBlock* last = nullptr;
+            taken = 0;
+            for (FreeBlock* b = list; b && taken < n; b = b->next) {
+                last = b;
+                ++taken;
+            }
+            if (!last) return nullptr;
+            list = last->next;
+            last->next = nullptr;
+            count -= taken;
+            return first;
+        }
+
+        struct ThreadCache {
+            FreeBlock*  head[kClasses]{};
+            std::size_t count[kClasses]{};
+
+            void refill(std::size_t c) {
+                Central& sh = Shared();
+                std::lock_guard<std::mutex> lk(sh.mx);
+                if (!sh.head[c]) {
+                    // Carve a fresh slab; the first batch comes here, the rest is shared.
+                    auto* slab = static_cast<unsigned char*>(::operator new(kSlabBytes));
+                    sh.slabs.push_back(slab);
+                    g_slabBytes.fetch_add(kSlabBytes, std::memory_order_relaxed);
+
+                    const std::size_t bytes = ClassBytes(c);
+                    const std::size_t n = kSlabBytes / bytes;
+                    for (std::size_t i = n; i-- > 0; ) {
+                        auto* b = reinterpret_cast<FreeBlock*>(slab + i * bytes);
+                        b->next = sh.head[c];
+                        sh.head[c] = b;
+                    }
+                    sh.count[c] += n;
+                }
+                std::size_t taken = 0;
+                head[c] = TakeChain(sh.head[c], sh.count[c], kBatch, taken);
+                count[c] = taken;
+            }
+
+            void flush(std::size_t c, std::size_t n) noexcept {
+                std::size_t taken = 0;
+                FreeBlock* chain = TakeChain(head[c], count[c], n, taken);
+                if (!chain) return;
+                FreeBlock* last = chain;
+                while (last->next) last = last->next;
+
+                Central& sh = Shared();
+                std::lock_guard<std::mutex> lk(sh.mx);
+                last->next = sh.head[c];
+                sh.head[c] = chain;
+                sh.count[c] += taken;
+            }
+
+            ~ThreadCache() {
+                for (std::size_t c = 0; c < kClasses; ++c)
+                    flush(c, count[c]);
+            }
+        };
+        thread_local ThreadCache t_frames;
+
+        // ---------- Game-thread hooks ----------
+        std::atomic<void (*)(std::coroutine_handle<>)>                g_post{ nullptr };
+        std::atomic<void (*)(std::coroutine_handle<>, std::uint32_t)> g_postAfter{ nullptr };
+
+        [[noreturn]] void ThrowUnbound() {
+            throw std::runtime_error("MB coroutine: game-thread hooks not installed");
+        }
+    }
+
+    namespace CoroDetail {
+        void* AllocFrame(std::size_t size) {
+            if (size > kMaxFrame) {
+                g_heapFrames.fetch_add(1, std::memory_order_relaxed);
+                return ::operator new(size);
+            }
+            const std::size_t c = ClassOf(size);
+            ThreadCache& tc = t_frames;
+            if (!tc.head[c]) tc.refill(c);
+
+            FreeBlock* b = tc.head[c];
+            tc.head[c] = b->next;
+            --tc.count[c];
+            return b;
+        }
+
+        void FreeFrame(void* p, std::size_t size) noexcept {
+            if (!p) return;
+            if (size > kMaxFrame) {
+                ::operator delete(p);
+                return;
+            }
+            const std::size_t c = ClassOf(size);
+            ThreadCache& tc = t_frames;
+            auto* b = static_cast<FreeBlock*>(p);
+            b->next = tc.head[c];
+            tc.head[c] = b;
+            if (++tc.count[c] > kCacheCap)
+                tc.flush(c, kBatch);
+        }
+
+        void ReportDetachedError(std::exception_ptr error) noexcept {
+            try { std::rethrow_exception(error); }
+            catch (const std::exception& e) { MBLOGE("[coro] detached task failed: %s", e.what()); }
+            catch (...) { MBLOGE("[coro] detached task failed: %s", "unknown exception"); }
+        }
+    }
+
+    // ---------- Game-thread awaitables ----------
+
+    void SetGameThreadHooks(const GameThreadHooks& hooks) noexcept {
+        g_post.store(hooks.post, std::memory_order_release);
+        g_postAfter.store(hooks.postAfter, std::memory_order_release);
+    }
+
+    // The hook may resume h on the game thread before it returns, so nothing
+    // in the awaiter is touched after a successful post.
+    bool NextTickAwaiter::await_suspend(std::coroutine_handle<> h) {
+        auto post = g_post.load(std::memory_order_acquire);
+        if (!post) {
+            unbound = true;
+            return false;
+        }
+        post(h);
+        return true;
+    }
+
+    void NextTickAwaiter::await_resume() const {
+        if (unbound) ThrowUnbound();
+    }
+
+    bool DelayAwaiter::await_suspend(std::coroutine_handle<> h) {
+        auto postAfter = g_postAfter.load(std::memory_order_acquire);
+        if (!postAfter) {
+            unbound = true;
+            return false;
+        }
+        postAfter(h, ms);
+        return true;
+    }
+
+    void DelayAwaiter::await_resume() const {
+        if (unbound) ThrowUnbound();
+    }
+
+    CoroStats GetCoroStats() noexcept {
+        CoroStats s;
+        s.heapFrames = g_heapFrames.load(std::memory_order_relaxed);
+        s.slabBytes = g_slabBytes.load(std::memory_order_relaxed);
+        return s;
+    }
+
+} // namespace MB
@@ -0,0 +1,461 @@
+// src/MBDeflate.cpp
+#include "MBDeflate.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace MB::Deflate {
+
+    namespace {
+        // ---------- Shared tables (RFC 1951 3.2.5) ----------
+
+        constexpr std::uint16_t kLenBase[29] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        constexpr std::uint8_t kLenExtra[29] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        constexpr std::uint16_t kDistBase[30] = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        constexpr std::uint8_t kDistExtra[30] = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        constexpr std::size_t kWindow = 32768;
+        constexpr std::size_t kMinMatch = 3;
+        constexpr std::size_t kMaxMatch = 258;
+        constexpr std::size_t kLazyLimit = 32;
+
+        const std::array<std::uint32_t, 256>& CrcTable() {
+            static const std::array<std::uint32_t, 256> table = [] {
+                std::array<std::uint32_t, 256> t{};
+                for (std::uint32_t i = 0; i < 256; ++i) {
+                    std::uint32_t c = i;
+                    for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    t[i] = c;
+                }
+                return t;
+            }();
+            return table;
+        }
+
+        void PutLE32(std::string& out, std::uint32_t v) {
+            for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+        }
+
+        // ---------- Compressor ----------
+
+        class BitWriter {
+        public:
+            explicit BitWriter(std::string& out) : _out(out) {}
+
+            void Put(std::uint32_t value, unsigned bits) {
+                _acc |= static_cast<std::uint64_t>(value) << _bits;
+                _bits += bits;
+                while (_bits >= 8) {
+                    _out.push_back(static_cast<char>(_acc & 0xFF));
+                    _acc >>= 8;
+                    _bits -= 8;
+                }
+            }
+
+            // Huffman codes go out most significant bit first.
+            void PutCode(std::uint32_t code, unsigned len) {
+                std::uint32_t rev = 0;
+                for (unsigned i = 0; i < len; ++i) rev |= ((code >> i) & 1u) << (len - 1 - i);
+                Put(rev, len);
+            }
+
+            void Finish() {
+                if (_bits) _out.push_back(static_cast<char>(_acc & 0xFF));
+                _acc = 0;
+                _bits = 0;
+            }
+
+        private:
+            std::string&  _out;
+            std::uint64_t _acc{ 0 };
+            unsigned      _bits{ 0 };
+        };
+
+        // Fixed literal/length code (RFC 1951 3.2.6).
+        void PutLitLen(BitWriter& bw, unsigned sym) {
+            if (sym < 144)      bw.PutCode(0x30 + sym, 8);
+            else if (sym < 256) bw.PutCode(0x190 + (sym - 144), 9);
+            else if (sym < 280) bw.PutCode(sym - 256, 7);
+            else                bw.PutCode(0xC0 + (sym - 280), 8);
+        }
+
+        void PutMatch(BitWriter& bw, std::size_t len, std::size_t dist) {
+            const unsigned li = static_cast<unsigned>(
+                std::upper_bound(std::begin(kLenBase), std::end(kLenBase), len) - std::begin(kLenBase) - 1);
+            PutLitLen(bw, 257 + li);
+            if (kLenExtra[li]) bw.Put(static_cast<std::uint32_t>(len - kLenBase[li]), kLenExtra[li]);
+
+            const unsigned di = static_cast<unsigned>(
+                std::upper_bound(std::begin(kDistBase), std::end(kDistBase), dist) - std::begin(kDistBase) - 1);
+            bw.PutCode(di, 5);
+            if (kDistExtra[di]) bw.Put(static_cast<std::uint32_t>(dist - kDistBase[di]), kDistExtra[di]);
+        }
+
+        class Matcher {
+        public:
+            Matcher(const unsigned char* data, std::size_t n, unsigned maxChain)
+                : _p(data), _n(n), _maxChain(maxChain), _head(kHashSize, -1), _prev(kWindow, -1) {}
+
+            void Insert(std::size_t i) {
+                if (i + kMinMatch > _n) return;
+                const std::uint32_t h = hash(i);
+                _prev[i & (kWindow - 1)] = _head[h];
+                _head[h] = static_cast<std::int32_t>(i);
+            }
+
+            // Longest match for position i (not yet inserted); 0 if < kMinMatch.
+            std::size_t Longest(std::size_t i, std::size_t& dist) const {
+                if (i + kMinMatch > _n) return 0;
+                const std::size_t limit = std::min(kMaxMatch, _n - i);
+                std::size_t best = 0;
+                std::int32_t cand = _head[hash(i)];
+                for (unsigned chain = _maxChain; cand >= 0 && chain; --chain) {
+                    const std::size_t c = static_cast<std::size_t>(cand);
+                    if (i - c > kWindow) break;
+                    if (_p[c + best] == _p[i + best]) {
+                        std::size_t len = 0;
+                        while (len < limit && _p[c + len] == _p[i + len]) ++len;
+                        if (len > best) {
+                            best = len;
+                            dist = i - c;
+                            if (len == limit) break;
+                        }
+                    }
+                    const std::int32_t next = _prev[c & (kWindow - 1)];
+                    if (next >= cand) break;   // slot reused by a newer position
+                    cand = next;
+                }
+                return best >= kMinMatch ? best : 0;
+            }
+
+        private:
+            static constexpr std::size_t kHashBits = 15;
+            static constexpr std::size_t kHashSize = std::size_t{ 1 } << kHashBits;
+
+            std::uint32_t hash(std::size_t i) const {
+                const std::uint32_t v = static_cast<std::uint32_t>(_p[i]) | (static_cast<std::uint32_t>(_p[i + 1]) << 8)
+                    | (static_cast<std::uint32_t>(_p[i + 2]) << 16);
+                return (v * 2654435761u) >> (32 - kHashBits);
+            }
+
+            const unsigned char*      _p;
+            std::size_t               _n;
+            unsigned                  _maxChain;
+            std::vector<std::int32_t> _head;
+            std::vector<std::int32_t> _prev;
+        };
+
+        // ---------- Decompressor ----------
+
+        struct Huffman {
+            std::uint16_t count[16]{};
+            std::uint16_t symbol[288]{};
+        };
+
+        // Canonical code from code lengths; false if over-subscribed.
+        bool Build(Huffman& h, const std::uint8_t* lengths, unsigned n) {
+            std::fill(std::begin(h.count), std::end(h.count), std::uint16_t{ 0 });
+            for (unsigned s = 0; s < n; ++s) ++h.count[lengths[s]];
+            if (h.count[0] == n) return true;   // no codes; fails on first use
+
+            int left = 1;
+            for (unsigned len = 1; len < 16; ++len) {
+                left <<= 1;
+                left -= h.count[len];
+                if (left < 0) return false;
+            }
+
+            std::uint16_t offs[16]{};
+            for (unsigned len = 1; len < 15; ++len) offs[len + 1] = static_cast<std::uint16_t>(offs[len] + h.count[len]);
+            for (unsigned s = 0; s < n; ++s)
+                if (lengths[s]) h.symbol[offs[lengths[s]]++] = static_cast<std::uint16_t>(s);
+            return true;
+        }
+
+        class Inflater {
+        public:
+            Inflater(const unsigned char* p, std::size_t n, std::string& out, std::size_t start)
+                : _p(p), _n(n), _out(out), _start(start) {}
+
+            // Inflates one deflate stream; on success Pos() is the first byte after it.
+            bool Run(const char*& err) {
+                int last;
+                do {
+                    last = bits(1);
+                    const int type = bits(2);
+                    if (_eof) { err = "truncated"; return false; }
+                    bool ok;
+                    if (type == 0)      ok = stored(err);
+                    else if (type == 1) ok = fixed(err);
+                    else if (type == 2) ok = dynamic(err);
+                    else { err = "bad block type"; return false; }
+                    if (!ok) return false;
+                } while (!last);
+                return true;
+            }
+
+            std::size_t Pos() const noexcept { return _pos; }
+
+        private:
+            int bits(unsigned need) {
+                std::uint32_t v = _buf;
+                while (_cnt < need) {
+                    if (_pos >= _n) { _eof = true; return 0; }
+                    v |= static_cast<std::uint32_t>(_p[_pos++]) << _cnt;
+                    _cnt += 8;
+                }
+                _buf = v >> need;
+                _cnt -= need;
+                return static_cast<int>(v & ((1u << need) - 1));
+            }
+
+            int decode(const Huffman& h) {
+                int code = 0, first = 0, index = 0;
+                for (unsigned len = 1; len < 16; ++len) {
+                    code |= bits(1);
+                    if (_eof) return -1;
+                    const int count = h.count[len];
+                    if (code - count < first) return h.symbol[index + (code - first)];
+                    index += count;
+                    first += count;
+                    first <<= 1;
+                    code <<= 1;
+                }
+                return -1;
+            }
+
+            bool stored(const char*& err) {
+                _buf = 0;
+                _cnt = 0;   // to the byte boundary
+                if (_n - _pos < 4) { err = "truncated"; return false; }
+                const unsigned len = _p[_pos] | (_p[_pos + 1] << 8);
+                const unsigned nlen = _p[_pos + 2] | (_p[_pos + 3] << 8);
+                _pos += 4;
+                if (len != (~nlen & 0xFFFFu)) { err = "bad stored block length"; return false; }
+                if (_n - _pos < len) { err = "truncated"; return false; }
+                _out.append(reinterpret_cast<const char*>(_p + _pos), len);
+                _pos += len;
+                return true;
+            }
+
+            bool codes(const Huffman& lencode, const Huffman& distcode, const char*& err) {
+                for (;;) {
+                    int sym = decode(lencode);
+                    if (sym < 0) { err = _eof ? "truncated" : "bad literal/length code"; return false; }
+                    if (sym < 256) {
+                        _out.push_back(static_cast<char>(sym));
+                        continue;
+                    }
+                    if (sym == 256) return true;
+
+                    sym -= 257;
+                    if (sym >= 29) { err = "bad length symbol"; return false; }
+                    const std::size_t len = kLenBase[sym] + static_cast<std::size_t>(bits(kLenExtra[sym]));
+                    const int dsym = decode(distcode);
+                    if (dsym < 0 || dsym >= 30) { err = _eof ? "truncated" : "bad distance code"; return false; }
+                    const std::size_t dist = kDistBase[dsym] + static_cast<std::size_t>(bits(kDistExtra[dsym]));
+                    if (_eof) { err = "truncated"; return false; }
+                    if (dist > _out.size() - _start) { err = "distance too far back"; return false; }
+
+                    std::size_t from = _out.size() - dist;
+                    for (std::size_t k = 0; k < len; ++k) _out.push_back(_out[from++]);
+                }
+            }
+
+            bool fixed(const char*& err) {
+                static const std::pair<Huffman, Huffman> tables = [] {
+                    std::pair<Huffman, Huffman> t;
+                    std::uint8_t lengths[288];
+                    std::size_t s = 0;
+                    for (; s < 144; ++s) lengths[s] = 8;
+                    for (; s < 256; ++s) lengths[s] = 9;
+                    for (; s < 280; ++s) lengths[s] = 7;
+                    for (; s < 288; ++s) lengths[s] = 8;
+                    Build(t.first, lengths, 288);
+                    std::fill(lengths, lengths + 30, std::uint8_t{ 5 });
+                    Build(t.second, lengths, 30);
+                    return t;
+                }();
+                return codes(tables.first, tables.second, err);
+            }
+
+            bool dynamic(const char*& err) {
+                static constexpr std::uint8_t kOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+                const unsigned nlen = static_cast<unsigned>(bits(5)) + 257;
+                const unsigned ndist = static_cast<unsigned>(bits(5)) + 1;
+                const unsigned ncode = static_cast<unsigned>(bits(4)) + 4;
+                if (_eof) { err = "truncated"; return false; }
+                if (nlen > 286 || ndist > 30) { err = "bad code counts"; return false; }
+
+                std::uint8_t lengths[286 + 30]{};
+                for (unsigned i = 0; i < ncode; ++i) lengths[kOrder[i]] = static_cast<std::uint8_t>(bits(3));
+                Huffman lencode, distcode;
+                if (!Build(lencode, lengths, 19)) { err = "bad code length code"; return false; }
+
+                for (unsigned i = 0; i < nlen + ndist;) {
+                    const int sym = decode(lencode);
+                    if (sym < 0) { err = _eof ? "truncated" : "bad code length"; return false; }
+                    if (sym < 16) {
+                        lengths[i++] = static_cast<std::uint8_t>(sym);
+                        continue;
+                    }
+                    std::uint8_t len = 0;
+                    unsigned repeat;
+                    if (sym == 16) {
+                        if (i == 0) { err = "repeat with no previous length"; return false; }
+                        len = lengths[i - 1];
+                        repeat = 3 + static_cast<unsigned>(bits(2));
+                    }
+                    else if (sym == 17) repeat = 3 + static_cast<unsigned>(bits(3));
+                    else                repeat = 11 + static_cast<unsigned>(bits(7));
+                    if (i + repeat > nlen + ndist) { err = "too many code lengths"; return false; }
+                    while (repeat--) lengths[i++] = len;
+                }
+                if (lengths[256] == 0) { err = "no end-of-block code"; return false; }
+
+                if (!Build(lencode, lengths, nlen)) { err = "bad literal/length lengths"; return false; }
+                if (!Build(distcode, lengths + nlen, ndist)) { err = "bad distance lengths"; return false; }
+                return codes(lencode, distcode, err);
+            }
+
+            const unsigned char* _p;
+            std::size_t          _n;
+            std::size_t          _pos{ 0 };
+            std::uint32_t        _buf{ 0 };
+            unsigned             _cnt{ 0 };
+            bool                 _eof{ false };
+            std::string&         _out;
+            std::size_t          _start;   // first output byte of this stream
+        };
+
+        std::uint32_t LE32(const unsigned char* p) {
+            return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8)
+                | (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+        }
+    }
+
+    std::uint32_t Crc32(const void* data, std::size_t n, std::uint32_t crc) noexcept {
+        const auto& t = CrcTable();
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        crc = ~crc;
+        for (std::size_t i = 0; i < n; ++i) crc = t[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    bool IsGzip(const void* data, std::size_t n) noexcept {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        return n >= 18 && p[0] == 0x1F && p[1] == 0x8B && p[2] == 8;
+    }
+
+    // ---------- Compression ----------
+
+    void GzipCompress(const void* data, std::size_t n, std::string& out, Level level) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        const unsigned maxChain = level == Level::Fast ? 8 : level == Level::Best ? 256 : 48;
+
+        // Header: no name, no mtime, OS unknown.
+        static constexpr unsigned char kHeader[10] = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF };
+        out.append(reinterpret_cast<const char*>(kHeader), sizeof(kHeader));
+        out.reserve(out.size() + n / 3 + 64);
+
+        // One final fixed-Huffman block.
+        BitWriter bw(out);
+        bw.Put(1, 1);
+        bw.Put(1, 2);
+
+        Matcher m(p, n, maxChain);
+        std::size_t i = 0;
+        while (i < n) {
+            std::size_t dist = 0;
+            std::size_t len = m.Longest(i, dist);
+            m.Insert(i);
+
+            // Lazy step: a longer match starting at the next byte wins (not
+            // worth the search once the match is already long).
+            if (len && len < kLazyLimit && i + 1 < n) {
+                std::size_t dist2 = 0;
+                const std::size_t len2 = m.Longest(i + 1, dist2);
+                if (len2 > len) {
+                    PutLitLen(bw, p[i]);
+                    m.Insert(++i);
+                    len = len2;
+                    dist = dist2;
+                }
+            }
+
+            if (!len) {
+                PutLitLen(bw, p[i]);
+                ++i;
+                continue;
+            }
+            PutMatch(bw, len, dist);
+            for (std::size_t k = 1; k < len; ++k) m.Insert(i + k);
+            i += len;
+        }
+        PutLitLen(bw, 256);
+        bw.Finish();
+
+        PutLE32(out, Crc32(p, n));
+        PutLE32(out, static_cast<std::uint32_t>(n & 0xFFFFFFFFu));
+    }
+
+    // ---------- Decompression ----------
+
+    bool Gunzip(const void* data, std::size_t n, std::string& out, std::string* err) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        auto fail = [&](const char* why) {
+            if (err) *err = why;
+            return false;
+        };
+
+        std::size_t pos = 0;
+        bool any = false;
+        while (n - pos >= 18 && p[pos] == 0x1F && p[pos + 1] == 0x8B) {
+            if (p[pos + 2] != 8) return fail("unknown compression method");
+            const unsigned flags = p[pos + 3];
+            pos += 10;
+            if (flags & 4) {   // FEXTRA
+                if (n - pos < 2) return fail("truncated header");
+                const std::size_t xlen = p[pos] | (p[pos + 1] << 8);
+                pos += 2;
+                if (n - pos < xlen) return fail("truncated header");
+                pos += xlen;
+            }
+            for (unsigned f : { 8u, 16u }) {   // FNAME, FCOMMENT
+                if (!(flags & f)) continue;
+                while (pos < n && p[pos]) ++pos;
+                if (pos >= n) return fail("truncated header");
+                ++pos;
+            }
+            if (flags & 2) pos += 2;   // FHCRC
+            if (pos > n) return fail("truncated header");
+
+            const std::size_t start = out.size();
+            Inflater inf(p + pos, n - pos, out, start);
+            const char* why = nullptr;
+            if (!inf.Run(why)) return fail(why);
+            pos += inf.Pos();
+
+            if (n - pos < 8) return fail("truncated trailer");
+            const std::uint32_t crc = LE32(p + pos);
+            const std::uint32_t isize = LE32(p + pos + 4);
+            pos += 8;
+            if (Crc32(out.data() + start, out.size() - start) != crc) return fail("CRC mismatch");
+            if (static_cast<std::uint32_t>((out.size() - start) & 0xFFFFFFFFu) != isize) return fail("length mismatch");
+            any = true;
+        }
+        return any ? true : fail("not a gzip stream");
+    }
+
+} // namespace MB::Deflate
@@ -0,0 +1,312 @@
+// src/MBFileWatch.cpp
+#include "MBFileWatch.hpp"
+#include "MBLog.hpp"
+
+#include <algorithm>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace MB {
+
+    namespace {
+        using steady = std::chrono::steady_clock;
+
+        // What the poll backend compares between ticks.
+        struct FileStamp {
+            bool                            exists{ false };
+            std::filesystem::file_time_type time{};
+            std::uintmax_t                  size{ 0 };
+
+            bool operator==(const FileStamp& o) const {
+                return exists == o.exists && time == o.time && size == o.size;
+            }
+        };
+
+        FileStamp Probe(const std::filesystem::path& p) {
+            FileStamp s;
+            std::error_code ec;
+            s.time = std::filesystem::last_write_time(p, ec);
+            if (ec) return s;
+            s.size = std::filesystem::file_size(p, ec);
+            s.exists = !ec;
+            return s;
+        }
+
+        // Milliseconds until due, rounded up so a wait never ends early.
+        long long MsUntil(steady::time_point due) {
+            const auto left = std::chrono::ceil<std::chrono::milliseconds>(due - steady::now()).count();
+            return left > 0 ? left : 0;
+        }
+    }
+
+    FileWatcher::~FileWatcher() {
+        Stop();
+    }
+
+    FileWatcher::Stats FileWatcher::GetStats() const noexcept {
+        Stats s;
+        s.events = _events.load(std::memory_order_relaxed);
+        s.callbacks = _callbacks.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    bool FileWatcher::Start(const std::filesystem::path& file, Callback onChange, const Options& opt) {
+        Stop();
+        _file = file;
+        _onChange = std::move(onChange);
+        _pollInterval = std::max(opt.pollInterval, std::chrono::milliseconds(10));
+        SetCoalesce(opt.coalesce);
+        _stop.store(false, std::memory_order_relaxed);
+
+        if (opt.backend != Backend::Poll && startNative()) {
+            _active.store(Backend::Native, std::memory_order_relaxed);
+            _thread = std::thread([this] { nativeLoop(); });
+            return true;
+        }
+        if (opt.backend == Backend::Native) return false;
+
+        _active.store(Backend::Poll, std::memory_order_relaxed);
+        _thread = std::thread([this] { pollLoop(); });
+        return true;
+    }
+
+    void FileWatcher::Stop() {
+        if (!_thread.joinable()) return;
+        _stop.store(true, std::memory_order_relaxed);
+#ifdef _WIN32
+        if (_stopEvent) SetEvent(static_cast<HANDLE>(_stopEvent));
+#elif defined(__linux__)
+        if (_stopFd >= 0) {
+            const std::uint64_t one = 1;
+            (void)!::write(_stopFd, &one, sizeof(one));
+        }
+#endif
+        {
+            std::scoped_lock lk{ _pollMx };
+        }
+        _pollCv.notify_all();
+        _thread.join();
+
+#ifdef _WIN32
+        if (_dir) CloseHandle(static_cast<HANDLE>(_dir));
+        if (_stopEvent) CloseHandle(static_cast<HANDLE>(_stopEvent));
+        _dir = _stopEvent = nullptr;
+#elif defined(__linux__)
+        if (_notifyFd >= 0) ::close(_notifyFd);
+        if (_stopFd >= 0) ::close(_stopFd);
+        _notifyFd = _stopFd = -1;
+#endif
+    }
+
+    // Every event (re)starts the quiet window.
+    void FileWatcher::noteEvent(steady::time_point& due, bool& pending) {
+        _events.fetch_add(1, std::memory_order_relaxed);
+        due = steady::now() + coalesce();
+        pending = true;
+    }
+
+    void FileWatcher::fire() {
+        _callbacks.fetch_add(1, std::memory_order_relaxed);
+        try { _onChange(); }
+        catch (...) {
+            MB_LOGW(Core, "FileWatcher: change callback threw");
+        }
+    }
+
+    // ---------- Native backends ----------
+
+#ifdef _WIN32
+
+    bool FileWatcher::startNative() {
+        const std::filesystem::path dir = _file.parent_path();
+        HANDLE h = CreateFileW(dir.c_str(), FILE_LIST_DIRECTORY,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+            FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (h == INVALID_HANDLE_VALUE) return false;
+        HANDLE stop = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!stop) { CloseHandle(h); return false; }
+        _dir = h;
+        _stopEvent = stop;
+        return true;
+    }
+
+    void FileWatcher::nativeLoop() {
+        HANDLE dir = static_cast<HANDLE>(_dir);
+        const std::wstring name = _file.filename().wstring();
+        alignas(DWORD) unsigned char buf[16 * 1024];
+        OVERLAPPED ov{};
+        ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+        auto arm = [&] {
+            ResetEvent(ov.hEvent);
+            return ReadDirectoryChangesW(dir, buf, sizeof(buf), FALSE,
+                FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_CREATION,
+                nullptr, &ov, nullptr) != FALSE;
+        };
+
+        bool armed = ov.hEvent && arm();
+        DWORD err = armed ? 0 : GetLastError();
+        bool pending = false;
+        steady::time_point due{};
+        while (armed && !_stop.load(std::memory_order_relaxed)) {
+            HANDLE waits[2] = { ov.hEvent, static_cast<HANDLE>(_stopEvent) };
+            const DWORD timeout = pending ? static_cast<DWORD>(MsUntil(due)) : INFINITE;
+            const DWORD w = WaitForMultipleObjects(2, waits, FALSE, timeout);
+            if (w == WAIT_OBJECT_0 + 1) break;
+
+            if (w == WAIT_OBJECT_0) {
+                DWORD n = 0;
+                if (!GetOverlappedResult(dir, &ov, &n, FALSE)) { err = GetLastError(); armed = false; break; }
+                bool hit = n == 0;   // buffer overflow: assume the file was among them
+                for (DWORD off = 0; n && off < n;) {
+                    const auto* fni = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buf + off);
+                    if (CompareStringOrdinal(fni->FileName, static_cast<int>(fni->FileNameLength / sizeof(WCHAR)),
+                        name.c_str(), static_cast<int>(name.size()), TRUE) == CSTR_EQUAL)
+                        hit = true;
+                    if (!fni->NextEntryOffset) break;
+                    off += fni->NextEntryOffset;
+                }
+                if (hit) noteEvent(due, pending);
+                armed = arm();
+                if (!armed) err = GetLastError();
+            }
+
+            if (pending && steady::now() >= due) {
+                pending = false;
+                fire();
+            }
+        }
+
+        if (ov.hEvent) {
+            DWORD n = 0;
+            CancelIoEx(dir, &ov);
+            GetOverlappedResult(dir, &ov, &n, TRUE);
+            CloseHandle(ov.hEvent);
+        }
+        if (!armed && !_stop.load(std::memory_order_relaxed)) {
+            MB::Log().Log(LogLevel::Warn, "FileWatcher: directory notifications for %ls stopped (error %u); polling instead",
+                _file.c_str(), static_cast<unsigned>(err));
+            _active.store(Backend::Poll, std::memory_order_relaxed);
+            pollLoop();
+        }
+    }
+
+#elif defined(__linux__)
+
+    bool FileWatcher::startNative() {
+        const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) return false;
+        // The directory, not the file: saves that write a temp file and
+        // rename it over the original replace the inode a file watch is on.
+        const std::filesystem::path dir = _file.has_parent_path() ? _file.parent_path() : std::filesystem::path(".");
+        if (inotify_add_watch(fd, dir.c_str(),
+            IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM
+            | IN_DELETE_SELF | IN_MOVE_SELF) < 0) {
+            ::close(fd);
+            return false;
+        }
+        const int stop = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (stop < 0) { ::close(fd); return false; }
+        _notifyFd = fd;
+        _stopFd = stop;
+        return true;
+    }
+
+    void FileWatcher::nativeLoop() {
+        const std::string name = _file.filename().string();
+        alignas(inotify_event) char buf[16 * 1024];
+        bool pending = false;
+        bool watching = true;
+        steady::time_point due{};
+
+        while (watching && !_stop.load(std::memory_order_relaxed)) {
+            pollfd fds[2] = { { _notifyFd, POLLIN, 0 }, { _stopFd, POLLIN, 0 } };
+            const int r = ::poll(fds, 2, pending ? static_cast<int>(MsUntil(due)) : -1);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                watching = false;
+                break;
+            }
+            if (fds[1].revents) break;
+
+            if (fds[0].revents & POLLIN) {
+                bool hit = false;
+                for (;;) {
+                    const ssize_t n = ::read(_notifyFd, buf, sizeof(buf));
+                    if (n <= 0) break;
+                    for (ssize_t off = 0; off < n;) {
+                        const auto* ev = reinterpret_cast<const inotify_event*>(buf + off);
+                        if (ev->mask & IN_Q_OVERFLOW) hit = true;
+                        if (ev->len && name == ev->name) hit = true;
+                        if (ev->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) watching = false;
+                        off += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+                    }
+                }
+                if (hit) noteEvent(due, pending);
+            }
+
+            if (pending && steady::now() >= due) {
+                pending = false;
+                fire();
+            }
+        }
+
+        if (!watching && !_stop.load(std::memory_order_relaxed)) {
+            MB_LOGW(Core, "FileWatcher: inotify watch on %s ended; polling instead", _file.parent_path().string());
+            _active.store(Backend::Poll, std::memory_order_relaxed);
+            pollLoop();
+        }
+    }
+
+#else
+
+    bool FileWatcher::startNative() { return false; }
+    void FileWatcher::nativeLoop() {}
+
+#endif
+
+    // ---------- Poll backend ----------
+
+    void FileWatcher::pollLoop() {
+        FileStamp last = Probe(_file);
+        bool pending = false;
+        steady::time_point due{};
+
+        while (!_stop.load(std::memory_order_relaxed)) {
+            {
+                auto wait = _pollInterval;
+                if (pending) wait = std::min(wait, std::chrono::milliseconds(MsUntil(due)));
+                std::unique_lock lk{ _pollMx };
+                _pollCv.wait_for(lk, wait, [this] { return _stop.load(std::memory_order_relaxed); });
+            }
+            if (_stop.load(std::memory_order_relaxed)) break;
+
+            const FileStamp now = Probe(_file);
+            if (!(now == last)) {
+                last = now;
+                noteEvent(due, pending);
+            }
+            if (pending && steady::now() >= due) {
+                pending = false;
+                fire();
+            }
+        }
+    }
+
+} // namespace MB
@@ -0,0 +1,385 @@
+// src/MBFlightRecorder.cpp
+#include "MBFlightRecorder.hpp"
+#include "MBLog.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace MB {
+
+    using namespace FlightWire;
+
+    namespace {
+        std::int64_t WallNowNs() noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        std::atomic_ref<std::uint64_t> Seq(SlotHeader* s) noexcept { return std::atomic_ref<std::uint64_t>(s->seq); }
+
+        // Crash handlers run in a broken process: no allocation, no stdio.
+        void Put(char*& p, char* end, const char* s) noexcept {
+            while (*s && p < end) *p++ = *s++;
+        }
+
+        void PutNumber(char*& p, char* end, std::uint64_t v, unsigned base) noexcept {
+            char tmp[24];
+            int n = 0;
+            do { tmp[n++] = "0123456789abcdef"[v % base]; v /= base; } while (v && n < 24);
+            if (base == 16) Put(p, end, "0x");
+            while (n && p < end) *p++ = tmp[--n];
+        }
+
+#ifdef _WIN32
+        LPTOP_LEVEL_EXCEPTION_FILTER g_prevFilter = nullptr;
+
+        LONG WINAPI OnUnhandledException(EXCEPTION_POINTERS* info) {
+            char buf[128];
+            char* p = buf;
+            char* const end = buf + sizeof(buf) - 1;
+            const EXCEPTION_RECORD* rec = info ? info->ExceptionRecord : nullptr;
+            Put(p, end, "unhandled exception ");
+            PutNumber(p, end, rec ? rec->ExceptionCode : 0, 16);
+            Put(p, end, " at ");
+            PutNumber(p, end, rec ? reinterpret_cast<std::uintptr_t>(rec->ExceptionAddress) : 0, 16);
+            if (rec && rec->ExceptionCode == EXCEPTION_ACCESS_VIOLATION && rec->NumberParameters >= 2) {
+                Put(p, end, rec->ExceptionInformation[0] ? " writing " : " reading ");
+                PutNumber(p, end, rec->ExceptionInformation[1], 16);
+            }
+            *p = '\0';
+            Flight().Crash(buf);
+            return g_prevFilter ? g_prevFilter(info) : EXCEPTION_CONTINUE_SEARCH;
+        }
+#else
+        constexpr int kFatalSignals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+        struct sigaction g_prevAction[std::size(kFatalSignals)]{};
+
+        const char* SignalName(int sig) noexcept {
+            switch (sig) {
+            case SIGSEGV: return "SIGSEGV";
+            case SIGBUS:  return "SIGBUS";
+            case SIGFPE:  return "SIGFPE";
+            case SIGILL:  return "SIGILL";
+            case SIGABRT: return "SIGABRT";
+            default:      return "signal";
+            }
+        }
+
+        void OnFatalSignal(int sig, siginfo_t* info, void*) {
+            char buf[128];
+            char* p = buf;
+            char* const end = buf + sizeof(buf) - 1;
+            Put(p, end, SignalName(sig));
+            Put(p, end, " (");
+            PutNumber(p, end, static_cast<std::uint64_t>(sig), 10);
+            Put(p, end, ")");
+            if (info && sig != SIGABRT) {
+                Put(p, end, " at ");
+                PutNumber(p, end, reinterpret_cast<std::uintptr_t>(info->si_addr), 16);
+            }
+            *p = '\0';
+            Flight().Crash(buf);
+
+            // Re-deliver to whoever handled it before; the signal is blocked
+            // until this handler returns.
+            for (std::size_t i = 0; i < std::size(kFatalSignals); ++i)
+                if (kFatalSignals[i] == sig) sigaction(sig, &g_prevAction[i], nullptr);
+            raise(sig);
+        }
+#endif
+    }
+
+    FlightRecorder& Flight() {
+        static FlightRecorder g;
+        return g;
+    }
+
+    FlightRecorder::~FlightRecorder() {
+        // Marks the file clean only. The view and its handles stay until the
+        // process is gone: detached threads (the pipe server among them) can
+        // still be inside a writer during static destruction, past the _open
+        // check, and must land in a mapped page.
+        Close();
+    }
+
+    // ---------- Open / Close ----------
+
+    bool FlightRecorder::Open(const std::filesystem::path& file, std::size_t slots) {
+        std::scoped_lock lk{ _mx };
+        if (!_base) {
+            std::error_code ec;
+            std::filesystem::create_directories(file.parent_path(), ec);
+
+            // A file left live (or crashed) is the previous session's flight.
+            if (std::ifstream in{ file, std::ios::binary }) {
+                Header old{};
+                in.read(reinterpret_cast<char*>(&old), sizeof(old));
+                if (in && std::memcmp(old.magic, kMagic, sizeof(kMagic)) == 0 && old.state != kClean) {
+                    in.close();
+                    std::filesystem::path crash = file;
+                    crash.replace_extension();
+                    crash += ".crash";
+                    crash += file.extension();
+                    std::filesystem::rename(file, crash, ec);
+                    if (!ec) _recovered = crash;
+                }
+            }
+
+            slots = std::max<std::size_t>(slots, 64);
+            if (!map(file, kHeaderBytes + kSiteBytes + slots * kSlotBytes)) return false;
+            _path = file;
+            _hdr = reinterpret_cast<Header*>(_base);
+            _sites = _base + kHeaderBytes;
+            _slots = _sites + kSiteBytes;
+            _slotCount = slots;
+
+            // The mapping of a freshly sized file reads as zeros.
+            _hdr->version = kVersion;
+            _hdr->slotBytes = static_cast<std::uint32_t>(kSlotBytes);
+            _hdr->slotCount = static_cast<std::uint32_t>(slots);
+            _hdr->siteBytes = static_cast<std::uint32_t>(kSiteBytes);
+#ifdef _WIN32
+            _hdr->pid = static_cast<std::uint32_t>(GetCurrentProcessId());
+#else
+            _hdr->pid = static_cast<std::uint32_t>(getpid());
+#endif
+            _hdr->startWallNs = WallNowNs();
+            std::memcpy(_hdr->magic, kMagic, sizeof(kMagic));
+        }
+
+        std::atomic_ref<std::uint32_t>(_hdr->state).store(kLive, std::memory_order_release);
+        if (!_handlers) installCrashHandlers();
+        _open.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void FlightRecorder::Close() {
+        std::scoped_lock lk{ _mx };
+        if (!_open.exchange(false, std::memory_order_acq_rel)) return;
+        if (_handlers) removeCrashHandlers();
+        std::atomic_ref<std::uint32_t>(_hdr->state).store(kClean, std::memory_order_release);
+    }
+
+    std::filesystem::path FlightRecorder::Recovered() const {
+        std::scoped_lock lk{ _mx };
+        return _recovered;
+    }
+
+    bool FlightRecorder::map(const std::filesystem::path& file, std::size_t bytes) {
+#ifdef _WIN32
+        // FILE_SHARE_READ so the file can be copied (or dumped) while live.
+        HANDLE f = CreateFileW(file.c_str(), GENERIC_READ | GENERIC_WRITE,
+            FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (f == INVALID_HANDLE_VALUE) return false;
+        const std::uint64_t size = bytes;
+        HANDLE m = CreateFileMappingW(f, nullptr, PAGE_READWRITE,
+            static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+        if (!m) { CloseHandle(f); return false; }
+        void* view = MapViewOfFile(m, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, bytes);
+        if (!view) { CloseHandle(m); CloseHandle(f); return false; }
+        _file = f;
+        _mapping = m;
+        _base = static_cast<unsigned char*>(view);
+#else
+        const int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) { ::close(fd); return false; }
+        void* view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) { ::close(fd); return false; }
+        _fd = fd;
+        _base = static_cast<unsigned char*>(view);
+#endif
+        _bytes = bytes;
+        return true;
+    }
+
+    void FlightRecorder::installCrashHandlers() {
+#ifdef _WIN32
+        g_prevFilter = SetUnhandledExceptionFilter(&OnUnhandledException);
+#else
+        struct sigaction sa {};
+        sa.sa_sigaction = &OnFatalSignal;
+        sa.sa_flags = SA_SIGINFO | SA_ONSTACK;
+        sigemptyset(&sa.sa_mask);
+        for (std::size_t i = 0; i < std::size(kFatalSignals); ++i)
+            sigaction(kFatalSignals[i], &sa, &g_prevAction[i]);
+#endif
+        _handlers = true;
+    }
+
+    void FlightRecorder::removeCrashHandlers() {
+#ifdef _WIN32
+        SetUnhandledExceptionFilter(g_prevFilter);
+        g_prevFilter = nullptr;
+#else
+        for (std::size_t i = 0; i < std::size(kFatalSignals); ++i)
+            sigaction(kFatalSignals[i], &g_prevAction[i], nullptr);
+#endif
+        _handlers = false;
+    }
+
+    // ---------- Writers ----------
+
+    // A slot is taken by swinging its seq from an older, published record to
+    // 0 (acquire, so this record is ordered after the one it replaces). If a
+    // writer a full ring behind is still filling it, or one a ring ahead got
+    // there first, the record is skipped rather than interleaved.
+    SlotHeader* FlightRecorder::claim(Kind kind, std::uint64_t& seq) noexcept {
+        if (!_open.load(std::memory_order_acquire)) return nullptr;
+        seq = std::atomic_ref<std::uint64_t>(_hdr->next).fetch_add(1, std::memory_order_relaxed);
+        auto* s = reinterpret_cast<SlotHeader*>(_slots + (seq % _slotCount) * kSlotBytes);
+        std::uint64_t cur = Seq(s).load(std::memory_order_relaxed);
+        do {
+            const bool free = cur ? cur <= seq : seq < _slotCount;   // 0: untouched on the first lap only
+            if (!free) {
+                std::atomic_ref<std::uint32_t>(_hdr->skipped).fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        } while (!Seq(s).compare_exchange_weak(cur, 0, std::memory_order_acquire, std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_release);   // 0 lands before the new payload
+        s->wallNs = WallNowNs();
+        s->site = 0;
+        s->kind = kind;
+        s->level = 0;
+        s->module = 0;
+        s->flags = 0;
+        return s;
+    }
+
+    void FlightRecorder::publish(SlotHeader* s, std::uint64_t seq, std::size_t len) noexcept {
+        s->len = static_cast<std::uint16_t>(len);
+        Seq(s).store(seq + 1, std::memory_order_release);
+    }
+
+    void FlightRecorder::Text(LogLevel lvl, LogModule mod, const char* text, std::size_t len) noexcept {
+        std::uint64_t seq;
+        SlotHeader* s = claim(kText, seq);
+        if (!s) return;
+        s->level = static_cast<std::uint8_t>(lvl);
+        s->module = static_cast<std::uint8_t>(mod);
+        len = std::min(len, kSlotPayload);
+        std::memcpy(s + 1, text, len);
+        publish(s, seq, len);
+    }
+
+    void FlightRecorder::Record(const LogSite& site, std::uint32_t id, const unsigned char* args, std::size_t len) noexcept {
+        std::uint64_t seq;
+        SlotHeader* s = claim(kRecord, seq);
+        if (!s) return;
+        s->site = id;
+        s->level = static_cast<std::uint8_t>(site.level);
+        s->module = static_cast<std::uint8_t>(site.module);
+        len = std::min(len, kSlotPayload);
+        if (len) std::memcpy(s + 1, args, len);   // args is null for argument-less sites
+        publish(s, seq, len);
+    }
+
+    void FlightRecorder::Op(std::string_view name, std::int64_t usec, bool failed) noexcept {
+        std::uint64_t seq;
+        SlotHeader* s = claim(kOp, seq);
+        if (!s) return;
+        s->flags = failed ? kOpFailed : 0;
+        unsigned char* p = reinterpret_cast<unsigned char*>(s + 1);
+        std::memcpy(p, &usec, sizeof(usec));
+        const std::size_t n = std::min(name.size(), kSlotPayload - sizeof(usec));
+        std::memcpy(p + sizeof(usec), name.data(), n);
+        publish(s, seq, sizeof(usec) + n);
+    }
+
+    void FlightRecorder::Event(std::string_view name, double a, double b, double c) noexcept {
+        std::uint64_t seq;
+        SlotHeader* s = claim(kEvent, seq);
+        if (!s) return;
+        unsigned char* p = reinterpret_cast<unsigned char*>(s + 1);
+        const double v[3] = { a, b, c };
+        std::memcpy(p, v, sizeof(v));
+        const std::size_t n = std::min(name.size(), kSlotPayload - sizeof(v));
+        std::memcpy(p + sizeof(v), name.data(), n);
+        publish(s, seq, sizeof(v) + n);
+    }
+
+    void FlightRecorder::Crash(const char* what) noexcept {
+        std::uint64_t seq;
+        SlotHeader* s = claim(kCrash, seq);
+        if (!s) return;
+        s->level = static_cast<std::uint8_t>(LogLevel::Error);
+        const std::size_t n = std::min(std::strlen(what), kSlotPayload);
+        std::memcpy(s + 1, what, n);
+        publish(s, seq, n);
+        std::atomic_ref<std::uint32_t>(_hdr->state).store(kCrashed, std::memory_order_release);
+    }
+
+    bool FlightRecorder::DefineSite(std::uint32_t id, const LogSite& site) noexcept {
+        if (!_open.load(std::memory_order_acquire)) return false;
+        const std::uint16_t fileLen = static_cast<std::uint16_t>(std::min<std::size_t>(std::strlen(site.file), 0xFFFF));
+        const std::uint16_t fmtLen = static_cast<std::uint16_t>(std::min<std::size_t>(std::strlen(site.fmt), 0xFFFF));
+        const std::size_t need = 1 + 4 + 1 + 1 + 4 + 2 + fileLen + 2 + fmtLen;
+
+        const std::uint32_t at = std::atomic_ref<std::uint32_t>(_hdr->siteUsed).fetch_add(
+            static_cast<std::uint32_t>(need), std::memory_order_relaxed);
+        if (at + need > kSiteBytes) return false;
+
+        unsigned char* p = _sites + at;
+        auto put = [&p](const void* v, std::size_t n) { std::memcpy(p, v, n); p += n; };
+        const std::uint8_t level = static_cast<std::uint8_t>(site.level);
+        const std::uint8_t module = static_cast<std::uint8_t>(site.module);
+        const std::uint32_t line = static_cast<std::uint32_t>(site.line);
+        *p++ = LogWire::kSite;
+        put(&id, sizeof(id));
+        put(&level, 1);
+        put(&module, 1);
+        put(&line, sizeof(line));
+        put(&fileLen, sizeof(fileLen));
+        put(site.file, fileLen);
+        put(&fmtLen, sizeof(fmtLen));
+        put(site.fmt, fmtLen);
+        return true;
+    }
+
+    // ---------- Stats ----------
+
+    FlightRecorder::Stats FlightRecorder::GetStats() const {
+        Stats s;
+        s.open = IsOpen();
+        std::scoped_lock lk{ _mx };
+        if (!_hdr) return s;
+        s.records = std::atomic_ref<std::uint64_t>(_hdr->next).load(std::memory_order_relaxed);
+        s.slots = _slotCount;
+        s.skipped = std::atomic_ref<std::uint32_t>(_hdr->skipped).load(std::memory_order_relaxed);
+        s.siteBytes = std::min<std::size_t>(std::atomic_ref<std::uint32_t>(_hdr->siteUsed).load(std::memory_order_relaxed), kSiteBytes);
+        return s;
+    }
+
+    std::string FlightRecorder::StatsJSON() const {
+        const Stats s = GetStats();
+        std::ostringstream ss;
+        ss << "{"
+            << "\"open\":" << (s.open ? "true" : "false") << ","
+            << "\"records\":" << s.records << ","
+            << "\"skipped\":" << s.skipped << ","
+            << "\"slots\":" << s.slots << ","
+            << "\"siteBytes\":" << s.siteBytes
+            << "}";
+        return ss.str();
+    }
+
+} // namespace MB
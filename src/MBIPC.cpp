@@ -2,6 +2,7 @@
 
 #include "MBIPC.hpp"
 #include "MBOps.hpp"         // for MB::Ops::I().Dispatch(op, args)
+#include "MBLog.hpp"
 
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
@@ -106,6 +107,7 @@ namespace
         const json args = in.value("args", json::object());
 
         // Dispatch to your op table; expected to return a json object/primitive.
+        MB_LOGD(IPC, "op %s", op.c_str());
         json reply;
         try
         {
@@ -113,10 +115,12 @@ namespace
         }
         catch (const std::exception& e)
         {
+            MB_LOGW_RL(IPC, "op %s threw: %s", op.c_str(), e.what());
             reply = json{ {"ok", false}, {"error", e.what()}, {"op", op} };
         }
         catch (...)
         {
+            MB_LOGW_RL(IPC, "op %s threw an unknown exception", op.c_str());
             reply = json{ {"ok", false}, {"error", "unknown error"}, {"op", op} };
         }
 
@@ -174,6 +178,7 @@ namespace MB
 
             if (pipe == INVALID_HANDLE_VALUE)
             {
+                MB_LOGW_RL(IPC, "CreateNamedPipe failed (%lu), retrying", GetLastError());
                 // Backoff briefly if creation fails
                 Sleep(250);
                 continue;
@@ -190,12 +195,15 @@ namespace MB
                 }
             }
 
+            MB_LOGI_RL(IPC, "client connected");
+
             // Session loop: process messages until client disconnects
             for (;;)
             {
                 std::string reqStr;
                 if (!PipeReadMessage(pipe, reqStr))
                     break; // disconnect
+                MB_LOGT(IPC, "request: %zu bytes", reqStr.size());
 
                 json reply;
                 try
@@ -205,10 +213,12 @@ namespace MB
                 }
                 catch (const std::exception& e)
                 {
+                    MB_LOGW_RL(IPC, "bad request: %s", e.what());
                     reply = json{ {"ok", false}, {"error", e.what()} };
                 }
                 catch (...)
                 {
+                    MB_LOGW_RL(IPC, "bad request: %s", "bad json");
                     reply = json{ {"ok", false}, {"error", "bad json"} };
                 }
 
@@ -219,6 +229,7 @@ namespace MB
 
             DisconnectNamedPipe(pipe);
             CloseHandle(pipe);
+            MB_LOGI_RL(IPC, "client disconnected");
         }
     }
 }
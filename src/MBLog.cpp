@@ -30,20 +30,28 @@
 #endif
 
 // --- C++ headers FIRST (so macros can't break them) ---
+#include <algorithm>
 #include <cstdarg>
 #include <cstdio>
-#include <fstream>
+#include <cstring>
+#include <ctime>
 #include <sstream>
-#include <iomanip>
 #include <chrono>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <string>
 #include <system_error>
+#include <utility>
+#include <vector>
 
 // --- Project header ---
 #include "MBLog.hpp"
+#include "MBDeflate.hpp"
+#include "MBFlightRecorder.hpp"
 
 // --- Win32 AFTER STL; be lean; then scrub MIDL keywords again ---
+#ifdef _WIN32
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
 #endif
@@ -66,9 +74,11 @@
 #ifdef hyper
 #undef hyper
 #endif
+#endif // _WIN32
 
 namespace {
 
+#ifdef _WIN32
     // Resolve the plugin folder from this module's address.
     std::filesystem::path GetPluginFolder() {
         wchar_t path[MAX_PATH]{};
@@ -83,6 +93,21 @@ namespace {
         GetModuleFileNameW(hm, path, static_cast<DWORD>(std::size(path)));
         return std::filesystem::path(path).parent_path(); // .../plugins/MirrorBladeBridge
     }
+#else
+    // Non-Windows builds (tools, benchmarks) log next to the working directory.
+    std::filesystem::path GetPluginFolder() {
+        std::error_code ec;
+        return std::filesystem::current_path(ec);
+    }
+#endif
+
+    void FormatV(char* buf, std::size_t size, const char* fmt, va_list ap) {
+#ifdef _WIN32
+        _vsnprintf_s(buf, size, _TRUNCATE, fmt, ap);
+#else
+        std::vsnprintf(buf, size, fmt, ap);
+#endif
+    }
 
 } // namespace
 
@@ -93,121 +118,874 @@ namespace MB {
 
     Logger& Log() { return g_logger; }
 
+    namespace {
+        constexpr std::size_t kSlotPayload = Logger::kSlotBytes - sizeof(std::uint64_t);
+        constexpr std::uint64_t kRingMask = Logger::kRingSlots - 1;
+        constexpr std::size_t kBatchBytes = 256 * 1024;
+
+        static_assert((Logger::kRingSlots & kRingMask) == 0, "ring size must be a power of two");
+
+        std::int64_t WallNowNs() noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        std::int64_t SteadyNowNs() noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        const char* BaseName(const char* path) {
+            const char* base = path;
+            for (const char* p = path; *p; ++p)
+                if (*p == '/' || *p == '\\') base = p + 1;
+            return base;
+        }
+
+        const wchar_t* Extension(LogFormat f) {
+            return f == LogFormat::Binary ? L".mbl" : L".log";
+        }
+
+        template <class V>
+        void AppendRaw(std::string& out, V v) {
+            out.append(reinterpret_cast<const char*>(&v), sizeof(V));
+        }
+
+        std::FILE* OpenAppend(const std::filesystem::path& p) {
+#ifdef _WIN32
+            return _wfopen(p.c_str(), L"ab");
+#else
+            return std::fopen(p.c_str(), "ab");
+#endif
+        }
+
+        std::tm LocalTime(std::time_t t) {
+            std::tm tm{};
+#ifdef _WIN32
+            localtime_s(&tm, &t);
+#else
+            localtime_r(&t, &tm);
+#endif
+            return tm;
+        }
+
+        bool EndsWith(const std::wstring& s, const wchar_t* suffix) {
+            const std::size_t n = std::char_traits<wchar_t>::length(suffix);
+            return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+        }
+
+        struct SegmentFile {
+            std::filesystem::path           path;
+            std::uint64_t                   bytes{ 0 };
+            std::filesystem::file_time_type mtime{};
+        };
+
+        // Rotated segments of base in dir (<base>.<anything>.log/.mbl[.gz]),
+        // oldest first. The live <base>.log / <base>.mbl are not segments.
+        std::vector<SegmentFile> ListSegments(const std::filesystem::path& dir, const std::wstring& base) {
+            std::vector<SegmentFile> out;
+            const std::wstring prefix = base + L".";
+            std::error_code ec;
+            for (std::filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+                if (!it->is_regular_file(ec)) continue;
+                const std::wstring name = it->path().filename().wstring();
+                if (name.compare(0, prefix.size(), prefix) != 0) continue;
+                if (name == base + L".log" || name == base + L".mbl") continue;
+                if (!EndsWith(name, L".log") && !EndsWith(name, L".mbl") && !EndsWith(name, L".gz")) continue;
+
+                SegmentFile f;
+                f.path = it->path();
+                f.bytes = static_cast<std::uint64_t>(it->file_size(ec));
+                f.mtime = it->last_write_time(ec);
+                out.push_back(std::move(f));
+            }
+            std::sort(out.begin(), out.end(), [](const SegmentFile& a, const SegmentFile& b) {
+                return a.mtime != b.mtime ? a.mtime < b.mtime : a.path < b.path;
+            });
+            return out;
+        }
+    }
+
+    Logger::Logger() : _ring(new Slot[kRingSlots]), _sites(new std::atomic<const LogSite*>[kMaxSites]) {
+        for (std::size_t i = 0; i < kRingSlots; ++i)
+            _ring[i].seq.store(i, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < kMaxSites; ++i)
+            _sites[i].store(nullptr, std::memory_order_relaxed);
+        _batch.reserve(kBatchBytes);
+        _text.reserve(kMaxMessage);
+    }
+
+    Logger::~Logger() {
+        Shutdown();
+        std::scoped_lock lk{ _mtx };
+        if (_file) {
+            std::fclose(_file);
+            _file = nullptr;
+        }
+    }
+
     void Logger::Init(const std::filesystem::path& logDir,
         const std::wstring& base,
         size_t maxBytes,
-        int keep) {
-        std::scoped_lock lk{ _mtx };
-        _dir = logDir;
-        _base = base;
-        _maxBytes = maxBytes;
-        _keep = keep;
+        int keep,
+        LogFormat format) {
+        {
+            std::scoped_lock lk{ _mtx };
+            _dir = logDir;
+            _base = base;
+            _maxBytes = maxBytes;
+            _format.store(format, std::memory_order_relaxed);
+            openUnlocked();
+        }
+        {
+            std::scoped_lock lk{ _maintMx };
+            _retention.keep = keep;
+            _maintDir = logDir;
+            _maintBase = base;
+            _maintSweep = true;
+            _maintStop = false;
+            if (!_maint.joinable()) _maint = std::thread([this] { maintLoop(); });
+        }
+        _maintCv.notify_one();
 
-        std::error_code ec;
-        std::filesystem::create_directories(_dir, ec);
-        _cur = _dir / (std::wstring(_base) + L".log");
+        std::scoped_lock lk{ _wakeMx };
+        if (_writer.joinable()) return;
+        _stopping = false;
+        _syncWrite.store(false, std::memory_order_release);
+        _writer = std::thread([this] { writerLoop(); });
+    }
+
+    void Logger::SetRetention(const Retention& r) {
+        {
+            std::scoped_lock lk{ _maintMx };
+            _retention = r;
+            _maintSweep = true;
+        }
+        _maintCv.notify_one();
+    }
 
-        // Touch current log file.
-        std::ofstream(_cur, std::ios::app | std::ios::binary).close();
+    Logger::Retention Logger::GetRetention() const {
+        std::scoped_lock lk{ _maintMx };
+        return _retention;
     }
 
+    // ---------- Levels ----------
+
     void Logger::SetLevel(LogLevel lvl) {
-        _lvl.store(lvl, std::memory_order_relaxed);
+        std::scoped_lock lk{ _lvlMx };
+        _globalLvl = lvl;
+        for (std::size_t i = 0; i < kLogModuleCount; ++i)
+            if (!_hasOverride[i]) {
+                _modLvl[i].store(lvl, std::memory_order_relaxed);
+                updateGateUnlocked(i);
+            }
     }
 
-    std::string Logger::timestamp() {
-        using namespace std::chrono;
-        const auto now = system_clock::now();
-        const auto t = system_clock::to_time_t(now);
-        const auto us = duration_cast<microseconds>(now.time_since_epoch()) % 1'000'000;
+    LogLevel Logger::Level() const {
+        std::scoped_lock lk{ _lvlMx };
+        return _globalLvl;
+    }
 
-        std::tm tm{};
-        localtime_s(&tm, &t);
+    void Logger::SetModuleLevel(LogModule mod, LogLevel lvl) {
+        const std::size_t i = static_cast<std::size_t>(mod);
+        std::scoped_lock lk{ _lvlMx };
+        _override[i] = lvl;
+        _hasOverride[i] = true;
+        _modLvl[i].store(lvl, std::memory_order_relaxed);
+        updateGateUnlocked(i);
+    }
 
-        std::ostringstream ss;
-        ss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S")
-            << "." << std::setw(6) << std::setfill('0') << us.count();
-        return ss.str();
+    void Logger::ClearModuleLevel(LogModule mod) {
+        const std::size_t i = static_cast<std::size_t>(mod);
+        std::scoped_lock lk{ _lvlMx };
+        _hasOverride[i] = false;
+        _modLvl[i].store(_globalLvl, std::memory_order_relaxed);
+        updateGateUnlocked(i);
     }
 
-    void Logger::rotateIfNeededUnlocked() {
-        if (_maxBytes == 0) return;
+    bool Logger::HasModuleLevel(LogModule mod) const {
+        std::scoped_lock lk{ _lvlMx };
+        return _hasOverride[static_cast<std::size_t>(mod)];
+    }
 
-        std::error_code ec;
-        const auto sz = std::filesystem::file_size(_cur, ec);
-        if (ec || sz < _maxBytes) return;
-
-        // Rotate: base.(keep-1).log -> base.keep.log, ..., base.1.log -> base.2.log, cur -> base.1.log
-        for (int i = _keep - 1; i >= 1; --i) {
-            const auto from = _dir / (std::wstring(_base) + L"." + std::to_wstring(i) + L".log");
-            const auto to = _dir / (std::wstring(_base) + L"." + std::to_wstring(i + 1) + L".log");
-            if (std::filesystem::exists(from, ec)) {
-                std::filesystem::remove(to, ec);
-                std::filesystem::rename(from, to, ec);
-            }
+    void Logger::SetFlight(bool on, LogLevel lvl) {
+        if (on) {
+            // Sites registered before the recorder opened.
+            std::scoped_lock lk{ _siteMx };
+            defineFlightSitesUnlocked();
         }
-        const auto to1 = _dir / (std::wstring(_base) + L".1.log");
-        std::filesystem::remove(to1, ec);
-        std::filesystem::rename(_cur, to1, ec);
+        std::scoped_lock lk{ _lvlMx };
+        _flightOn = on;
+        _flightLvl = lvl;
+        _flightGate.store(on ? static_cast<int>(lvl) : kFlightOff, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < kLogModuleCount; ++i) updateGateUnlocked(i);
+    }
 
-        // Start a fresh file.
-        std::ofstream(_cur, std::ios::trunc | std::ios::binary).close();
+    bool Logger::FlightOn() const {
+        std::scoped_lock lk{ _lvlMx };
+        return _flightOn;
     }
 
-    void Logger::writeUnlocked(const std::string& line) {
-        rotateIfNeededUnlocked();
-        std::ofstream f(_cur, std::ios::app | std::ios::binary);
-        if (!f) return;
-        f.write(line.data(), static_cast<std::streamsize>(line.size()));
-        f.put('\n');
+    LogLevel Logger::FlightLevel() const {
+        std::scoped_lock lk{ _lvlMx };
+        return _flightLvl;
     }
 
-    static const char* lvlName(LogLevel l) {
-        switch (l) {
-        case LogLevel::Trace: return "TRACE";
-        case LogLevel::Debug: return "DEBUG";
-        case LogLevel::Info:  return "INFO";
-        case LogLevel::Warn:  return "WARN";
-        case LogLevel::Error: return "ERROR";
-        }
-        return "?";
+    void Logger::updateGateUnlocked(std::size_t mod) {
+        const LogLevel file = _modLvl[mod].load(std::memory_order_relaxed);
+        const bool flightLower = _flightOn && static_cast<int>(_flightLvl) < static_cast<int>(file);
+        _gateLvl[mod].store(flightLower ? _flightLvl : file, std::memory_order_relaxed);
     }
 
+    void Logger::SetFormat(LogFormat format) {
+        if (_format.exchange(format, std::memory_order_relaxed) == format) return;
+        std::scoped_lock lk{ _mtx };
+        if (_file && _fileFormat != format) openUnlocked();
+    }
+
+    // ---------- Producer ----------
+
     void Logger::Log(LogLevel lvl, const char* fmt, ...) {
-        if (static_cast<int>(lvl) < static_cast<int>(_lvl.load(std::memory_order_relaxed))) return;
+        if (!Enabled(lvl)) return;
 
-        char msg[2048]{};
         va_list ap; va_start(ap, fmt);
-        _vsnprintf_s(msg, sizeof(msg), _TRUNCATE, fmt, ap);
+        logV(lvl, fmt, ap);
         va_end(ap);
-
-        std::ostringstream line;
-        line << timestamp() << " [" << lvlName(lvl) << "] " << msg;
-
-        std::scoped_lock lk{ _mtx };
-        writeUnlocked(line.str());
     }
 
     void Logger::LogErr(const char* fmt, ...) {
-        char msg[2048]{};
         va_list ap; va_start(ap, fmt);
-        _vsnprintf_s(msg, sizeof(msg), _TRUNCATE, fmt, ap);
+        logV(LogLevel::Error, fmt, ap);
         va_end(ap);
+    }
+
+    void Logger::logV(LogLevel lvl, const char* fmt, va_list ap) {
+        char msg[kMaxMessage];
+        msg[0] = '\0';
+        FormatV(msg, sizeof(msg), fmt, ap);
+        const std::size_t len = std::strlen(msg);
+        if (toFlight(lvl)) Flight().Text(lvl, LogModule::Core, msg, len);
+        if (static_cast<int>(lvl) >= static_cast<int>(ModuleLevel(LogModule::Core))) push(lvl, 0, msg, len);
+    }
 
-        std::ostringstream line;
-        line << timestamp() << " [ERROR] " << msg;
+    void Logger::pushDeferred(LogSite& site, const unsigned char* args, std::size_t len) {
+        std::uint32_t id = site.id.load(std::memory_order_acquire);
+        if (!id) id = registerSite(site);
+        const bool toFile = static_cast<int>(site.level) >= static_cast<int>(ModuleLevel(site.module));
+        if (id) {
+            if (toFlight(site.level)) Flight().Record(site, id, args, len);
+            if (toFile) push(site.level, id, args, len);
+            return;
+        }
 
-        std::scoped_lock lk{ _mtx };
-        writeUnlocked(line.str());
+        // Site table full: format here, like Log().
+        std::string text;
+        LogWire::Format(site.fmt, args, len, text);
+        if (toFlight(site.level)) Flight().Text(site.level, site.module, text.data(), text.size());
+        if (!toFile) return;
+        if (site.module != LogModule::Core)
+            text.insert(0, std::string("[") + LogModuleName(site.module) + "] ");
+        push(site.level, 0, text.data(), text.size() < kMaxMessage ? text.size() : kMaxMessage - 1);
+    }
+
+    std::uint32_t Logger::registerSite(LogSite& site) {
+        std::scoped_lock lk{ _siteMx };
+        if (const std::uint32_t id = site.id.load(std::memory_order_relaxed)) return id;
+        if (_siteCount >= kMaxSites) return 0;
+
+        _sites[_siteCount].store(&site, std::memory_order_release);
+        const std::uint32_t id = ++_siteCount;
+        if (Flight().IsOpen()) defineFlightSitesUnlocked();
+        site.id.store(id, std::memory_order_release);
+        return id;
+    }
+
+    void Logger::defineFlightSitesUnlocked() {
+        for (; _flightSites < _siteCount; ++_flightSites)
+            if (!Flight().DefineSite(_flightSites + 1, *_sites[_flightSites].load(std::memory_order_relaxed))) break;
+    }
+
+    void Logger::registerLimit(LogLimit& limit, const LogSite& site) {
+        std::scoped_lock lk{ _siteMx };
+        limit._site = &site;
+        _limits.push_back(&limit);
+    }
+
+    bool Logger::push(LogLevel lvl, std::uint32_t site, const void* data, std::size_t len) {
+        const std::size_t total = sizeof(Record) + len;
+        const std::uint64_t k = (total + kSlotPayload - 1) / kSlotPayload;
+
+        // Claim k consecutive slots. The consumer frees slots in order, so if
+        // the last one is free, every one before it is too.
+        std::uint64_t pos = _tail.load(std::memory_order_relaxed);
+        unsigned stalls = 0;
+        for (;;) {
+            const std::uint64_t last = pos + k - 1;
+            const std::uint64_t seq = _ring[last & kRingMask].seq.load(std::memory_order_acquire);
+            const std::int64_t diff = static_cast<std::int64_t>(seq - last);
+            if (diff == 0) {
+                if (_tail.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) {
+                // Full. Errors are worth a stall: drain on this thread and retry.
+                // The oldest line may still be mid-copy on another thread.
+                if (lvl >= LogLevel::Error && stalls++ < 1000) {
+                    bool open;
+                    {
+                        std::scoped_lock lk{ _mtx };
+                        open = _file != nullptr;
+                        if (open) drainUnlocked();
+                    }
+                    if (open) {
+                        std::this_thread::yield();
+                        pos = _tail.load(std::memory_order_relaxed);
+                        continue;
+                    }
+                }
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                _droppedTotal.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else {
+                pos = _tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        Record rec{ WallNowNs(), static_cast<std::uint16_t>(len), static_cast<std::uint8_t>(lvl), static_cast<std::uint8_t>(k), site };
+        const unsigned char* src = static_cast<const unsigned char*>(data);
+        std::size_t left = len;
+        for (std::uint64_t i = 0; i < k; ++i) {
+            Slot& s = _ring[(pos + i) & kRingMask];
+            unsigned char* dst = s.data;
+            std::size_t room = kSlotPayload;
+            if (i == 0) {
+                std::memcpy(dst, &rec, sizeof(rec));
+                dst += sizeof(rec);
+                room -= sizeof(rec);
+            }
+            const std::size_t n = left < room ? left : room;
+            if (n) std::memcpy(dst, src, n);   // src is null for argument-less sites
+            src += n;
+            left -= n;
+        }
+        for (std::uint64_t i = 0; i < k; ++i)
+            _ring[(pos + i) & kRingMask].seq.store(pos + i + 1, std::memory_order_release);
+
+        if (_syncWrite.load(std::memory_order_acquire)) {
+            std::scoped_lock lk{ _mtx };
+            drainUnlocked();
+        }
+        else if (_writerIdle.load(std::memory_order_relaxed) &&
+            (lvl >= LogLevel::Warn || pos + k - _head.load(std::memory_order_relaxed) > kRingSlots / 2)) {
+            _writerIdle.store(false, std::memory_order_relaxed);
+            _wakeCv.notify_one();
+        }
+        return true;
+    }
+
+    // ---------- Consumer ----------
+
+    // Moves every fully published line into the file; returns how many.
+    std::size_t Logger::drainUnlocked() {
+        if (!_file) return 0;
+
+        std::size_t n = 0;
+        std::uint64_t h = _head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& first = _ring[h & kRingMask];
+            if (first.seq.load(std::memory_order_acquire) != h + 1) break;
+
+            Record rec;
+            std::memcpy(&rec, first.data, sizeof(rec));
+            bool ready = true;
+            for (std::uint64_t i = 1; i < rec.slots && ready; ++i)
+                ready = _ring[(h + i) & kRingMask].seq.load(std::memory_order_acquire) == h + i + 1;
+            if (!ready) break;   // a producer is still copying the tail of this line
+
+            const char* text = reinterpret_cast<const char*>(first.data) + sizeof(rec);
+            if (rec.slots > 1) {
+                _text.assign(text, kSlotPayload - sizeof(rec));
+                for (std::uint64_t i = 1; i < rec.slots; ++i)
+                    _text.append(reinterpret_cast<const char*>(_ring[(h + i) & kRingMask].data), kSlotPayload);
+                text = _text.data();
+            }
+            consume(rec, text);
+
+            for (std::uint64_t i = 0; i < rec.slots; ++i)
+                _ring[(h + i) & kRingMask].seq.store(h + i + kRingSlots, std::memory_order_release);
+            h += rec.slots;
+            _head.store(h, std::memory_order_release);
+            ++n;
+        }
+
+        if (const std::uint64_t lost = _dropped.exchange(0, std::memory_order_relaxed)) {
+            char msg[96];
+            std::snprintf(msg, sizeof(msg), "%llu log line(s) dropped: ring full",
+                static_cast<unsigned long long>(lost));
+            const Record rec{ WallNowNs(), static_cast<std::uint16_t>(std::strlen(msg)), static_cast<std::uint8_t>(LogLevel::Warn), 0, 0 };
+            consume(rec, msg);
+        }
+        reportRepeatsUnlocked();
+
+        writeBatchUnlocked();
+        _lines.fetch_add(n, std::memory_order_relaxed);
+        return n;
+    }
+
+    void Logger::consume(const Record& rec, const char* payload) {
+        if (_fileFormat == LogFormat::Binary) {
+            appendBinary(rec, payload);
+            return;
+        }
+        if (!rec.site) {
+            appendLine(rec, payload);
+            return;
+        }
+
+        const LogSite* site = _sites[rec.site - 1].load(std::memory_order_acquire);
+        _formatted.clear();
+        LogWire::Format(site->fmt, reinterpret_cast<const unsigned char*>(payload), rec.len, _formatted);
+        Record line = rec;
+        line.len = static_cast<std::uint16_t>(_formatted.size() < 0xFFFF ? _formatted.size() : 0xFFFF);
+        appendLine(line, _formatted.data(), site->module);
+    }
+
+    // One "last message repeated N times" line per rate-limited site that
+    // suppressed anything since the previous report.
+    void Logger::reportRepeatsUnlocked() {
+        const std::int64_t now = SteadyNowNs();
+        if (!_repeatsDue.exchange(false, std::memory_order_relaxed) &&
+            now - _repeatSweepNs < std::chrono::duration_cast<std::chrono::nanoseconds>(kRepeatInterval).count())
+            return;
+        _repeatSweepNs = now;
+
+        std::scoped_lock lk{ _siteMx };
+        for (LogLimit* limit : _limits) {
+            const std::uint64_t total = limit->_suppressed.load(std::memory_order_relaxed);
+            if (total == limit->_reported) continue;
+            const std::uint64_t n = total - limit->_reported;
+            limit->_reported = total;
+
+            // Binary text entries carry no module; put it in the message.
+            const LogSite& site = *limit->_site;
+            const bool tag = _fileFormat == LogFormat::Binary && site.module != LogModule::Core;
+            char msg[192];
+            const int w = std::snprintf(msg, sizeof(msg), "%s%s%slast message repeated %llu times (%s:%d)",
+                tag ? "[" : "", tag ? LogModuleName(site.module) : "", tag ? "] " : "",
+                static_cast<unsigned long long>(n), BaseName(site.file), site.line);
+            const std::size_t len = w <= 0 ? 0 : (static_cast<std::size_t>(w) < sizeof(msg) ? static_cast<std::size_t>(w) : sizeof(msg) - 1);
+            const Record rec{ WallNowNs(), static_cast<std::uint16_t>(len), static_cast<std::uint8_t>(site.level), 0, 0 };
+            if (_fileFormat == LogFormat::Binary) appendBinary(rec, msg);
+            else appendLine(rec, msg, site.module);
+        }
+    }
+
+    void Logger::appendLine(const Record& rec, const char* text, LogModule mod) {
+        // "YYYY-mm-dd HH:MM:SS.uuuuuu [LEVEL] message\n", or
+        // "... [LEVEL] [module] message\n" outside the core module
+        const std::int64_t sec = rec.wallNs / 1'000'000'000;
+        if (sec != _stampSec) {
+            const std::tm tm = LocalTime(static_cast<std::time_t>(sec));
+            std::strftime(_stamp, sizeof(_stamp), "%Y-%m-%d %H:%M:%S", &tm);
+            _stampSec = sec;
+        }
+
+        char frac[8];
+        unsigned us = static_cast<unsigned>((rec.wallNs / 1000) % 1'000'000);
+        frac[0] = '.';
+        for (int i = 6; i >= 1; --i) { frac[i] = static_cast<char>('0' + us % 10); us /= 10; }
+        frac[7] = ' ';
+
+        const char* lvl = LogWire::LevelName(rec.level);
+        const char* modName = mod != LogModule::Core ? LogModuleName(mod) : nullptr;
+        reserveUnlocked(std::strlen(_stamp) + sizeof(frac) + std::strlen(lvl) + 3
+            + (modName ? std::strlen(modName) + 3 : 0) + rec.len + 1);
+
+        _batch.append(_stamp);
+        _batch.append(frac, sizeof(frac));
+        _batch.push_back('[');
+        _batch.append(lvl);
+        _batch.append("] ", 2);
+        if (modName) {
+            _batch.push_back('[');
+            _batch.append(modName);
+            _batch.append("] ", 2);
+        }
+        _batch.append(text, rec.len);
+        _batch.push_back('\n');
+    }
+
+    // Binary entries; see MBLogFormat.hpp for the layout.
+    void Logger::appendBinary(const Record& rec, const char* payload) {
+        const LogSite* site = rec.site ? _sites[rec.site - 1].load(std::memory_order_acquire) : nullptr;
+        if (!site) {
+            reserveUnlocked(1 + 8 + 1 + 2 + rec.len);
+            _batch.push_back(static_cast<char>(LogWire::kText));
+            AppendRaw(_batch, rec.wallNs);
+            AppendRaw(_batch, rec.level);
+            AppendRaw(_batch, rec.len);
+            _batch.append(payload, rec.len);
+            return;
+        }
+
+        const std::uint16_t fileLen = static_cast<std::uint16_t>(std::strlen(site->file) & 0xFFFF);
+        const std::uint16_t fmtLen = static_cast<std::uint16_t>(std::strlen(site->fmt) & 0xFFFF);
+        reserveUnlocked(1 + 4 + 1 + 1 + 4 + 2 + fileLen + 2 + fmtLen + 1 + 8 + 4 + 2 + rec.len);
+
+        if (_siteInFile.size() <= rec.site) _siteInFile.resize(rec.site + 1u, false);
+        if (!_siteInFile[rec.site]) {
+            _batch.push_back(static_cast<char>(LogWire::kSite));
+            AppendRaw(_batch, rec.site);
+            AppendRaw(_batch, static_cast<std::uint8_t>(site->level));
+            AppendRaw(_batch, static_cast<std::uint8_t>(site->module));
+            AppendRaw(_batch, static_cast<std::uint32_t>(site->line));
+            AppendRaw(_batch, fileLen);
+            _batch.append(site->file, fileLen);
+            AppendRaw(_batch, fmtLen);
+            _batch.append(site->fmt, fmtLen);
+            _siteInFile[rec.site] = true;
+        }
+
+        _batch.push_back(static_cast<char>(LogWire::kRecord));
+        AppendRaw(_batch, rec.wallNs);
+        AppendRaw(_batch, rec.site);
+        AppendRaw(_batch, rec.len);
+        _batch.append(payload, rec.len);
+    }
+
+    // Makes room for one entry: rotates first if it would cross maxBytes.
+    void Logger::reserveUnlocked(std::size_t bytes) {
+        if (_maxBytes && _curBytes + _batch.size() + bytes > _maxBytes && _curBytes + _batch.size() > LogWire::kHeaderBytes) {
+            writeBatchUnlocked();
+            rotateUnlocked();
+        }
+        else if (_batch.size() + bytes > kBatchBytes) {
+            writeBatchUnlocked();
+        }
+    }
+
+    void Logger::writeBatchUnlocked() {
+        if (_batch.empty() || !_file) return;
+        const std::size_t wrote = std::fwrite(_batch.data(), 1, _batch.size(), _file);
+        _curBytes += wrote;
+        _bytes.fetch_add(wrote, std::memory_order_relaxed);
+        _batches.fetch_add(1, std::memory_order_relaxed);
+        _batch.clear();
+    }
+
+    void Logger::openUnlocked() {
+        if (_file) {
+            writeBatchUnlocked();
+            std::fclose(_file);
+            _file = nullptr;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(_dir, ec);
+        _fileFormat = _format.load(std::memory_order_relaxed);
+        _cur = _dir / (std::wstring(_base) + Extension(_fileFormat));
+
+        _file = OpenAppend(_cur);
+        if (!_file) return;
+        std::setvbuf(_file, nullptr, _IONBF, 0);   // batches are already one write each
+
+        // The only size query; from here on the writer counts bytes itself.
+        const auto sz = std::filesystem::file_size(_cur, ec);
+        _curBytes = ec ? 0 : static_cast<std::uint64_t>(sz);
+
+        // Site ids are per process: a binary log always starts a new segment.
+        if (_fileFormat == LogFormat::Binary) {
+            if (_curBytes > 0) rotateUnlocked();
+            else startSegmentUnlocked();
+        }
+    }
+
+    void Logger::startSegmentUnlocked() {
+        _siteInFile.assign(_siteInFile.size(), false);
+        if (_fileFormat != LogFormat::Binary) return;
+        _batch.append(LogWire::kMagic, sizeof(LogWire::kMagic));
+        AppendRaw(_batch, LogWire::kVersion);
+        AppendRaw(_batch, std::uint32_t{ 0 });
+    }
+
+    void Logger::rotateUnlocked() {
+        if (_file) {
+            std::fclose(_file);
+            _file = nullptr;
+        }
+
+        // One rename; compression and retention happen on the maintenance thread.
+        const std::filesystem::path seg = segmentPathUnlocked();
+        std::error_code ec;
+        std::filesystem::rename(_cur, seg, ec);
+
+        // Start a fresh file.
+        _file = OpenAppend(_cur);
+        if (_file) std::setvbuf(_file, nullptr, _IONBF, 0);
+        _curBytes = 0;
+        _rotations.fetch_add(1, std::memory_order_relaxed);
+        startSegmentUnlocked();
+
+        if (!ec) {
+            {
+                std::scoped_lock lk{ _maintMx };
+                _maintQ.push_back(seg);
+            }
+            _maintCv.notify_one();
+        }
+    }
+
+    // <base>.YYYYmmdd-HHMMSS-mmm<ext>: names sort in rotation order. A name
+    // already taken (two rotations in one millisecond) moves to the next ms.
+    std::filesystem::path Logger::segmentPathUnlocked() const {
+        const auto now = std::chrono::system_clock::now();
+        const std::tm tm = LocalTime(std::chrono::system_clock::to_time_t(now));
+        char stamp[24];
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+        long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+
+        const wchar_t* ext = Extension(_fileFormat);
+        std::error_code ec;
+        for (;; ++ms) {
+            char tail[24];
+            std::snprintf(tail, sizeof(tail), "-%03lld", ms);
+            const std::string s = std::string(stamp) + tail;
+            const std::wstring name = std::wstring(_base) + L"." + std::wstring(s.begin(), s.end()) + ext;
+            if (!std::filesystem::exists(_dir / name, ec) && !std::filesystem::exists(_dir / (name + L".gz"), ec))
+                return _dir / name;
+        }
+    }
+
+    // ---------- Writer thread ----------
+
+    void Logger::writerLoop() {
+        for (;;) {
+            std::size_t n;
+            {
+                std::scoped_lock lk{ _mtx };
+                n = drainUnlocked();
+            }
+
+            std::unique_lock<std::mutex> lk(_wakeMx);
+            _flushedCv.notify_all();
+            if (_stopping) break;
+            if (n > 0 && _head.load(std::memory_order_relaxed) != _tail.load(std::memory_order_relaxed))
+                continue;   // more arrived while writing
+
+            // Producers clear _writerIdle and notify without taking _wakeMx; a
+            // wake-up lost in that window costs at most one interval.
+            _writerIdle.store(true, std::memory_order_relaxed);
+            _wakeCv.wait_for(lk, kFlushInterval, [this] { return _stopping || !_writerIdle.load(std::memory_order_relaxed); });
+            _writerIdle.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void Logger::Flush() {
+        const std::uint64_t target = _tail.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lk(_wakeMx);
+        _repeatsDue.store(true, std::memory_order_relaxed);
+        if (!_writer.joinable()) {
+            lk.unlock();
+            std::scoped_lock flk{ _mtx };
+            drainUnlocked();
+            return;
+        }
+        _writerIdle.store(false, std::memory_order_relaxed);
+        _wakeCv.notify_one();
+        _flushedCv.wait(lk, [&] {
+            return _head.load(std::memory_order_acquire) >= target || !_writer.joinable();
+        });
+    }
+
+    void Logger::Shutdown() {
+        std::thread writer;
+        {
+            std::scoped_lock lk{ _wakeMx };
+            if (!_writer.joinable()) return;
+            _stopping = true;
+            writer = std::move(_writer);
+        }
+        _wakeCv.notify_all();
+        writer.join();
+
+        // Late lines (static destructors, unload paths) are written by their caller.
+        _syncWrite.store(true, std::memory_order_release);
+        _repeatsDue.store(true, std::memory_order_relaxed);
+        {
+            std::scoped_lock lk{ _mtx };
+            drainUnlocked();
+            if (_file) std::fflush(_file);
+        }
+
+        // Segments rotated from here on stay uncompressed until the next Init() sweep.
+        std::thread maint;
+        {
+            std::scoped_lock lk{ _maintMx };
+            _maintStop = true;
+            maint = std::move(_maint);
+        }
+        _maintCv.notify_all();
+        if (maint.joinable()) maint.join();
+    }
+
+    // ---------- Maintenance thread ----------
+
+    void Logger::maintLoop() {
+        for (;;) {
+            std::vector<std::filesystem::path> work;
+            bool sweep;
+            Retention r;
+            std::filesystem::path dir;
+            std::wstring base;
+            {
+                std::unique_lock<std::mutex> lk(_maintMx);
+                _maintCv.wait(lk, [this] { return _maintStop || _maintSweep || !_maintQ.empty(); });
+                if (_maintQ.empty() && !_maintSweep) break;   // stopping, nothing queued
+                work.swap(_maintQ);
+                sweep = std::exchange(_maintSweep, false);
+                r = _retention;
+                dir = _maintDir;
+                base = _maintBase;
+            }
+
+            if (sweep) {
+                for (const SegmentFile& f : ListSegments(dir, base))
+                    if (!EndsWith(f.path.filename().wstring(), L".gz") &&
+                        std::find(work.begin(), work.end(), f.path) == work.end())
+                        work.push_back(f.path);
+            }
+            if (r.compress)
+                for (const auto& seg : work) compressSegment(seg);
+            pruneSegments(dir, base, r);
+        }
+    }
+
+    // seg -> seg.gz via a temporary, keeping seg's mtime for age-based pruning.
+    void Logger::compressSegment(const std::filesystem::path& seg) {
+        std::error_code ec;
+        const auto mtime = std::filesystem::last_write_time(seg, ec);
+        if (ec) return;   // pruned or already compressed
+
+        std::string data;
+        {
+            std::ifstream in(seg, std::ios::binary);
+            if (!in) return;
+            data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        std::string gz;
+        Deflate::GzipCompress(data.data(), data.size(), gz);
+
+        auto dst = seg;
+        dst += L".gz";
+        auto tmp = dst;
+        tmp += L".tmp";
+        bool ok;
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            out.write(gz.data(), static_cast<std::streamsize>(gz.size()));
+            ok = static_cast<bool>(out);
+        }
+        if (ok) {
+            std::filesystem::rename(tmp, dst, ec);
+            ok = !ec;
+        }
+        if (!ok) {
+            std::filesystem::remove(tmp, ec);
+            Log(LogLevel::Warn, "log maintenance: could not compress %s", seg.filename().string().c_str());
+            return;
+        }
+        std::filesystem::last_write_time(dst, mtime, ec);
+        std::filesystem::remove(seg, ec);
+        _compressed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Deletes the oldest segments until every cap holds.
+    void Logger::pruneSegments(const std::filesystem::path& dir, const std::wstring& base, const Retention& r) {
+        std::vector<SegmentFile> segs = ListSegments(dir, base);
+        std::uint64_t total = 0;
+        for (const SegmentFile& f : segs) total += f.bytes;
+
+        const auto now = std::filesystem::file_time_type::clock::now();
+        std::size_t count = segs.size();
+        for (const SegmentFile& f : segs) {
+            const bool overCount = r.keep > 0 && count > static_cast<std::size_t>(r.keep);
+            const bool overSize = r.maxTotalBytes > 0 && total > r.maxTotalBytes;
+            const bool tooOld = r.maxAge.count() > 0 && now - f.mtime > r.maxAge;
+            if (!overCount && !overSize && !tooOld) break;   // newer segments pass too
+
+            std::error_code ec;
+            if (!std::filesystem::remove(f.path, ec)) continue;
+            --count;
+            total -= f.bytes;
+            _pruned.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Logger::Stats Logger::GetStats() const {
+        Stats s;
+        s.lines = _lines.load(std::memory_order_relaxed);
+        s.dropped = _droppedTotal.load(std::memory_order_relaxed);
+        s.batches = _batches.load(std::memory_order_relaxed);
+        s.bytes = _bytes.load(std::memory_order_relaxed);
+        s.rotations = _rotations.load(std::memory_order_relaxed);
+        s.compressed = _compressed.load(std::memory_order_relaxed);
+        s.pruned = _pruned.load(std::memory_order_relaxed);
+        std::scoped_lock lk{ _siteMx };
+        for (const LogLimit* limit : _limits)
+            s.suppressed += limit->Suppressed();
+        return s;
+    }
+
+    std::string Logger::StatsJSON() const {
+        const Stats s = GetStats();
+        std::ostringstream ss;
+        ss << "{"
+            << "\"lines\":" << s.lines << ","
+            << "\"dropped\":" << s.dropped << ","
+            << "\"batches\":" << s.batches << ","
+            << "\"bytes\":" << s.bytes << ","
+            << "\"rotations\":" << s.rotations << ","
+            << "\"suppressed\":" << s.suppressed << ","
+            << "\"compressed\":" << s.compressed << ","
+            << "\"pruned\":" << s.pruned << ","
+            << "\"queuedSlots\":" << (_tail.load(std::memory_order_relaxed) - _head.load(std::memory_order_relaxed)) << ","
+            << "\"level\":\"" << LogLevelName(Level()) << "\","
+            << "\"modules\":{";
+        for (std::size_t i = 1; i < kLogModuleCount; ++i) {
+            const LogModule m = static_cast<LogModule>(i);
+            ss << (i > 1 ? "," : "") << "\"" << LogModuleName(m) << "\":\"" << LogLevelName(ModuleLevel(m)) << "\"";
+        }
+        ss << "},\"flight\":" << Flight().StatsJSON() << "}";
+        return ss.str();
     }
 
     void InitLogs() {
         const auto dir = GetPluginFolder() / "logs"; // .../MirrorBladeBridge/logs
         g_logger.Init(dir); // relies on default args declared in MBLog.hpp
+
+        SetFlightRecorder(true);
+        const auto crashed = Flight().Recovered();
+        if (!crashed.empty())
+            g_logger.Log(LogLevel::Warn, "Previous session did not shut down cleanly; flight recorder kept in %s",
+                crashed.string().c_str());
     }
 
     void ShutdownLogs() {
-        // No-op; file handles are short-lived inside writeUnlocked().
+        g_logger.Shutdown();
+        SetFlightRecorder(false);
+    }
+
+    void SetFlightRecorder(bool on, LogLevel lvl) {
+        if (!on) {
+            g_logger.SetFlight(false);
+            Flight().Close();
+            return;
+        }
+        const auto file = GetPluginFolder() / "logs" / "MirrorBladeBridge.flight";
+        if (Flight().Open(file))
+            g_logger.SetFlight(true, lvl);
+        else
+            g_logger.Log(LogLevel::Warn, "Flight recorder: cannot map %s", file.string().c_str());
     }
 
 } // namespace MB
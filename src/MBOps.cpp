@@ -136,16 +136,20 @@ namespace MB
     static json Op_Debug_Capture_Screenshot(const json& a) { return { {"note","screenshot"}, {"args",a} }; }
 
     static json Op_Config_Set(const json& a) {
-        // Example: { "path":"trafficBoost", "value":5.0 }
+        // Example: { "path":"/trafficBoost", "value":5.0 } (JSON pointer; saved after a quiet period)
         const auto path = a.value("path", std::string{});
         const auto& val = a.contains("value") ? a.at("value") : json();
-        // TODO: mutate MB::Config accordingly + SaveConfig()
-        return { {"note","config set"}, {"path",path}, {"value",val} };
+        std::string effective, err;
+        if (!MB::SetConfigValue(path, val.dump(), effective, err))
+            return { {"ok", false}, {"error", path + ": " + err} };
+        return { {"path",path}, {"value",json::parse(effective)} };
     }
     static json Op_Config_Get(const json& a) {
-        const auto path = a.value("path", std::string{});
-        // TODO: read MB::Config and return
-        return { {"note","config get"}, {"path",path} };
+        const auto path = a.value("path", std::string{});   // "" = everything
+        std::string text;
+        if (!MB::GetConfigValue(path, text))
+            return { {"ok", false}, {"error", path + ": unknown key"} };
+        return { {"path",path}, {"value",json::parse(text)} };
     }
 
     static json Op_Ops_Capabilities(const json&) {
@@ -0,0 +1,251 @@
+// src/MBTaskGraph.cpp
+#include "MBTaskGraph.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+namespace MB {
+
+    namespace {
+        inline std::int64_t NowNs() noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        inline std::uint64_t ToUsec(std::int64_t ns) noexcept {
+            return ns > 0 ? static_cast<std::uint64_t>(ns / 1000) : 0;
+        }
+
+        const char* LaneName(M4qXE::Lane l) noexcept {
+            switch (l) {
+            case M4qXE::Lane::High:     return "high";
+            case M4qXE::Lane::Normal:   return "normal";
+            case M4qXE::Lane::Low:      return "low";
+            case M4qXE::Lane::IO:       return "io";
+            case M4qXE::Lane::Deadline: return "deadline";
+            }
+            return "?";
+        }
+    }
+
+    // ---------- Building ----------
+
+    TaskGraph::NodeId TaskGraph::Add(std::string name, std::function<void()> fn,
+        const std::vector<NodeId>& deps, Lane lane) {
+        return addNode(std::move(name), std::move(fn), deps, lane, false);
+    }
+
+    TaskGraph::NodeId TaskGraph::AddOnCaller(std::string name, std::function<void()> fn,
+        const std::vector<NodeId>& deps) {
+        return addNode(std::move(name), std::move(fn), deps, Lane::High, true);
+    }
+
+    TaskGraph::NodeId TaskGraph::addNode(std::string&& name, std::function<void()>&& fn,
+        const std::vector<NodeId>& deps, Lane lane, bool onCaller) {
+        if (_compiled) throw std::logic_error("TaskGraph: Add() after Compile()");
+
+        const NodeId id = static_cast<NodeId>(_nodes.size());
+        Node n;
+        n.name = std::move(name);
+        n.fn = std::move(fn);
+        n.lane = lane;
+        n.onCaller = onCaller;
+        for (NodeId d : deps) {
+            if (d >= id) throw std::invalid_argument("TaskGraph: '" + n.name + "' depends on an unknown node");
+            if (std::find(n.deps.begin(), n.deps.end(), d) == n.deps.end())
+                n.deps.push_back(d);
+        }
+        _nodes.push_back(std::move(n));
+        return id;
+    }
+
+    void TaskGraph::Compile() {
+        if (_compiled) return;
+
+        const std::size_t n = _nodes.size();
+        for (NodeId i = 0; i < n; ++i) {
+            if (_nodes[i].deps.empty()) _roots.push_back(i);
+            for (NodeId d : _nodes[i].deps)
+                _nodes[d].succ.push_back(i);
+        }
+
+        _pending.reset(new std::atomic<std::uint32_t>[n]);
+        _startNs.assign(n, 0);
+        _endNs.assign(n, 0);
+        _finishNs.assign(n, 0);
+        _pred.assign(n, kNoNode);
+        _callerReady.reserve(n);
+        _report.criticalPath.reserve(n);
+        _compiled = true;
+    }
+
+    // ---------- Frame ----------
+
+    const TaskGraph::FrameReport& TaskGraph::Run(M4qXE& pool) {
+        Compile();
+
+        const std::size_t n = _nodes.size();
+        _pool = &pool;
+        for (std::size_t i = 0; i < n; ++i)
+            _pending[i].store(static_cast<std::uint32_t>(_nodes[i].deps.size()), std::memory_order_relaxed);
+        _remaining.store(n, std::memory_order_relaxed);
+        _failed.store(0, std::memory_order_relaxed);
+        _firstFailed.store(kNoNode, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lk(_mx);
+            _callerReady.clear();
+            _done = n == 0;
+        }
+
+        const std::int64_t t0 = NowNs();
+        _frameStartNs = t0;
+        for (NodeId r : _roots) {
+            if (_nodes[r].onCaller) pushCaller(r);
+            else dispatch(r);
+        }
+
+        // The caller runs its own nodes (and anything the pool refused) until
+        // the last node anywhere finishes.
+        for (;;) {
+            NodeId id;
+            {
+                std::unique_lock<std::mutex> lk(_mx);
+                _cv.wait(lk, [this] { return _done || !_callerReady.empty(); });
+                if (_callerReady.empty()) break;
+                id = _callerReady.back();
+                _callerReady.pop_back();
+            }
+            execute(id, true);
+        }
+
+        buildReport(t0, NowNs());
+        return _report;
+    }
+
+    void TaskGraph::execute(NodeId id, bool onCaller) {
+        while (id != kNoNode) {
+            runNode(id);
+            id = release(id, onCaller);
+        }
+    }
+
+    // Returns the successor this thread should run next, if any.
+    TaskGraph::NodeId TaskGraph::release(NodeId id, bool onCaller) {
+        const Node& node = _nodes[id];
+        NodeId keep = kNoNode;
+        for (NodeId s : node.succ) {
+            if (_pending[s].fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+
+            const Node& next = _nodes[s];
+            const bool mine = onCaller ? next.onCaller : (!next.onCaller && next.lane == node.lane);
+            if (mine && keep == kNoNode) keep = s;
+            else if (next.onCaller) pushCaller(s);
+            else dispatch(s);
+        }
+
+        if (_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Notify under the lock: Run() may return (and the graph go away)
+            // as soon as it can observe _done.
+            std::lock_guard<std::mutex> lk(_mx);
+            _done = true;
+            _cv.notify_all();
+        }
+        return keep;
+    }
+
+    void TaskGraph::dispatch(NodeId id) {
+        if (!_pool->Enqueue(_nodes[id].lane, [this, id] { execute(id, false); }))
+            pushCaller(id);
+    }
+
+    void TaskGraph::pushCaller(NodeId id) {
+        std::lock_guard<std::mutex> lk(_mx);
+        _callerReady.push_back(id);
+        _cv.notify_all();
+    }
+
+    void TaskGraph::runNode(NodeId id) noexcept {
+        _startNs[id] = NowNs();
+        try {
+            if (_nodes[id].fn) _nodes[id].fn();
+        }
+        catch (...) {
+            if (_failed.fetch_add(1, std::memory_order_relaxed) == 0)
+                _firstFailed.store(id, std::memory_order_relaxed);
+        }
+        _endNs[id] = NowNs();
+    }
+
+    // Longest path by measured run time; node ids are already in topological order.
+    void TaskGraph::buildReport(std::int64_t t0, std::int64_t t1) {
+        FrameReport& r = _report;
+        ++r.frame;
+        r.wallUsec = ToUsec(t1 - t0);
+        r.failed = _failed.load(std::memory_order_relaxed);
+        r.firstFailed = _firstFailed.load(std::memory_order_relaxed);
+
+        std::int64_t work = 0;
+        std::int64_t longest = -1;
+        NodeId tail = kNoNode;
+        for (NodeId i = 0; i < _nodes.size(); ++i) {
+            const std::int64_t dur = _endNs[i] - _startNs[i];
+            work += dur;
+
+            std::int64_t before = 0;
+            NodeId pred = kNoNode;
+            for (NodeId d : _nodes[i].deps) {
+                if (_finishNs[d] > before || pred == kNoNode) {
+                    before = _finishNs[d];
+                    pred = d;
+                }
+            }
+            _finishNs[i] = before + dur;
+            _pred[i] = pred;
+            if (_finishNs[i] > longest) {
+                longest = _finishNs[i];
+                tail = i;
+            }
+        }
+        r.workUsec = ToUsec(work);
+        r.criticalPathUsec = ToUsec(longest);
+
+        r.criticalPath.clear();
+        for (NodeId i = tail; i != kNoNode; i = _pred[i])
+            r.criticalPath.push_back(i);
+        std::reverse(r.criticalPath.begin(), r.criticalPath.end());
+    }
+
+    std::string TaskGraph::ReportJSON() const {
+        const FrameReport& r = _report;
+        std::ostringstream ss;
+        ss.setf(std::ios::fixed);
+        ss.precision(2);
+        ss << "{"
+            << "\"frame\":" << r.frame << ","
+            << "\"wallUsec\":" << r.wallUsec << ","
+            << "\"workUsec\":" << r.workUsec << ","
+            << "\"criticalPathUsec\":" << r.criticalPathUsec << ","
+            << "\"parallelism\":" << r.Parallelism() << ","
+            << "\"failed\":" << r.failed << ",";
+        if (r.firstFailed != kNoNode)
+            ss << "\"firstFailed\":\"" << _nodes[r.firstFailed].name << "\",";
+
+        ss << "\"criticalPath\":[";
+        for (std::size_t i = 0; i < r.criticalPath.size(); ++i)
+            ss << (i ? "," : "") << "\"" << _nodes[r.criticalPath[i]].name << "\"";
+        ss << "],\"nodes\":[";
+        for (NodeId i = 0; i < _nodes.size(); ++i) {
+            ss << (i ? "," : "") << "{"
+                << "\"name\":\"" << _nodes[i].name << "\","
+                << "\"lane\":\"" << (_nodes[i].onCaller ? "caller" : LaneName(_nodes[i].lane)) << "\","
+                << "\"startUsec\":" << ToUsec(_startNs[i] - _frameStartNs) << ","
+                << "\"usec\":" << ToUsec(_endNs[i] - _startNs[i])
+                << "}";
+        }
+        ss << "]}";
+        return ss.str();
+    }
+
+} // namespace MB
@@ -0,0 +1,186 @@
+// src/MBTaskQueue.cpp
+#include "MBTaskQueue.hpp"
+
+namespace MB {
+
+    GameTaskQueue::GameTaskQueue() {
+        // First chunk up front so the first burst does not allocate.
+        _pool.Reserve();
+    }
+
+    GameTaskQueue::~GameTaskQueue() {
+        // Discard whatever is still queued; tasks are destroyed, not run.
+        for (Lane& lane : _lanes) {
+            while (Node* n = pop(lane)) {
+                n->fn.Reset();
+                if (!n->pooled) delete n;
+            }
+        }
+    }
+
+    // ---------- MPSC list ----------
+
+    void GameTaskQueue::link(Lane& lane, Node* n) noexcept {
+        n->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = lane.head.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    void GameTaskQueue::publish(Lane& lane, Node* n) noexcept {
+        lane.pushed.fetch_add(1, std::memory_order_release);
+        link(lane, n);
+    }
+
+    GameTaskQueue::Node* GameTaskQueue::pop(Lane& lane) noexcept {
+        Node* tail = lane.tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &lane.stub) {
+            if (!next) return nullptr;
+            lane.tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            lane.tail = next;
+            return tail;
+        }
+
+        // tail is the last linked node; if a producer is mid-push, try again next pump.
+        if (tail != lane.head.load(std::memory_order_acquire))
+            return nullptr;
+
+        link(lane, &lane.stub);
+
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            lane.tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    GameTaskQueue::TickReport GameTaskQueue::Pump(const Budget& budget) {
+        using clock = std::chrono::steady_clock;
+
+        TickReport r;
+        const auto t0 = clock::now();
+        const bool timed = budget.time.count() > 0;
+        const auto deadline = t0 + budget.time;
+        const std::size_t taskCap = budget.maxTasks ? budget.maxTasks : static_cast<std::size_t>(-1);
+
+        Node* first = nullptr;
+        Node* last = nullptr;
+        bool stop = false;
+
+        for (std::size_t p = 0; p < kPriorityCount && !stop; ++p) {
+            Lane& lane = _lanes[p];
+
+            // Only run what was queued when the pump reached this lane; tasks
+            // that enqueue follow-ups land on the next tick.
+            const std::uint64_t queued = lane.pushed.load(std::memory_order_acquire)
+                - lane.executed.load(std::memory_order_relaxed);
+
+            std::size_t ranHere = 0;
+            while (ranHere < queued) {
+                if (r.ran >= taskCap || (timed && r.ran > 0 && clock::now() >= deadline)) {
+                    stop = true;
+                    break;
+                }
+
+                Node* n = pop(lane);
+                if (!n) break;
+                try { n->fn(); }
+                catch (...) { /* keep loop alive */ }
+                n->fn.Reset();
+                ++ranHere;
+                ++r.ran;
+
+                if (!n->pooled) { delete n; continue; }
+                n->freeNext = first;
+                first = n;
+                if (!last) last = n;
+            }
+
+            r.ranByPriority[p] = ranHere;
+            if (ranHere)
+                lane.executed.fetch_add(ranHere, std::memory_order_release);
+        }
+        if (first)
+            _pool.Release(first, last);
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - t0);
+        r.elapsedUsec = static_cast<std::uint64_t>(elapsed.count());
+        if (timed && elapsed > budget.time)
+            r.overrunUsec = static_cast<std::uint64_t>((elapsed - budget.time).count());
+
+        for (const Lane& lane : _lanes)
+            r.deferred += static_cast<std::size_t>(lane.pushed.load(std::memory_order_acquire)
+                - lane.executed.load(std::memory_order_relaxed));
+        return r;
+    }
+
+    std::size_t GameTaskQueue::Drain(std::size_t maxTasks) {
+        Budget b;
+        b.maxTasks = maxTasks;
+        return Pump(b).ran;
+    }
+
+    // ---------- Consumer parking ----------
+
+    void GameTaskQueue::wakeConsumer() {
+        {
+            std::lock_guard<std::mutex> lk(_waitMx);
+            _wakeRequested = true;
+        }
+        _waitCv.notify_one();
+    }
+
+    void GameTaskQueue::Wake() {
+        wakeConsumer();
+    }
+
+    bool GameTaskQueue::WaitUntil(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lk(_waitMx);
+
+        _sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!_wakeRequested && Empty()) {
+            auto woken = [this] { return _wakeRequested; };
+            if (deadline == std::chrono::steady_clock::time_point::max())
+                _waitCv.wait(lk, woken);
+            else
+                _waitCv.wait_until(lk, deadline, woken);
+        }
+
+        _sleeping.store(false, std::memory_order_relaxed);
+        const bool woke = _wakeRequested;
+        _wakeRequested = false;
+        return woke || !Empty();
+    }
+
+    bool GameTaskQueue::Empty() const noexcept {
+        for (const Lane& lane : _lanes) {
+            if (lane.pushed.load(std::memory_order_acquire) != lane.executed.load(std::memory_order_acquire))
+                return false;
+        }
+        return true;
+    }
+
+    GameTaskQueue::Stats GameTaskQueue::GetStats() const noexcept {
+        Stats s;
+        for (std::size_t p = 0; p < kPriorityCount; ++p) {
+            const std::uint64_t pushed = _lanes[p].pushed.load(std::memory_order_relaxed);
+            const std::uint64_t executed = _lanes[p].executed.load(std::memory_order_relaxed);
+            s.pushed += pushed;
+            s.executed += executed;
+            s.pending[p] = static_cast<std::size_t>(pushed - executed);
+        }
+        s.heapFallbacks = _heapFallbacks.load(std::memory_order_relaxed);
+        s.poolMisses = _pool.Misses();
+        s.poolNodes = _pool.Nodes();
+        return s;
+    }
+
+} // namespace MB
@@ -0,0 +1,196 @@
+// src/MBTimerWheel.cpp
+#include "MBTimerWheel.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace MB {
+
+    TimerWheel::TimerWheel(std::uint64_t nowMs) : _now(nowMs) {
+        for (auto& lvl : _levels)
+            lvl.head.fill(kNil);
+    }
+
+    TimerWheel::~TimerWheel() = default;
+
+    void TimerWheel::Reserve(std::size_t timers) {
+        while (Capacity() < timers)
+            growSlab();
+    }
+
+    // ---------- Slab ----------
+
+    void TimerWheel::growSlab() {
+        const std::uint32_t base = static_cast<std::uint32_t>(_chunks.size()) << kChunkShift;
+        _chunks.emplace_back(new Node[kChunkSize]);
+        Node* chunk = _chunks.back().get();
+        for (std::uint32_t i = 0; i < kChunkSize; ++i)
+            chunk[i].next = (i + 1 < kChunkSize) ? base + i + 1 : _freeHead;
+        _freeHead = base;
+    }
+
+    std::uint32_t TimerWheel::allocNode() {
+        if (_freeHead == kNil) growSlab();
+        const std::uint32_t idx = _freeHead;
+        Node& n = node(idx);
+        _freeHead = n.next;
+        n.prev = n.next = kNil;
+        return idx;
+    }
+
+    void TimerWheel::freeNode(std::uint32_t idx) noexcept {
+        Node& n = node(idx);
+        n.cb.Reset();
+        n.slot = 0xFFFF;
+        if (++n.generation == 0) n.generation = 1; // keep ids non-zero
+        n.prev = kNil;
+        n.next = _freeHead;
+        _freeHead = idx;
+    }
+
+    const TimerWheel::Node* TimerWheel::lookup(TimerId id) const noexcept {
+        if (id == kInvalidTimer) return nullptr;
+        const std::uint64_t raw = (id & 0xFFFFFFFFull);
+        if (raw == 0 || raw > Capacity()) return nullptr;
+        const Node& n = node(static_cast<std::uint32_t>(raw - 1));
+        if (n.generation != static_cast<std::uint32_t>(id >> 32) || n.slot == 0xFFFF) return nullptr;
+        return &n;
+    }
+
+    // ---------- Wheel lists ----------
+
+    void TimerWheel::insert(std::uint32_t idx) noexcept {
+        Node& n = node(idx);
+        const std::uint64_t delta = (n.expiry > _now) ? n.expiry - _now : 0;
+
+        int level = 0;
+        while (level < kLevels - 1 && delta >= (1ull << (kSlotBits * (level + 1))))
+            ++level;
+
+        // Past the top level's range: park at its far edge and re-file on cascade.
+        std::uint64_t when = n.expiry;
+        const std::uint64_t span = 1ull << (kSlotBits * kLevels);
+        if (delta >= span) when = _now + span - 1;
+
+        const std::uint32_t slot = static_cast<std::uint32_t>(when >> (kSlotBits * level)) & (kSlots - 1);
+        Level& lvl = _levels[level];
+
+        n.prev = kNil;
+        n.next = lvl.head[slot];
+        if (n.next != kNil) node(n.next).prev = idx;
+        lvl.head[slot] = idx;
+        lvl.occupied[slot >> 6] |= (1ull << (slot & 63));
+        n.slot = static_cast<std::uint16_t>(level * kSlots + slot);
+    }
+
+    void TimerWheel::unlink(std::uint32_t idx) noexcept {
+        Node& n = node(idx);
+        const std::uint32_t level = n.slot / kSlots;
+        const std::uint32_t slot = n.slot % kSlots;
+        Level& lvl = _levels[level];
+
+        if (n.prev != kNil) node(n.prev).next = n.next;
+        else lvl.head[slot] = n.next;
+        if (n.next != kNil) node(n.next).prev = n.prev;
+
+        if (lvl.head[slot] == kNil)
+            lvl.occupied[slot >> 6] &= ~(1ull << (slot & 63));
+        n.prev = n.next = kNil;
+        n.slot = 0xFFFF;
+    }
+
+    void TimerWheel::cascade(int level) noexcept {
+        Level& lvl = _levels[level];
+        const std::uint32_t slot = static_cast<std::uint32_t>(_now >> (kSlotBits * level)) & (kSlots - 1);
+
+        std::uint32_t idx = lvl.head[slot];
+        lvl.head[slot] = kNil;
+        lvl.occupied[slot >> 6] &= ~(1ull << (slot & 63));
+
+        while (idx != kNil) {
+            const std::uint32_t next = node(idx).next;
+            insert(idx); // re-file against the current time (lower level)
+            idx = next;
+        }
+    }
+
+    std::size_t TimerWheel::fireSlot(std::uint32_t slot) {
+        std::size_t fired = 0;
+        Level& lvl = _levels[0];
+
+        // Pop one at a time: a callback may cancel a sibling in this slot.
+        while (lvl.head[slot] != kNil) {
+            const std::uint32_t idx = lvl.head[slot];
+            Callback cb = std::move(node(idx).cb);
+            unlink(idx);
+            freeNode(idx);
+            --_pending;
+            ++fired;
+            try { cb(); }
+            catch (...) { /* keep the wheel alive */ }
+        }
+        return fired;
+    }
+
+    // ---------- Public ----------
+
+    bool TimerWheel::Cancel(TimerId id) noexcept {
+        const Node* n = lookup(id);
+        if (!n) return false;
+        const std::uint32_t idx = static_cast<std::uint32_t>((id & 0xFFFFFFFFull) - 1);
+        unlink(idx);
+        freeNode(idx);
+        --_pending;
+        return true;
+    }
+
+    bool TimerWheel::IsPending(TimerId id) const noexcept {
+        return lookup(id) != nullptr;
+    }
+
+    std::uint64_t TimerWheel::NextWakeMs() const noexcept {
+        if (_pending == 0) return (std::numeric_limits<std::uint64_t>::max)();
+
+        // Level 0 holds everything due before the next wrap; past that the
+        // wrap itself (a cascade) is the next thing that has to happen.
+        const std::uint64_t boundary = (_now | (kSlots - 1)) + 1;
+        const std::uint32_t from = (static_cast<std::uint32_t>(_now) & (kSlots - 1)) + 1;
+        if (from == kSlots) return boundary;
+
+        // Word-at-a-time scan of the occupancy bitmap from the slot after _now.
+        const Level& lvl = _levels[0];
+        std::uint32_t w = from >> 6;
+        std::uint64_t bits = lvl.occupied[w] & (~0ull << (from & 63));
+        for (;;) {
+            if (bits)
+                return (_now & ~static_cast<std::uint64_t>(kSlots - 1)) + (w << 6) + std::countr_zero(bits);
+            if (++w == kSlots / 64) return boundary;
+            bits = lvl.occupied[w];
+        }
+    }
+
+    std::size_t TimerWheel::Advance(std::uint64_t nowMs) {
+        std::size_t fired = 0;
+        while (_now < nowMs) {
+            // Skip straight to the next step that fires or cascades.
+            const std::uint64_t wake = NextWakeMs();
+            if (wake > nowMs) {
+                _now = nowMs;
+                break;
+            }
+            _now = wake;
+
+            const std::uint32_t slot0 = static_cast<std::uint32_t>(_now) & (kSlots - 1);
+            if (slot0 == 0) {
+                for (int level = 1; level < kLevels; ++level) {
+                    cascade(level);
+                    if (((_now >> (kSlotBits * level)) & (kSlots - 1)) != 0) break;
+                }
+            }
+            fired += fireSlot(slot0);
+        }
+        return fired;
+    }
+
+} // namespace MB
@@ -9,6 +9,13 @@
 // JSON schema: { v:1, id?:..., op:"...", args:{...} } -> replies mirror v/id and include ok/result|error.
 
 #include "MirrorBladeBridge.hpp"
+#include "MBConfig.hpp"
+#include "MBCoro.hpp"
+#include "MBFlightRecorder.hpp"
+#include "MBLog.hpp"
+#include "MBTaskQueue.hpp"
+#include "MBTimerWheel.hpp"
+#include "TGDKTelemetry.hpp"
 
 #include <RED4ext/RED4ext.hpp>
 #include <RED4ext/GameEngine.hpp>
@@ -20,12 +27,12 @@
 #include <nlohmann/json.hpp>
 
 #include <string>
+#include <string_view>
 #include <thread>
 #include <atomic>
 #include <unordered_map>
 #include <mutex>
 #include <functional>
-#include <queue>
 #include <optional>
 #include <chrono>
 #include <cstdarg>
@@ -110,44 +117,222 @@ static HANDLE g_pipe = INVALID_HANDLE_VALUE;
 static const wchar_t* PIPE_NAME = L"\\\\.\\pipe\\MirrorBladeBridge-v1";
 static const RED4ext::Sdk* g_sdk = nullptr; // saved if needed
 
-// ---------- Simple main-thread task queue ----------
-struct Task { std::function<void()> fn; };
-static std::mutex q_mtx;
-static std::queue<Task> q_tasks;
+// ---------- Main-thread task queue (lock-free MPSC, pooled nodes) ----------
+using TaskPriority = MB::GameTaskQueue::Priority;
+static MB::GameTaskQueue g_gameQ;
+
+// Frame budget for the pump; 0 disables that limit. Leftovers carry over.
+static std::atomic<uint32_t> g_tickBudgetUsec{ 1500 };
+static std::atomic<uint32_t> g_tickBudgetTasks{ 0 };
+
+// Rolling tick counters (written by the tick, read by tick.stats).
+static std::atomic<uint64_t> g_tickCount{ 0 };
+static std::atomic<uint64_t> g_tickTasksRun{ 0 };
+static std::atomic<uint64_t> g_tickDeferredTicks{ 0 };
+static std::atomic<uint64_t> g_tickOverruns{ 0 };
+static std::atomic<uint64_t> g_tickLastRun{ 0 };
+static std::atomic<uint64_t> g_tickLastDeferred{ 0 };
+static std::atomic<uint64_t> g_tickLastOverrunUsec{ 0 };
+
+template <class F>
+static void EnqueueOnGameThread(F&& fn, TaskPriority prio = TaskPriority::Normal)
+{
+    g_gameQ.Push(std::forward<F>(fn), prio);
+}
+
+// Optional floor between worker pumps (coalesces trickles); 0 = pump as soon as work arrives.
+static std::atomic<uint32_t> g_tickMinPeriodUsec{ 0 };
+
+// Frame pacing used by the worker when a budgeted pump left work behind and no
+// engine frame callback is driving the pump.
+static constexpr std::chrono::milliseconds kFallbackFramePeriod{ 8 };
+
+// While the engine calls MB::PumpOnce() every frame, the worker stands by.
+// If frames stop arriving for this long (loading screens, menus), it takes over.
+static constexpr std::chrono::milliseconds kFrameWatchdog{ 250 };
+static std::atomic<int64_t> g_lastFramePumpNs{ 0 };
+
+// The queue has exactly one consumer; whoever holds this pumps.
+static std::atomic_flag g_pumpBusy = ATOMIC_FLAG_INIT;
 
-static void EnqueueOnGameThread(std::function<void()> fn)
+static int64_t SteadyNowNs()
 {
-    std::lock_guard<std::mutex> lk(q_mtx);
-    q_tasks.push({ std::move(fn) });
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-static void PumpTasksOnTick()
+static bool FrameDriven()
 {
-    std::queue<Task> local;
-    {
-        std::lock_guard<std::mutex> lk(q_mtx);
-        std::swap(local, q_tasks);
-    }
-    while (!local.empty()) {
-        try { local.front().fn(); }
-        catch (...) { /* keep loop alive */ }
-        local.pop();
-    }
+    const int64_t last = g_lastFramePumpNs.load(std::memory_order_relaxed);
+    return last != 0 && SteadyNowNs() - last < std::chrono::nanoseconds(kFrameWatchdog).count();
+}
+
+// ---------- Delayed / TTL work (timing wheel) ----------
+// Owned by whoever holds g_pumpBusy: advanced before each pump and armed from
+// game-thread tasks, so it needs no lock of its own.
+static MB::TimerWheel g_timers;
+
+// Tagged expiries are keyed by a 64-bit hash of (scope, tag) so re-arming a
+// tag finds its entry without building a key string, and the wheel callback
+// captures only that id. The tag text is kept once, for the expiry's log line.
+using TagId = uint64_t;
+struct TagTimer {
+    MB::TimerWheel::TimerId timer{ MB::TimerWheel::kInvalidTimer };
+    std::string             tag;
+};
+static std::unordered_map<TagId, TagTimer> g_tagTimers;
+
+static TagId MakeTagId(std::string_view scope, std::string_view tag)
+{
+    uint64_t h = 1469598103934665603ULL; // FNV-1a
+    auto mix = [&h](std::string_view s) {
+        for (unsigned char c : s) { h ^= c; h *= 1099511628211ULL; }
+        };
+    mix(scope);
+    h ^= 0xFF; h *= 1099511628211ULL; // separator: ("a", "bc") != ("ab", "c")
+    mix(tag);
+    return h;
+}
+
+// Earliest timer deadline (steady ms) published for the fallback worker's wait.
+static std::atomic<uint64_t> g_nextTimerDueMs{ UINT64_MAX };
+static std::atomic<uint64_t> g_timersFired{ 0 };
+static std::atomic<uint64_t> g_timersPending{ 0 };
+
+static uint64_t SteadyNowMs()
+{
+    return static_cast<uint64_t>(SteadyNowNs() / 1'000'000);
+}
+
+static bool TimerDue()
+{
+    return g_nextTimerDueMs.load(std::memory_order_relaxed) <= SteadyNowMs();
+}
+
+// Game thread only. Arms a one-shot expiry for (scope, tag), replacing any
+// earlier one (re-issuing an op refreshes its TTL instead of stacking
+// expiries). onExpire(std::string_view tag) runs when it fires. Only the
+// first arm of a tag allocates; a refresh reuses its entry.
+template <class F>
+static void ArmTagged(std::string_view scope, std::string_view tag, uint32_t ms, F&& onExpire)
+{
+    const TagId id = MakeTagId(scope, tag);
+    auto [it, inserted] = g_tagTimers.try_emplace(id);
+    if (inserted) it->second.tag.assign(tag);
+    else g_timers.Cancel(it->second.timer);
+
+    it->second.timer = g_timers.Schedule(ms, [id, fn = std::forward<F>(onExpire)]() mutable {
+        auto entry = g_tagTimers.extract(id);
+        if (entry) fn(std::string_view(entry.mapped().tag));
+        });
+}
+
+// Game thread only. Returns true if a pending expiry was cancelled.
+static bool DisarmTagged(std::string_view scope, std::string_view tag = {})
+{
+    auto it = g_tagTimers.find(MakeTagId(scope, tag));
+    if (it == g_tagTimers.end()) return false;
+    const bool cancelled = g_timers.Cancel(it->second.timer);
+    g_tagTimers.erase(it);
+    return cancelled;
+}
+
+// ---------- Coroutine resumption (MB::NextTick / MB::Delay) ----------
+static void PostCoroutine(std::coroutine_handle<> h)
+{
+    EnqueueOnGameThread([h]() { h.resume(); }, TaskPriority::High);
+}
+
+// The due time is fixed by the caller's clock so time spent in the queue
+// counts towards the delay; the timer itself is armed from the game thread.
+static void PostCoroutineAfter(std::coroutine_handle<> h, uint32_t ms)
+{
+    const uint64_t dueMs = SteadyNowMs() + ms;
+    EnqueueOnGameThread([h, dueMs]() {
+        const uint64_t now = g_timers.NowMs();
+        g_timers.Schedule(dueMs > now ? dueMs - now : 0, [h]() { h.resume(); });
+        }, TaskPriority::High);
+}
+
+// Returns true if work was left queued for a later tick.
+static bool PumpTasksOnTick()
+{
+    if (g_pumpBusy.test_and_set(std::memory_order_acquire))
+        return !g_gameQ.Empty(); // the other driver is pumping right now
+
+    MB::GameTaskQueue::Budget budget;
+    budget.time = std::chrono::microseconds(g_tickBudgetUsec.load(std::memory_order_relaxed));
+    budget.maxTasks = g_tickBudgetTasks.load(std::memory_order_relaxed);
+
+    // Expired timers first; they run outside the task budget (they are cheap
+    // flips back to a default state and must not slip behind a backlog).
+    const size_t fired = g_timers.Advance(SteadyNowMs());
+    const auto r = g_gameQ.Pump(budget);
+
+    g_nextTimerDueMs.store(g_timers.NextWakeMs(), std::memory_order_relaxed);
+    g_timersPending.store(g_timers.Pending(), std::memory_order_relaxed);
+    g_pumpBusy.clear(std::memory_order_release);
+
+    if (fired) g_timersFired.fetch_add(fired, std::memory_order_relaxed);
+
+    g_tickCount.fetch_add(1, std::memory_order_relaxed);
+    if (r.ran == 0 && r.deferred == 0) return false;
+
+    g_tickTasksRun.fetch_add(r.ran, std::memory_order_relaxed);
+    if (r.deferred) g_tickDeferredTicks.fetch_add(1, std::memory_order_relaxed);
+    if (r.overrunUsec) g_tickOverruns.fetch_add(1, std::memory_order_relaxed);
+    g_tickLastRun.store(r.ran, std::memory_order_relaxed);
+    g_tickLastDeferred.store(r.deferred, std::memory_order_relaxed);
+    g_tickLastOverrunUsec.store(r.overrunUsec, std::memory_order_relaxed);
+
+    // a=tasks run, b=tasks deferred, c=overrun (usec)
+    MB::TGDKTelemetry::Get().Push("tick.pump",
+        static_cast<double>(r.ran), static_cast<double>(r.deferred), static_cast<double>(r.overrunUsec));
+    return r.deferred != 0;
 }
 
 namespace MB {
-    void PumpOnce() { PumpTasksOnTick(); }
+    // Engine frame callback entry: pumps on the calling (game) thread and marks
+    // the bridge as frame-driven so the fallback worker stands down.
+    void PumpOnce()
+    {
+        g_lastFramePumpNs.store(SteadyNowNs(), std::memory_order_relaxed);
+        PumpTasksOnTick();
+    }
 }
 
-// A lightweight tick worker so queued tasks still run.
-// Not guaranteed to be the game thread; replace later with a real game-tick hook.
+// Fallback tick worker: sleeps until a producer signals the queue, so idle cost
+// is zero and queue latency is a wakeup rather than a fixed 8 ms poll.
+// Not the game thread; when the engine frame callback is live it only watches.
 static void TickWorker()
 {
+    using clock = std::chrono::steady_clock;
+
     g_tickRunning = true;
     MB_Log("Tick worker started.");
+
+    auto nextPumpAt = clock::time_point{};
     while (g_running.load()) {
-        PumpTasksOnTick();
-        std::this_thread::sleep_for(std::chrono::milliseconds(8)); // ~120 Hz
+        if (FrameDriven()) {
+            // The frame callback owns the pump; re-check in case frames stop arriving.
+            std::this_thread::sleep_for(kFrameWatchdog);
+            continue;
+        }
+
+        // Sleep until work arrives or the next timer is due.
+        const uint64_t dueMs = g_nextTimerDueMs.load(std::memory_order_relaxed);
+        g_gameQ.WaitUntil(dueMs == UINT64_MAX ? clock::time_point::max()
+            : clock::time_point(std::chrono::milliseconds(dueMs)));
+        if (!g_running.load()) break;
+        if (FrameDriven() || (g_gameQ.Empty() && !TimerDue())) continue;
+
+        if (clock::now() < nextPumpAt)
+            std::this_thread::sleep_until(nextPumpAt);
+
+        const bool carried = PumpTasksOnTick();
+
+        const auto minPeriod = std::chrono::microseconds(g_tickMinPeriodUsec.load(std::memory_order_relaxed));
+        nextPumpAt = clock::now() + (carried ? std::max<clock::duration>(minPeriod, kFallbackFramePeriod) : minPeriod);
     }
     g_tickRunning = false;
     MB_Log("Tick worker stopped.");
@@ -191,6 +376,10 @@ static void Op_UI_Toast(const json& req, OpReply reply)
     EnqueueOnGameThread([req, reply, ms, text]() {
         MB_Logf("[toast] %s (%d ms)", text.c_str(), ms);
         // TODO: Display in Ink/UI if desired
+        ArmTagged("ui.toast", {}, static_cast<uint32_t>(ms), [](std::string_view) {
+            MB_Log("[toast] expired");
+            // TODO: Hide the Ink toast
+            });
         ReplyOk(req, reply, { {"status", "shown"}, {"ms", ms} });
         });
 }
@@ -206,7 +395,7 @@ static void Op_TimeScale_Set(const json& req, OpReply reply)
         MB_Logf("[timescale] -> %.3f", scale);
         // TODO: Apply via game RTTI
         ReplyOk(req, reply, { {"scale", scale} });
-        });
+        }, TaskPriority::High);
 }
 
 static void Op_LOD_Pin(const json& req, OpReply reply)
@@ -217,8 +406,11 @@ static void Op_LOD_Pin(const json& req, OpReply reply)
     EnqueueOnGameThread([req, reply, ttl, tag]() {
         MB_Logf("[lod.pin] tag=%s ttl=%d", tag.c_str(), ttl);
         // TODO: LOD pin impl
+        ArmTagged("lod.pin", tag, static_cast<uint32_t>(ttl), [](std::string_view t) {
+            MB_Logf("[lod.pin] tag=%.*s expired", static_cast<int>(t.size()), t.data());
+            });
         ReplyOk(req, reply, { {"pinned", true}, {"ttl", ttl}, {"tag", tag} });
-        });
+        }, TaskPriority::Low);
 }
 
 static void Op_Traffic_Mul(const json& req, OpReply reply)
@@ -253,9 +445,24 @@ static void Op_NPC_Teleport(const json& req, OpReply reply) {
 }
 
 // --- Vehicle ---
+// Spawn, give the entity a frame to attach, then apply the requested speed.
+static MB::Task<> VehicleSpawnFlow(json req, OpReply reply, std::string id, double speed)
+{
+    co_await MB::NextTick();
+    MB_Logf("[vehicle] spawn %s", id.c_str());
+    // TODO: Spawn via game RTTI
+
+    co_await MB::NextTick();
+    MB_Logf("[vehicle] %s speed -> %.2f", id.c_str(), speed);
+    // TODO: Set speed on the attached entity
+    ReplyOk(req, reply, { {"vehicle", id}, {"spawned", true}, {"speed", speed} });
+}
+
 static void Op_Vehicle_Spawn(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
     std::string id = args.value("id", std::string("Vehicle.v_default"));
+    if (args.contains("speed"))
+        return MB::Spawn(VehicleSpawnFlow(req, reply, id, args["speed"].get<double>()));
     ReplyOk(req, reply, { {"vehicle", id}, {"spawned", true} });
 }
 static void Op_Vehicle_Despawn(const json& req, OpReply reply) {
@@ -279,8 +486,29 @@ static void Op_Vehicle_Repair(const json& req, OpReply reply) {
 
 // --- Traffic ---
 static void Op_Traffic_Clear(const json& req, OpReply reply) { ReplyOk(req, reply, { {"traffic", "cleared"} }); }
-static void Op_Traffic_Freeze(const json& req, OpReply reply) { ReplyOk(req, reply, { {"traffic", "frozen"} }); }
-static void Op_Traffic_Unfreeze(const json& req, OpReply reply) { ReplyOk(req, reply, { {"traffic", "unfrozen"} }); }
+// Optional args.ms bounds the freeze; it thaws on its own when the window ends.
+static void Op_Traffic_Freeze(const json& req, OpReply reply) {
+    const auto& args = req.value("args", json::object());
+    int ms = std::max(0, args.value("ms", 0));
+    EnqueueOnGameThread([req, reply, ms]() {
+        MB_Logf("[traffic] freeze (%d ms)", ms);
+        if (ms > 0) {
+            ArmTagged("traffic.freeze", {}, static_cast<uint32_t>(ms), [](std::string_view) {
+                MB_Log("[traffic] freeze window over -> unfrozen");
+                });
+        }
+        else {
+            DisarmTagged("traffic.freeze");
+        }
+        ReplyOk(req, reply, { {"traffic", "frozen"}, {"ms", ms} });
+        });
+}
+static void Op_Traffic_Unfreeze(const json& req, OpReply reply) {
+    EnqueueOnGameThread([req, reply]() {
+        DisarmTagged("traffic.freeze");
+        ReplyOk(req, reply, { {"traffic", "unfrozen"} });
+        });
+}
 static void Op_Traffic_Route(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
     auto route = args.value("route", json::array());
@@ -337,16 +565,28 @@ static void Op_UI_Alert(const json& req, OpReply reply) {
     int ms = std::max(1, args.value("ms", 2000));
     ReplyOk(req, reply, { {"type","alert"},{"text",text},{"ms",ms} });
 }
+// Optional args.ttl (ms) removes the marker automatically.
 static void Op_UI_Marker_Add(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
     auto pos = args.value("pos", json::object());
     std::string tag = args.value("tag", std::string("marker"));
-    ReplyOk(req, reply, { {"marker","added"},{"tag",tag},{"pos",pos} });
+    int ttl = std::max(0, args.value("ttl", 0));
+    EnqueueOnGameThread([req, reply, pos, tag, ttl]() {
+        if (ttl > 0) {
+            ArmTagged("ui.marker", tag, static_cast<uint32_t>(ttl), [](std::string_view t) {
+                MB_Logf("[marker] tag=%.*s expired -> removed", static_cast<int>(t.size()), t.data());
+                });
+        }
+        ReplyOk(req, reply, { {"marker","added"},{"tag",tag},{"pos",pos},{"ttl",ttl} });
+        });
 }
 static void Op_UI_Marker_Remove(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
     std::string tag = args.value("tag", std::string("marker"));
-    ReplyOk(req, reply, { {"marker","removed"},{"tag",tag} });
+    EnqueueOnGameThread([req, reply, tag]() {
+        DisarmTagged("ui.marker", tag);
+        ReplyOk(req, reply, { {"marker","removed"},{"tag",tag} });
+        });
 }
 static void Op_UI_HUD_Toggle(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
@@ -432,12 +672,20 @@ static void Op_World_LOD_Lock(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
     int ttl = std::max(1, args.value("ttl", 3000));
     std::string tag = args.value("tag", std::string("lodlock"));
-    ReplyOk(req, reply, { {"lodLocked", true},{"ttl",ttl},{"tag",tag} });
+    EnqueueOnGameThread([req, reply, ttl, tag]() {
+        ArmTagged("world.lod.lock", tag, static_cast<uint32_t>(ttl), [](std::string_view t) {
+            MB_Logf("[lod.lock] tag=%.*s ttl expired -> unlocked", static_cast<int>(t.size()), t.data());
+            });
+        ReplyOk(req, reply, { {"lodLocked", true},{"ttl",ttl},{"tag",tag} });
+        });
 }
 static void Op_World_LOD_Unlock(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
     std::string tag = args.value("tag", std::string("lodlock"));
-    ReplyOk(req, reply, { {"lodLocked", false},{"tag",tag} });
+    EnqueueOnGameThread([req, reply, tag]() {
+        DisarmTagged("world.lod.lock", tag);
+        ReplyOk(req, reply, { {"lodLocked", false},{"tag",tag} });
+        });
 }
 
 // --- Debug / Telemetry ---
@@ -455,18 +703,49 @@ static void Op_Debug_Capture_Screenshot(const json& req, OpReply reply) {
 }
 
 // --- Config / Introspection ---
+// Keys are JSON pointers into MirrorBlade.json ("/trafficBoost",
+// "/logging/retention/keep"); dotted names ("logging.level") still work.
+// A set takes effect at once and reaches the file after a quiet period
+// (MB::SetConfigValue). A log module set to null or "inherit" drops its
+// override; getting a module without one reports the level it inherits.
+static constexpr char kLogModulesPtr[] = "/logging/modules/";
+
+static std::string ConfigPointer(const std::string& key)
+{
+    if (key.empty() || key[0] == '/') return key;
+    std::string p = "/" + key;
+    std::replace(p.begin(), p.end(), '.', '/');
+    return p;
+}
+
+static bool IsLogModulePtr(const std::string& ptr, MB::LogModule& mod)
+{
+    return ptr.rfind(kLogModulesPtr, 0) == 0
+        && MB::LogModuleFromName(ptr.substr(sizeof(kLogModulesPtr) - 1), mod);
+}
+
 static void Op_Config_Set(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
-    std::string key = args.value("key", std::string());
+    const std::string ptr = ConfigPointer(args.value("key", std::string()));
     json value = args.value("value", json());
-    if (key.empty()) { return ReplyErr(req, reply, "BadArgs", "key required"); }
-    ReplyOk(req, reply, { {"set", key}, {"value", value} });
+    if (ptr.empty()) { return ReplyErr(req, reply, "BadArgs", "key required"); }
+    MB::LogModule mod{};
+    if (value == "inherit" && IsLogModulePtr(ptr, mod)) value = nullptr;
+
+    std::string effective, err;
+    if (!MB::SetConfigValue(ptr, value.dump(), effective, err)) { return ReplyErr(req, reply, "BadArgs", ptr + ": " + err); }
+    ReplyOk(req, reply, { {"set", ptr}, {"value", json::parse(effective)} });
 }
 static void Op_Config_Get(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
-    std::string key = args.value("key", std::string());
-    if (key.empty()) { return ReplyErr(req, reply, "BadArgs", "key required"); }
-    ReplyOk(req, reply, { {"key", key}, {"value", "(stub)"} });
+    const std::string ptr = ConfigPointer(args.value("key", std::string()));   // "" = everything
+    std::string text;
+    if (MB::GetConfigValue(ptr, text)) { return ReplyOk(req, reply, { {"key", ptr}, {"value", json::parse(text)} }); }
+    MB::LogModule mod{};
+    if (IsLogModulePtr(ptr, mod)) {
+        return ReplyOk(req, reply, { {"key", ptr}, {"value", MB::LogLevelName(MB::Log().ModuleLevel(mod))}, {"inherited", true} });
+    }
+    ReplyErr(req, reply, "BadArgs", ptr + ": unknown key");
 }
 static void Op_Ops_Capabilities(const json& req, OpReply reply) {
     json caps = json::array({
@@ -482,6 +761,7 @@ static void Op_Ops_Capabilities(const json& req, OpReply reply) {
         "av.spawn","av.route.set","av.despawn","av.land","av.takeoff",
         "train.persist","train.spawn","train.despawn","train.freeze","train.unfreeze",
         "debug.log","debug.capture.screenshot","config.set","config.get","ops.capabilities","lod.pin","ping",
+        "tick.budget","tick.stats",
         "upscaler.enable","upscaler.set","graphics.target.set","graphics.internal.scale"
         });
 #if MB_HAS_LIGHTSFAKE
@@ -492,6 +772,50 @@ static void Op_Ops_Capabilities(const json& req, OpReply reply) {
 #endif
     ReplyOk(req, reply, { {"capabilities", caps} });
 }
+static void Op_Tick_Budget(const json& req, OpReply reply) {
+    const auto& args = req.value("args", json::object());
+    if (args.contains("ms")) {
+        const double ms = std::clamp(args["ms"].get<double>(), 0.0, 100.0);
+        g_tickBudgetUsec.store(static_cast<uint32_t>(ms * 1000.0), std::memory_order_relaxed);
+    }
+    if (args.contains("tasks"))
+        g_tickBudgetTasks.store(static_cast<uint32_t>(std::max(0, args["tasks"].get<int>())), std::memory_order_relaxed);
+    if (args.contains("minPeriodMs")) {
+        const double ms = std::clamp(args["minPeriodMs"].get<double>(), 0.0, 1000.0);
+        g_tickMinPeriodUsec.store(static_cast<uint32_t>(ms * 1000.0), std::memory_order_relaxed);
+    }
+    ReplyOk(req, reply, {
+        {"ms", g_tickBudgetUsec.load(std::memory_order_relaxed) / 1000.0},
+        {"tasks", g_tickBudgetTasks.load(std::memory_order_relaxed)},
+        {"minPeriodMs", g_tickMinPeriodUsec.load(std::memory_order_relaxed) / 1000.0},
+        {"frameDriven", FrameDriven()} });
+}
+static void Op_Tick_Stats(const json& req, OpReply reply) {
+    const auto qs = g_gameQ.GetStats();
+    const auto cs = MB::GetCoroStats();
+    const auto ls = MB::Log().GetStats();
+    ReplyOk(req, reply, {
+        {"ticks", g_tickCount.load(std::memory_order_relaxed)},
+        {"tasksRun", g_tickTasksRun.load(std::memory_order_relaxed)},
+        {"deferredTicks", g_tickDeferredTicks.load(std::memory_order_relaxed)},
+        {"overruns", g_tickOverruns.load(std::memory_order_relaxed)},
+        {"last", {
+            {"ran", g_tickLastRun.load(std::memory_order_relaxed)},
+            {"deferred", g_tickLastDeferred.load(std::memory_order_relaxed)},
+            {"overrunUsec", g_tickLastOverrunUsec.load(std::memory_order_relaxed)} }},
+        {"pending", { {"high", qs.pending[0]}, {"normal", qs.pending[1]}, {"low", qs.pending[2]} }},
+        {"heapFallbacks", qs.heapFallbacks},
+        {"poolNodes", qs.poolNodes},
+        {"timers", {
+            {"pending", g_timersPending.load(std::memory_order_relaxed)},
+            {"fired", g_timersFired.load(std::memory_order_relaxed)} }},
+        {"coro", { {"slabBytes", cs.slabBytes}, {"heapFrames", cs.heapFrames} }},
+        {"log", {
+            {"lines", ls.lines},
+            {"dropped", ls.dropped},
+            {"batches", ls.batches},
+            {"rotations", ls.rotations} }} });
+}
 static void Op_Ping(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
     std::string echo = args.value("echo", std::string("pong"));
@@ -562,22 +886,37 @@ static void Op_Graphics_Internal_Scale(const json& req, OpReply reply)
 
 #if MB_HAS_LIGHTSFAKE
 // ---- Optional LightFilter JSON ops ----
+// Optional args.ms makes a toggle temporary: it flips back when the window ends.
+// LightFilter exposes no getters, so the revert is simply the opposite value.
+template <class Set>
+static void ArmLightsRevert(const char* key, const json& args, bool on, Set set)
+{
+    int ms = std::max(0, args.value("ms", 0));
+    EnqueueOnGameThread([key, ms, on, set]() {
+        if (ms > 0) ArmTagged(key, {}, static_cast<uint32_t>(ms), [on, set](std::string_view) { set(!on); });
+        else DisarmTagged(key);
+        });
+}
+
 static void Op_LightsFake_Adverts(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
     bool on = args.value("enabled", true);
     MB::LightFilter::Get().SetAdverts(on);
+    ArmLightsRevert("lights.fake.adverts", args, on, [](bool v) { MB::LightFilter::Get().SetAdverts(v); });
     ReplyOk(req, reply, { {"adverts", on} });
 }
 static void Op_LightsFake_Portals(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
     bool on = args.value("enabled", false);
     MB::LightFilter::Get().SetPortals(on);
+    ArmLightsRevert("lights.fake.portals", args, on, [](bool v) { MB::LightFilter::Get().SetPortals(v); });
     ReplyOk(req, reply, { {"portals", on} });
 }
 static void Op_LightsFake_ForcePortals(const json& req, OpReply reply) {
     const auto& args = req.value("args", json::object());
     bool on = args.value("enabled", false);
     MB::LightFilter::Get().SetForcePortals(on);
+    ArmLightsRevert("lights.fake.forceportals", args, on, [](bool v) { MB::LightFilter::Get().SetForcePortals(v); });
     ReplyOk(req, reply, { {"forcePortals", on} });
 }
 static void Op_LightsFake_Sweep(const json& req, OpReply reply) {
@@ -661,6 +1000,8 @@ static void RegisterOps()
 
     g_opTable.emplace("ops.capabilities", &Op_Ops_Capabilities);
     g_opTable.emplace("ping", &Op_Ping);
+    g_opTable.emplace("tick.budget", &Op_Tick_Budget);
+    g_opTable.emplace("tick.stats", &Op_Tick_Stats);
 
     g_opTable.emplace("upscaler.enable", &Op_Upscaler_Enable);
     g_opTable.emplace("upscaler.set", &Op_Upscaler_Set);
@@ -722,9 +1063,12 @@ static void ServerWorker()
             auto it = g_opTable.find(op);
             if (it == g_opTable.end()) { ReplyErr(req, reply, "UnknownOp", op); continue; }
 
+            const int64_t t0 = SteadyNowNs();
+            bool failed = false;
             try { it->second(req, reply); }
-            catch (const std::exception& e) { ReplyErr(req, reply, "Exception", e.what()); }
-            catch (...) { ReplyErr(req, reply, "Exception", "unknown"); }
+            catch (const std::exception& e) { failed = true; ReplyErr(req, reply, "Exception", e.what()); }
+            catch (...) { failed = true; ReplyErr(req, reply, "Exception", "unknown"); }
+            MB::Flight().Op(op, (SteadyNowNs() - t0) / 1000, failed);
         }
 
         FlushFileBuffers(g_pipe);
@@ -746,6 +1090,7 @@ namespace MB
         g_sdk = sdk;
 
         RegisterOps();
+        MB::SetGameThreadHooks({ &PostCoroutine, &PostCoroutineAfter });
 
         g_running = true;
         std::thread(ServerWorker).detach();
@@ -767,6 +1112,7 @@ namespace MB
         }
 
         // Let tick worker wind down
+        g_gameQ.Wake();
         for (int i = 0; i < 50 && g_tickRunning.load(); ++i)
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
 
@@ -3,8 +3,11 @@
 #include <mutex>
 #include <string>
 #include <functional>
+#include <chrono>
 #include <nlohmann/json.hpp>
 
+#include "MBFlightRecorder.hpp"
+
 // ---- Minimal, compatible declaration of MB::Ops ----
 // (Keep in sync with your header; this just ensures this TU knows the type.)
 namespace MB {
@@ -58,7 +61,22 @@ namespace MB {
             }
             fn = it->second;
         }
-        return fn ? fn(payload) : nlohmann::json{ {"error","op_null"},{"name",name} };
+        if (!fn) return nlohmann::json{ {"error","op_null"},{"name",name} };
+
+        // Every dispatch lands in the crash flight recorder, failed or not.
+        const auto t0 = std::chrono::steady_clock::now();
+        const auto usec = [&t0] {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+        };
+        try {
+            nlohmann::json out = fn(payload);
+            Flight().Op(name, usec(), false);
+            return out;
+        }
+        catch (...) {
+            Flight().Op(name, usec(), true);
+            throw;
+        }
     }
 
 } // namespace MB
@@ -10,10 +10,12 @@
 
 #if __has_include("MBLog.hpp")
 #include "MBLog.hpp"
-#define MBLOGI(fmt, ...) MB::Log().Log(MB::LogLevel::Info,  fmt, __VA_ARGS__)
-#define MBLOGW(fmt, ...) MB::Log().Log(MB::LogLevel::Warn,  fmt, __VA_ARGS__)
-#define MBLOGE(fmt, ...) MB::Log().Log(MB::LogLevel::Error, fmt, __VA_ARGS__)
+#define MBLOGD(fmt, ...) MB_LOGD(Loader, fmt, ##__VA_ARGS__)
+#define MBLOGI(fmt, ...) MB_LOGI(Loader, fmt, ##__VA_ARGS__)
+#define MBLOGW(fmt, ...) MB_LOGW(Loader, fmt, ##__VA_ARGS__)
+#define MBLOGE(fmt, ...) MB_LOGE(Loader, fmt, ##__VA_ARGS__)
 #else
+#define MBLOGD(...) (void)0
 #define MBLOGI(...) (void)0
 #define MBLOGW(...) (void)0
 #define MBLOGE(...) (void)0
@@ -378,6 +380,7 @@ namespace MB {
             if (res.ok) {
                 _staged[name] = res.value;
                 envChain[name] = res.value; // allow chaining
+                MBLOGD("CompoundLoader: %s = %g", name.c_str(), res.value);
             }
             else {
                 MBLOGW("CompoundLoader: '%s' failed: %s", name.c_str(), res.error.c_str());
@@ -1,4 +1,5 @@
 ﻿#include "TGDKTelemetry.hpp"
+#include "MBFlightRecorder.hpp"
 
 #include <algorithm>
 #include <sstream>
@@ -124,6 +125,9 @@ namespace MB {
     void TGDKTelemetry::Push(std::string_view name,
         double a, double b, double c,
         std::string_view tag) {
+        // The flight recorder is a local crash aid; it records regardless of opt-in.
+        Flight().Event(name, a, b, c);
+
         std::scoped_lock lk(_mx);
         if (!_optIn) return;
 
@@ -141,6 +145,8 @@ namespace MB {
     }
 
     void TGDKTelemetry::Push(const Event& eIn) {
+        Flight().Event(eIn.name, eIn.a, eIn.b, eIn.c);
+
         std::scoped_lock lk(_mx);
         if (!_optIn) return;
 
@@ -157,6 +163,8 @@ namespace MB {
     }
 
     void TGDKTelemetry::Push(Event&& eIn) {
+        Flight().Event(eIn.name, eIn.a, eIn.b, eIn.c);
+
         std::scoped_lock lk(_mx);
         if (!_optIn) return;
 
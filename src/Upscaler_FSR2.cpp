@@ -212,7 +212,8 @@ void MB::Upscaler_Evaluate_D3D12(ID3D12GraphicsCommandList* cmdList) {
 
     // Validate resources
     if (!g_res.color || !g_res.depth || !g_res.motionVectors) {
-        Upscaler_Log("FSR2: missing inputs (color/depth/mv). Skipping.");
+        MB_LOGD(Upscaler, "FSR2: missing inputs (color=%p depth=%p mv=%p), skipping frame",
+            g_res.color, g_res.depth, g_res.motionVectors);
         return;
     }
 
@@ -255,9 +256,14 @@ void MB::Upscaler_Evaluate_D3D12(ID3D12GraphicsCommandList* cmdList) {
 
     d.frameTimeDelta = g_params.deltaTime;
 
+    // Per frame; a single level load unless the upscaler module is at trace.
+    MB_LOGT(Upscaler, "FSR2: dispatch %ux%u jitter=(%.4f,%.4f) dt=%.4f sharp=%.2f reset=%d",
+        d.renderSize.width, d.renderSize.height, d.jitterOffset.x, d.jitterOffset.y,
+        d.frameTimeDelta, d.sharpness, d.reset ? 1 : 0);
+
     const auto rc = ffxFsr2ContextDispatch(&g_fsr2Ctx, &d);
     if (rc != FFX_OK) {
-        Upscaler_Logf("FFX: Dispatch failed rc=%d", rc);
+        MB_LOGE(Upscaler, "FFX: Dispatch failed rc=%d", static_cast<int>(rc));
     }
 
     // Clear the reset flag after use
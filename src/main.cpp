@@ -1,6 +1,16 @@
 #include <RED4ext/RED4ext.hpp>
 #include "MirrorBladeBridge.hpp"
 
+// Engine frame callback: the Running game state updates once per frame on the
+// main thread, which is exactly where the bridge's queued ops should run.
+static bool OnRunningUpdate(RED4ext::CGameApplication* /*app*/)
+{
+    MB::PumpOnce();
+    return false; // stay in Running
+}
+
+static RED4ext::GameState g_runningState{ nullptr, &OnRunningUpdate, nullptr };
+
 RED4EXT_C_EXPORT uint32_t RED4EXT_CALL Supports()
 {
     return RED4EXT_API_VERSION_LATEST;
@@ -25,6 +35,8 @@ RED4EXT_C_EXPORT bool RED4EXT_CALL Main(RED4ext::PluginHandle aHandle,
     {
     case EMainReason::Load:
         MB::InitBridge(aSdk);   // <-- pass the SDK
+        if (aSdk && aSdk->gameStates)
+            aSdk->gameStates->Add(aHandle, RED4ext::EGameStateType::Running, &g_runningState);
         break;
     case EMainReason::Unload:
         MB::ShutdownBridge();
@@ -0,0 +1,223 @@
+// tools/mb_flightdump.cpp - prints a MirrorBlade crash flight recorder file
+//
+//   mb_flightdump [-o out.txt] MirrorBladeBridge.crash.flight
+//
+// The file is the recorder's shared mapping as the process left it (after a
+// crash, the logger moves it to <name>.crash.flight on the next start). The
+// complete records are printed oldest first, in the log text format, with op
+// dispatches and telemetry events interleaved; a slot that was being written
+// when the process died is skipped. Works on a live file too (a copy of it,
+// on Windows), as a snapshot.
+#include "MBFlightFormat.hpp"
+#include "MBLogFormat.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    using namespace MB::FlightWire;
+
+    struct Site {
+        std::uint8_t  level{ 0 };
+        std::uint8_t  module{ 0 };
+        std::uint32_t line{ 0 };
+        std::string   file;
+        std::string   fmt;
+    };
+
+    void Stamp(std::string& out, std::int64_t wallNs) {
+        const std::time_t t = static_cast<std::time_t>(wallNs / 1'000'000'000);
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        char stamp[48];
+        std::size_t n = std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+        n += static_cast<std::size_t>(std::snprintf(stamp + n, sizeof(stamp) - n, ".%06u ",
+            static_cast<unsigned>((wallNs / 1000) % 1'000'000)));
+        out.append(stamp, n);
+    }
+
+    void Tag(std::string& out, const char* level, std::uint8_t module) {
+        out.push_back('[');
+        out.append(level);
+        out.append("] ", 2);
+        if (module) {
+            out.push_back('[');
+            out.append(MB::LogWire::ModuleName(module));
+            out.append("] ", 2);
+        }
+    }
+
+    // LogWire 'S' entries up to the first byte that does not start one.
+    std::unordered_map<std::uint32_t, Site> ReadSites(const unsigned char* p, std::size_t n) {
+        std::unordered_map<std::uint32_t, Site> sites;
+        const unsigned char* const end = p + n;
+        auto take = [&p, end](void* v, std::size_t k) {
+            if (static_cast<std::size_t>(end - p) < k) return false;
+            std::memcpy(v, p, k);
+            p += k;
+            return true;
+        };
+        while (p < end && *p == MB::LogWire::kSite) {
+            ++p;
+            std::uint32_t id; Site s; std::uint16_t len;
+            if (!take(&id, 4) || !take(&s.level, 1) || !take(&s.module, 1) || !take(&s.line, 4)) break;
+            if (!take(&len, 2) || static_cast<std::size_t>(end - p) < len) break;
+            s.file.assign(reinterpret_cast<const char*>(p), len);
+            p += len;
+            if (!take(&len, 2) || static_cast<std::size_t>(end - p) < len) break;
+            s.fmt.assign(reinterpret_cast<const char*>(p), len);
+            p += len;
+            sites[id] = std::move(s);
+        }
+        return sites;
+    }
+
+    const char* StateName(std::uint32_t state) {
+        switch (state) {
+        case kLive:    return "live (process still running, or killed)";
+        case kClean:   return "clean shutdown";
+        case kCrashed: return "crashed";
+        default:       return "unknown";
+        }
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* outPath = nullptr;
+    const char* inPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "-o") && i + 1 < argc) outPath = argv[++i];
+        else inPath = argv[i];
+    }
+    if (!inPath) {
+        std::fprintf(stderr, "usage: %s [-o out.txt] file.flight\n", argv[0]);
+        return 2;
+    }
+
+    std::ifstream in(inPath, std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "mb_flightdump: cannot open %s\n", inPath);
+        return 1;
+    }
+    const std::string raw((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const auto* data = reinterpret_cast<const unsigned char*>(raw.data());
+
+    Header h{};
+    if (raw.size() < kHeaderBytes || (std::memcpy(&h, data, sizeof(h)), std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0)) {
+        std::fprintf(stderr, "mb_flightdump: %s is not a flight recorder file\n", inPath);
+        return 1;
+    }
+    if (h.version != kVersion) {
+        std::fprintf(stderr, "mb_flightdump: %s has version %u, expected %u\n", inPath, h.version, kVersion);
+        return 1;
+    }
+    const std::size_t slotsAt = kHeaderBytes + h.siteBytes;
+    if (h.slotBytes < sizeof(SlotHeader) || h.slotCount == 0
+        || raw.size() < slotsAt + static_cast<std::size_t>(h.slotBytes) * h.slotCount) {
+        std::fprintf(stderr, "mb_flightdump: %s is truncated\n", inPath);
+        return 1;
+    }
+
+    const auto sites = ReadSites(data + kHeaderBytes, std::min<std::size_t>(h.siteUsed, h.siteBytes));
+
+    // Complete slots, oldest first.
+    std::vector<std::pair<std::uint64_t, const unsigned char*>> slots;
+    slots.reserve(h.slotCount);
+    std::size_t torn = 0;
+    for (std::uint32_t i = 0; i < h.slotCount; ++i) {
+        const unsigned char* s = data + slotsAt + static_cast<std::size_t>(i) * h.slotBytes;
+        std::uint64_t seq;
+        std::memcpy(&seq, s, sizeof(seq));
+        if (seq == 0) {
+            if (i < h.next) ++torn;
+            continue;
+        }
+        if ((seq - 1) % h.slotCount != i) { ++torn; continue; }
+        slots.emplace_back(seq, s);
+    }
+    std::sort(slots.begin(), slots.end());
+
+    std::string out;
+    char head[160];
+    std::snprintf(head, sizeof(head), "# pid %u, %s, %llu records written, %zu kept, %u skipped\n",
+        h.pid, StateName(h.state), static_cast<unsigned long long>(h.next), slots.size(), h.skipped);
+    out.append(head);
+
+    std::string text;
+    for (const auto& [seq, s] : slots) {
+        SlotHeader sh;
+        std::memcpy(&sh, s, sizeof(sh));
+        const unsigned char* p = s + sizeof(SlotHeader);
+        const std::size_t len = std::min<std::size_t>(sh.len, h.slotBytes - sizeof(SlotHeader));
+
+        Stamp(out, sh.wallNs);
+        text.clear();
+        switch (sh.kind) {
+        case kText:
+            Tag(out, MB::LogWire::LevelName(sh.level), sh.module);
+            out.append(reinterpret_cast<const char*>(p), len);
+            break;
+        case kRecord: {
+            Tag(out, MB::LogWire::LevelName(sh.level), sh.module);
+            const auto it = sites.find(sh.site);
+            if (it == sites.end()) out.append("<undefined site " + std::to_string(sh.site) + ">");
+            else {
+                MB::LogWire::Format(it->second.fmt.c_str(), p, len, text);
+                out.append(text);
+            }
+            break;
+        }
+        case kOp: {
+            std::int64_t usec = 0;
+            if (len >= sizeof(usec)) std::memcpy(&usec, p, sizeof(usec));
+            Tag(out, "OP", 0);
+            out.append(reinterpret_cast<const char*>(p) + sizeof(usec), len >= sizeof(usec) ? len - sizeof(usec) : 0);
+            std::snprintf(head, sizeof(head), " %lld us%s", static_cast<long long>(usec), (sh.flags & kOpFailed) ? " FAILED" : "");
+            out.append(head);
+            break;
+        }
+        case kEvent: {
+            double v[3]{};
+            if (len >= sizeof(v)) std::memcpy(v, p, sizeof(v));
+            Tag(out, "EVENT", 0);
+            out.append(reinterpret_cast<const char*>(p) + sizeof(v), len >= sizeof(v) ? len - sizeof(v) : 0);
+            std::snprintf(head, sizeof(head), " a=%g b=%g c=%g", v[0], v[1], v[2]);
+            out.append(head);
+            break;
+        }
+        case kCrash:
+            Tag(out, "CRASH", 0);
+            out.append(reinterpret_cast<const char*>(p), len);
+            break;
+        default:
+            out.append("<unknown record>");
+            break;
+        }
+        out.push_back('\n');
+    }
+
+    std::FILE* f = outPath ? std::fopen(outPath, "wb") : stdout;
+    if (!f) {
+        std::fprintf(stderr, "mb_flightdump: cannot write %s\n", outPath);
+        return 1;
+    }
+    std::fwrite(out.data(), 1, out.size(), f);
+    if (outPath) std::fclose(f);
+
+    if (torn) std::fprintf(stderr, "mb_flightdump: %zu slot(s) incomplete (being written at the time)\n", torn);
+    return 0;
+}
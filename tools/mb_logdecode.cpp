@@ -0,0 +1,217 @@
+// tools/mb_logdecode.cpp - turns binary MirrorBlade logs (.mbl) into the text format
+//
+//   mb_logdecode [-o out.log] MirrorBladeBridge.*.mbl.gz MirrorBladeBridge.mbl
+//
+// Segments are decoded in the order given; rotated segment names sort in
+// rotation order, so a shell glob followed by the live file is chronological.
+// Gzipped segments (.gz, as the logger's maintenance thread leaves them) are
+// read directly; a gzipped text segment (.log.gz) is copied through as is.
+// Timestamps print in the local time of the machine running the decoder. A
+// segment cut short (crash mid-write) decodes up to the last complete entry
+// and is reported on stderr.
+#include "MBDeflate.hpp"
+#include "MBLogFormat.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    using namespace MB::LogWire;
+
+    struct Site {
+        std::uint8_t  level{ 0 };
+        std::uint8_t  module{ 0 };
+        std::uint32_t line{ 0 };
+        std::string   file;
+        std::string   fmt;
+    };
+
+    class Cursor {
+    public:
+        Cursor(const unsigned char* p, std::size_t n) : _p(p), _end(p + n) {}
+
+        template <class V>
+        bool Read(V& v) {
+            if (static_cast<std::size_t>(_end - _p) < sizeof(V)) return false;
+            std::memcpy(&v, _p, sizeof(V));
+            _p += sizeof(V);
+            return true;
+        }
+
+        bool Bytes(std::size_t n, const unsigned char*& out) {
+            if (static_cast<std::size_t>(_end - _p) < n) return false;
+            out = _p;
+            _p += n;
+            return true;
+        }
+
+        bool Done() const { return _p >= _end; }
+        std::size_t Offset(const unsigned char* base) const { return static_cast<std::size_t>(_p - base); }
+
+    private:
+        const unsigned char* _p;
+        const unsigned char* _end;
+    };
+
+    void AppendLine(std::string& out, std::int64_t wallNs, std::uint8_t level, const char* text, std::size_t len,
+        std::uint8_t module = 0) {
+        const std::time_t t = static_cast<std::time_t>(wallNs / 1'000'000'000);
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        char stamp[48];
+        std::size_t n = std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+        n += static_cast<std::size_t>(std::snprintf(stamp + n, sizeof(stamp) - n, ".%06u ",
+            static_cast<unsigned>((wallNs / 1000) % 1'000'000)));
+        out.append(stamp, n);
+        out.push_back('[');
+        out.append(LevelName(level));
+        out.append("] ", 2);
+        if (module) {
+            out.push_back('[');
+            out.append(ModuleName(module));
+            out.append("] ", 2);
+        }
+        out.append(text, len);
+        out.push_back('\n');
+    }
+
+    // Returns false if the segment is malformed or truncated (what was
+    // decoded before that point is still written).
+    bool DecodeSegment(const char* path, std::FILE* out, std::size_t& lines) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "mb_logdecode: cannot open %s\n", path);
+            return false;
+        }
+        std::string raw((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const bool gz = MB::Deflate::IsGzip(raw.data(), raw.size());
+        if (gz) {
+            std::string plain, err;
+            if (!MB::Deflate::Gunzip(raw.data(), raw.size(), plain, &err)) {
+                std::fprintf(stderr, "mb_logdecode: %s: %s\n", path, err.c_str());
+                return false;
+            }
+            raw.swap(plain);
+        }
+        const std::vector<unsigned char> data(raw.begin(), raw.end());
+        if (data.size() < kHeaderBytes || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+            if (gz) {   // compressed text segment
+                std::fwrite(raw.data(), 1, raw.size(), out);
+                lines += static_cast<std::size_t>(std::count(raw.begin(), raw.end(), '\n'));
+                return true;
+            }
+            std::fprintf(stderr, "mb_logdecode: %s is not a binary MirrorBlade log\n", path);
+            return false;
+        }
+        std::uint32_t version;
+        std::memcpy(&version, data.data() + sizeof(kMagic), sizeof(version));
+        if (version < 1 || version > kVersion) {
+            std::fprintf(stderr, "mb_logdecode: %s has version %u, expected 1..%u\n", path, version, kVersion);
+            return false;
+        }
+
+        std::unordered_map<std::uint32_t, Site> sites;
+        std::string text;
+        std::string buf;
+        Cursor c(data.data() + kHeaderBytes, data.size() - kHeaderBytes);
+        bool ok = true;
+        while (!c.Done()) {
+            std::uint8_t kind = 0;
+            c.Read(kind);
+            if (kind == kSite) {
+                std::uint32_t id; Site s; std::uint16_t n;
+                const unsigned char* p;
+                if (!c.Read(id) || !c.Read(s.level)) { ok = false; break; }
+                if (version >= 2 && !c.Read(s.module)) { ok = false; break; }
+                if (!c.Read(s.line)) { ok = false; break; }
+                if (!c.Read(n) || !c.Bytes(n, p)) { ok = false; break; }
+                s.file.assign(reinterpret_cast<const char*>(p), n);
+                if (!c.Read(n) || !c.Bytes(n, p)) { ok = false; break; }
+                s.fmt.assign(reinterpret_cast<const char*>(p), n);
+                sites[id] = std::move(s);
+            }
+            else if (kind == kRecord) {
+                std::int64_t wallNs; std::uint32_t id; std::uint16_t n;
+                const unsigned char* args;
+                if (!c.Read(wallNs) || !c.Read(id) || !c.Read(n) || !c.Bytes(n, args)) { ok = false; break; }
+                text.clear();
+                const auto it = sites.find(id);
+                if (it == sites.end()) {
+                    text = "<undefined site " + std::to_string(id) + ">";
+                    AppendLine(buf, wallNs, 2, text.data(), text.size());
+                }
+                else {
+                    Format(it->second.fmt.c_str(), args, n, text);
+                    AppendLine(buf, wallNs, it->second.level, text.data(), text.size(), it->second.module);
+                }
+                ++lines;
+            }
+            else if (kind == kText) {
+                std::int64_t wallNs; std::uint8_t level; std::uint16_t n;
+                const unsigned char* p;
+                if (!c.Read(wallNs) || !c.Read(level) || !c.Read(n) || !c.Bytes(n, p)) { ok = false; break; }
+                AppendLine(buf, wallNs, level, reinterpret_cast<const char*>(p), n);
+                ++lines;
+            }
+            else {
+                ok = false;
+                break;
+            }
+
+            if (buf.size() > (1u << 20)) {
+                std::fwrite(buf.data(), 1, buf.size(), out);
+                buf.clear();
+            }
+        }
+        std::fwrite(buf.data(), 1, buf.size(), out);
+
+        if (!ok)
+            std::fprintf(stderr, "mb_logdecode: %s: truncated or corrupt entry near offset %zu\n",
+                path, c.Offset(data.data()));
+        return ok;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* outPath = nullptr;
+    std::vector<const char*> inputs;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "-o") && i + 1 < argc) outPath = argv[++i];
+        else inputs.push_back(argv[i]);
+    }
+    if (inputs.empty()) {
+        std::fprintf(stderr, "usage: %s [-o out.log] file.mbl[.gz] [file.mbl[.gz] ...]\n", argv[0]);
+        return 2;
+    }
+
+    std::FILE* out = outPath ? std::fopen(outPath, "wb") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "mb_logdecode: cannot write %s\n", outPath);
+        return 1;
+    }
+
+    bool ok = true;
+    std::size_t lines = 0;
+    for (const char* in : inputs)
+        ok = DecodeSegment(in, out, lines) && ok;
+
+    if (outPath) {
+        std::fclose(out);
+        std::fprintf(stderr, "mb_logdecode: %zu lines -> %s\n", lines, outPath);
+    }
+    return ok ? 0 : 1;
+}